@@ -11,6 +11,7 @@
 #include "building/state.h"
 #include "building/storage.h"
 #include "building/variant.h"
+#include "building/warehouse.h"
 #include "city/buildings.h"
 #include "city/finance.h"
 #include "city/population.h"
@@ -114,8 +115,16 @@ building *building_next(building *b)
     return array_item(data.buildings, b->next_part_building_id);
 }
 
+static void invalidate_type_dependent_data(building_type type)
+{
+    if (type == BUILDING_WAREHOUSE || type == BUILDING_WAREHOUSE_SPACE) {
+        building_warehouse_invalidate_contents();
+    }
+}
+
 static void fill_adjacent_types(building *b)
 {
+    invalidate_type_dependent_data(b->type);
     building *first = data.first_of_type[b->type];
     building *last = data.last_of_type[b->type];
     if (!first || !last) {
@@ -152,6 +161,7 @@ static void fill_adjacent_types(building *b)
 
 static void remove_adjacent_types(building *b)
 {
+    invalidate_type_dependent_data(b->type);
     building *first = data.first_of_type[b->type];
     building *last = data.last_of_type[b->type];
     if (b == first && b == last) {
@@ -601,6 +611,7 @@ void building_clear_all(void)
 {
     memset(data.first_of_type, 0, sizeof(data.first_of_type));
     memset(data.last_of_type, 0, sizeof(data.last_of_type));
+    building_warehouse_invalidate_contents();
 
     if (!array_init(data.buildings, BUILDING_ARRAY_SIZE_STEP, initialize_new_building, building_in_use) ||
         !array_next(data.buildings)) { // Ignore first building
@@ -664,6 +675,7 @@ void building_load_state(buffer *buf, buffer *sequence, buffer *corrupt_houses,
 
     memset(data.first_of_type, 0, sizeof(data.first_of_type));
     memset(data.last_of_type, 0, sizeof(data.last_of_type));
+    building_warehouse_invalidate_contents();
 
     int highest_id_in_use = 0;
 
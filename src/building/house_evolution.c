@@ -561,7 +561,6 @@ void building_house_process_evolve_and_consume_goods(void)
 {
     city_houses_reset_demands();
     house_demands *demands = city_houses_demands();
-    int has_expanded = 0;
 
     if (building_monument_working(BUILDING_GRAND_TEMPLE_VENUS)) {
         active_devolve_delay = DEVOLVE_DELAY_WITH_VENUS;
@@ -579,8 +578,9 @@ void building_house_process_evolve_and_consume_goods(void)
                 continue;
             }
             building_house_check_for_corruption(b);
-            if (!b->has_plague) {
-                has_expanded |= evolve_callback[b->type - BUILDING_HOUSE_VACANT_LOT](b, demands);
+            if (!b->has_plague && evolve_callback[b->type - BUILDING_HOUSE_VACANT_LOT](b, demands)) {
+                // The house merged with its neighbours: its footprint now covers all changed tiles
+                map_routing_update_land_area(b->x, b->y, b->size);
             }
             // 1x1 houses only consume half of the goods
             if (game_time_day() == 0 || (game_time_day() == 7 && b->house_size > 1)) {
@@ -589,9 +589,6 @@ void building_house_process_evolve_and_consume_goods(void)
             b->last_update = last_update;
         }
     }
-    if (has_expanded) {
-        map_routing_update_land();
-    }
 }
 
 void building_house_determine_evolve_text(building *house, int worst_desirability_building)
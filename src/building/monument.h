@@ -7,6 +7,7 @@
 #define MONUMENT_FINISHED -1
 #define MONUMENT_START 1
 #define MARS_OFFERING_FREQUENCY 16
+#define MONUMENT_MODULE_COST 1000
 
 typedef enum {
     CERES_MODULE_1_REDUCE_FOOD,
@@ -3,11 +3,14 @@
 #include "building/building.h"
 #include "building/type.h"
 
+static int permission_generation;
+
 void building_roadblock_set_permission(roadblock_permission p, building *b)
 {
     if (building_type_is_roadblock(b->type)) {
         int permission_bit = 1 << p;
         b->data.roadblock.exceptions ^= permission_bit;
+        permission_generation++;
     }
 }
 
@@ -42,6 +45,7 @@ void building_roadblock_accept_none(building *b)
 {
     if (building_type_is_roadblock(b->type)) {
         b->data.roadblock.exceptions = 0;
+        permission_generation++;
     }
 }
 
@@ -49,5 +53,11 @@ void building_roadblock_accept_all(building *b)
 {
     if (building_type_is_roadblock(b->type)) {
         b->data.roadblock.exceptions = ROADBLOCK_PERMISSION_ALL;
+        permission_generation++;
     }
 }
+
+int building_roadblock_permission_generation(void)
+{
+    return permission_generation;
+}
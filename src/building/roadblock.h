@@ -24,6 +24,12 @@ int building_roadblock_get_permission(roadblock_permission p, building *b);
 void building_roadblock_accept_none(building *b);
 void building_roadblock_accept_all(building *b);
 
+/**
+ * Gets a counter that changes every time the permissions of a roadblock are changed.
+ * Anything derived from roaming paths is stale once the counter changes.
+ * @return The current roadblock permission generation
+ */
+int building_roadblock_permission_generation(void);
 
 int building_type_is_roadblock(building_type type);
 
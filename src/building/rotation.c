@@ -133,6 +133,20 @@ int building_rotation_get_rotation_with_limit(int limit)
     return data.extra_rotation % limit;
 }
 
+void building_rotation_get_state(int *rotation, int *extra_rotation, int *road_orientation)
+{
+    *rotation = data.rotation;
+    *extra_rotation = data.extra_rotation;
+    *road_orientation = data.road_orientation;
+}
+
+void building_rotation_set_state(int rotation, int extra_rotation, int road_orientation)
+{
+    data.rotation = rotation;
+    data.extra_rotation = extra_rotation;
+    data.road_orientation = road_orientation;
+}
+
 void building_rotation_rotate_forward(void)
 {
     if (building_rotation_type_has_rotations(building_construction_type())) {
@@ -13,6 +13,9 @@ int building_rotation_get_rotation(void);
 
 int building_rotation_get_rotation_with_limit(int limit);
 
+void building_rotation_get_state(int *rotation, int *extra_rotation, int *road_orientation);
+void building_rotation_set_state(int rotation, int extra_rotation, int road_orientation);
+
 int building_rotation_get_corner(int rot);
 
 void building_rotation_rotate_forward(void);
@@ -9,6 +9,7 @@
 #include "building/storage.h"
 #include "city/finance.h"
 #include "city/resource.h"
+#include "core/array.h"
 #include "core/calc.h"
 #include "core/image.h"
 #include "empire/trade_prices.h"
@@ -17,29 +18,226 @@
 #include "map/image.h"
 #include "scenario/property.h"
 
+#include <stdlib.h>
+#include <string.h>
+
 #define INFINITE 10000
 
 #define MAX_CARTLOADS_PER_SPACE 4
 
-int building_warehouse_get_space_info(building *warehouse)
+#define CONTENTS_ARRAY_SIZE_STEP 200
+
+typedef struct {
+    int building_id;
+    int complete;
+    int empty_spaces;
+    int total_loads;
+    int loads[RESOURCE_MAX];
+    int spaces[RESOURCE_MAX];
+    int spaces_with_room[RESOURCE_MAX];
+} warehouse_contents;
+
+/**
+ * Warehouses that may be chosen for a resource, in the order of the warehouse list, so that
+ * lookups going through them pick the same warehouse as when going through every warehouse.
+ * Warehouses whose contents are not indexed are always included.
+ */
+typedef struct {
+    int is_current;
+    int size;
+    int capacity;
+    int *building_ids;
+} candidate_list;
+
+// Summary of what each warehouse's spaces hold, indexed by storage id
+static struct {
+    int valid;
+    array(warehouse_contents) warehouses;
+    candidate_list holding[RESOURCE_MAX];
+    candidate_list with_room[RESOURCE_MAX];
+} contents;
+
+static void read_contents(building *warehouse, warehouse_contents *c)
 {
-    int total_loads = 0;
-    int empty_spaces = 0;
+    memset(c, 0, sizeof(warehouse_contents));
+    c->building_id = warehouse->id;
     building *space = warehouse;
     for (int i = 0; i < 8; i++) {
         space = building_next(space);
         if (space->id <= 0) {
-            return 0;
+            return;
         }
-        if (space->subtype.warehouse_resource_id) {
-            total_loads += space->resources[space->subtype.warehouse_resource_id];
+        int resource = space->subtype.warehouse_resource_id;
+        if (resource) {
+            c->total_loads += space->resources[resource];
+            c->loads[resource] += space->resources[resource];
+            c->spaces[resource]++;
+            if (space->resources[resource] < MAX_CARTLOADS_PER_SPACE) {
+                c->spaces_with_room[resource]++;
+            }
         } else {
-            empty_spaces++;
+            c->empty_spaces++;
+        }
+    }
+    c->complete = 1;
+}
+
+static void invalidate_candidates(void)
+{
+    for (int r = 0; r < RESOURCE_MAX; r++) {
+        contents.holding[r].is_current = 0;
+        contents.with_room[r].is_current = 0;
+    }
+}
+
+static int rebuild_contents(void)
+{
+    invalidate_candidates();
+    unsigned int size = building_storage_get_array_size();
+    if (!array_init(contents.warehouses, CONTENTS_ARRAY_SIZE_STEP, 0, 0)) {
+        return 0;
+    }
+    while (contents.warehouses.size < size) {
+        if (!array_advance(contents.warehouses)) {
+            return 0;
+        }
+    }
+    for (building *b = building_first_of_type(BUILDING_WAREHOUSE); b; b = b->next_of_type) {
+        if (b->state == BUILDING_STATE_UNUSED || !b->storage_id || b->storage_id >= size) {
+            continue;
+        }
+        warehouse_contents *c = array_item(contents.warehouses, b->storage_id);
+        if (!c->building_id) {
+            read_contents(b, c);
+        }
+    }
+    contents.valid = 1;
+    return 1;
+}
+
+static warehouse_contents *get_indexed_contents(const building *warehouse)
+{
+    if (!warehouse->storage_id || warehouse->storage_id >= contents.warehouses.size) {
+        return 0;
+    }
+    warehouse_contents *c = array_item(contents.warehouses, warehouse->storage_id);
+    return c->building_id == warehouse->id ? c : 0;
+}
+
+/**
+ * Returns the contents of an in-use warehouse from the index, or walks its spaces into the
+ * provided structure for warehouses that are being built, destroyed or are not in the index
+ */
+static const warehouse_contents *get_contents(building *warehouse, warehouse_contents *walked)
+{
+    if (warehouse->state == BUILDING_STATE_IN_USE && (contents.valid || rebuild_contents())) {
+        const warehouse_contents *c = get_indexed_contents(warehouse);
+        if (c) {
+            return c;
+        }
+    }
+    read_contents(warehouse, walked);
+    return walked;
+}
+
+static int is_holding(const warehouse_contents *c, int resource)
+{
+    return !c->complete || c->loads[resource] > 0;
+}
+
+static int has_room(const warehouse_contents *c, int resource)
+{
+    return !c->complete || c->empty_spaces > 0 || c->spaces_with_room[resource] > 0;
+}
+
+static void update_contents(building *space)
+{
+    if (!contents.valid) {
+        return;
+    }
+    building *warehouse = building_main(space);
+    warehouse_contents *c = get_indexed_contents(warehouse);
+    if (!c) {
+        return;
+    }
+    warehouse_contents old = *c;
+    read_contents(warehouse, c);
+    for (int r = RESOURCE_MIN; r < RESOURCE_MAX; r++) {
+        if (is_holding(&old, r) != is_holding(c, r)) {
+            contents.holding[r].is_current = 0;
+        }
+        if (has_room(&old, r) != has_room(c, r)) {
+            contents.with_room[r].is_current = 0;
+        }
+    }
+}
+
+static int add_candidate(candidate_list *list, int building_id)
+{
+    if (list->size >= list->capacity) {
+        int capacity = list->capacity ? list->capacity * 2 : 16;
+        int *building_ids = realloc(list->building_ids, capacity * sizeof(int));
+        if (!building_ids) {
+            return 0;
+        }
+        list->building_ids = building_ids;
+        list->capacity = capacity;
+    }
+    list->building_ids[list->size++] = building_id;
+    return 1;
+}
+
+/**
+ * Gets the warehouses that may be chosen for a resource
+ * @return The list, or 0 if it could not be built, in which case every warehouse must be checked
+ */
+static const candidate_list *get_candidates(candidate_list *lists, int resource,
+    int (*is_candidate)(const warehouse_contents *c, int resource))
+{
+    if (resource <= RESOURCE_NONE || resource >= RESOURCE_MAX || (!contents.valid && !rebuild_contents())) {
+        return 0;
+    }
+    candidate_list *list = &lists[resource];
+    if (list->is_current) {
+        return list;
+    }
+    list->size = 0;
+    for (building *b = building_first_of_type(BUILDING_WAREHOUSE); b; b = b->next_of_type) {
+        const warehouse_contents *c = b->state == BUILDING_STATE_IN_USE ? get_indexed_contents(b) : 0;
+        if (c && !is_candidate(c, resource)) {
+            continue;
+        }
+        if (!add_candidate(list, b->id)) {
+            return 0;
         }
     }
-    if (empty_spaces > 0) {
+    list->is_current = 1;
+    return list;
+}
+
+static building *next_warehouse(const candidate_list *candidates, building *b, int *index)
+{
+    if (!candidates) {
+        return b ? b->next_of_type : building_first_of_type(BUILDING_WAREHOUSE);
+    }
+    return *index < candidates->size ? building_get(candidates->building_ids[(*index)++]) : 0;
+}
+
+void building_warehouse_invalidate_contents(void)
+{
+    contents.valid = 0;
+}
+
+int building_warehouse_get_space_info(building *warehouse)
+{
+    warehouse_contents walked;
+    const warehouse_contents *c = get_contents(warehouse, &walked);
+    if (!c->complete) {
+        return 0;
+    }
+    if (c->empty_spaces > 0) {
         return WAREHOUSE_ROOM;
-    } else if (total_loads < FULL_WAREHOUSE) {
+    } else if (c->total_loads < FULL_WAREHOUSE) {
         return WAREHOUSE_SOME_ROOM;
     } else {
         return WAREHOUSE_FULL;
@@ -48,18 +246,12 @@ int building_warehouse_get_space_info(building *warehouse)
 
 int building_warehouse_get_amount(building *warehouse, int resource)
 {
-    int loads = 0;
-    building *space = warehouse;
-    for (int i = 0; i < 8; i++) {
-        space = building_next(space);
-        if (space->id <= 0) {
-            return 0;
-        }
-        if (space->subtype.warehouse_resource_id && space->subtype.warehouse_resource_id == resource) {
-            loads += space->resources[resource];
-        }
+    warehouse_contents walked;
+    const warehouse_contents *c = get_contents(warehouse, &walked);
+    if (!c->complete || resource <= RESOURCE_NONE || resource >= RESOURCE_MAX) {
+        return 0;
     }
-    return loads;
+    return c->loads[resource];
 }
 
 int building_warehouse_add_resource(building *b, int resource, int respect_settings)
@@ -223,6 +415,8 @@ void building_warehouse_space_set_image(building *space, int resource)
         image_id = resource_get_data(resource)->image.storage + space->resources[resource] - 1;
     }
     map_image_set(space->grid_offset, image_id);
+    // Every change to the contents of a space ends up here
+    update_contents(space);
 }
 
 void building_warehouse_space_add_import(building *space, int resource, int land_trader)
@@ -359,19 +553,14 @@ int building_warehouse_maximum_receptible_amount(resource_type resource, buildin
 
 int building_warehouse_max_space_for_resource(resource_type resource, building *b)
 {
-    int max_storable = 0;
-    building *space = b;
-    for (int i = 0; i < 8; i++) {
-        space = building_next(space);
-        if (space->id <= 0) {
-            return 0;
-        }
-        if (space->subtype.warehouse_resource_id == resource) {
-            max_storable += MAX_CARTLOADS_PER_SPACE - space->resources[resource];
-        }
-        if (space->subtype.warehouse_resource_id == RESOURCE_NONE) {
-            max_storable += MAX_CARTLOADS_PER_SPACE;
-        }
+    warehouse_contents walked;
+    const warehouse_contents *c = get_contents(b, &walked);
+    if (!c->complete) {
+        return 0;
+    }
+    int max_storable = c->empty_spaces * MAX_CARTLOADS_PER_SPACE;
+    if (resource > RESOURCE_NONE && resource < RESOURCE_MAX) {
+        max_storable += c->spaces[resource] * MAX_CARTLOADS_PER_SPACE - c->loads[resource];
     }
     return max_storable;
 }
@@ -487,6 +676,11 @@ int building_warehouse_accepts_storage(building *b, int resource, int *understaf
         }
         return 0;
     }
+    warehouse_contents walked;
+    const warehouse_contents *c = get_contents(b, &walked);
+    if (c->complete) {
+        return c->empty_spaces > 0 || c->spaces_with_room[resource] > 0;
+    }
     building *space = b;
     for (int t = 0; t < 8; t++) {
         space = building_next(space);
@@ -503,7 +697,10 @@ int building_warehouse_for_storing(int src_building_id, int x, int y, int resour
 {
     int min_dist = INFINITE;
     int min_building_id = 0;
-    for (building *b = building_first_of_type(BUILDING_WAREHOUSE); b; b = b->next_of_type) {
+    // Understaffed warehouses are counted even when they have no room, so counting them needs every warehouse
+    const candidate_list *candidates = understaffed ? 0 : get_candidates(contents.with_room, resource, has_room);
+    int index = 0;
+    for (building *b = next_warehouse(candidates, 0, &index); b; b = next_warehouse(candidates, b, &index)) {
         if (b->id == src_building_id || (road_network_id != -1 && b->road_network_id != road_network_id) ||
             !building_warehouse_accepts_storage(b, resource, understaffed)) {
             continue;
@@ -525,6 +722,11 @@ int building_warehouse_for_storing(int src_building_id, int x, int y, int resour
 
 int building_warehouse_amount_can_get_from(building *destination, int resource)
 {
+    warehouse_contents walked;
+    const warehouse_contents *c = get_contents(destination, &walked);
+    if (c->complete) {
+        return c->loads[resource];
+    }
     int loads_stored = 0;
     building *space = destination;
     for (int t = 0; t < 8; t++) {
@@ -540,7 +742,9 @@ int building_warehouse_for_getting(building *src, int resource, map_point *dst)
 {
     int min_dist = INFINITE;
     building *min_building = 0;
-    for (building *b = building_first_of_type(BUILDING_WAREHOUSE); b; b = b->next_of_type) {
+    const candidate_list *candidates = get_candidates(contents.holding, resource, is_holding);
+    int index = 0;
+    for (building *b = next_warehouse(candidates, 0, &index); b; b = next_warehouse(candidates, b, &index)) {
         if (b->state != BUILDING_STATE_IN_USE || b->has_plague) {
             continue;
         }
@@ -571,7 +775,10 @@ int building_warehouse_with_resource(int x, int y, int resource, int road_networ
 {
     int min_dist = INFINITE;
     building *min_building = 0;
-    for (building *b = building_first_of_type(BUILDING_WAREHOUSE); b; b = b->next_of_type) {
+    // Understaffed warehouses are counted even when they are empty, so counting them needs every warehouse
+    const candidate_list *candidates = understaffed ? 0 : get_candidates(contents.holding, resource, is_holding);
+    int index = 0;
+    for (building *b = next_warehouse(candidates, 0, &index); b; b = next_warehouse(candidates, b, &index)) {
         if (b->state != BUILDING_STATE_IN_USE || b->has_plague) {
             continue;
         }
@@ -589,14 +796,7 @@ int building_warehouse_with_resource(int x, int y, int resource, int road_networ
             }
             continue;
         }
-        int loads_stored = 0;
-        building *space = b;
-        for (int t = 0; t < 8; t++) {
-            space = building_next(space);
-            if (space->id > 0 && space->subtype.warehouse_resource_id == resource) {
-                loads_stored += space->resources[resource];
-            }
-        }
+        int loads_stored = building_warehouse_amount_can_get_from(b, resource);
         if (loads_stored > 0) {
             int dist = calc_maximum_distance(b->x, b->y, x, y);
             dist -= 2 * loads_stored;
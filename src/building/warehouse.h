@@ -22,6 +22,12 @@ enum {
     WAREHOUSE_TASK_DELIVERING = 1
 };
 
+/**
+ * Marks the index of warehouse contents as stale, so it is rebuilt on its next use.
+ * Must be called whenever warehouses or warehouse spaces are added, removed or relinked.
+ */
+void building_warehouse_invalidate_contents(void);
+
 int building_warehouse_get_space_info(building *warehouse);
 
 int building_warehouse_get_amount(building *warehouse, int resource);
@@ -28,3 +28,51 @@ void array_free(void **data, unsigned int blocks)
     }
     free(data);
 }
+
+int array_free_slots_push(array_free_slots *slots, unsigned int index)
+{
+    if (slots->size == slots->capacity) {
+        unsigned int new_capacity = slots->capacity ? slots->capacity * 2 : 64;
+        unsigned int *new_items = realloc(slots->items, sizeof(unsigned int) * new_capacity);
+        if (!new_items) {
+            return 0;
+        }
+        slots->items = new_items;
+        slots->capacity = new_capacity;
+    }
+    unsigned int position = slots->size++;
+    while (position) {
+        unsigned int parent = (position - 1) / 2;
+        if (slots->items[parent] <= index) {
+            break;
+        }
+        slots->items[position] = slots->items[parent];
+        position = parent;
+    }
+    slots->items[position] = index;
+    return 1;
+}
+
+void array_free_slots_pop(array_free_slots *slots)
+{
+    if (!slots->size) {
+        return;
+    }
+    unsigned int last = slots->items[--slots->size];
+    unsigned int position = 0;
+    while (1) {
+        unsigned int child = 2 * position + 1;
+        if (child >= slots->size) {
+            break;
+        }
+        if (child + 1 < slots->size && slots->items[child + 1] < slots->items[child]) {
+            child++;
+        }
+        if (last <= slots->items[child]) {
+            break;
+        }
+        slots->items[position] = slots->items[child];
+        position = child;
+    }
+    slots->items[position] = last;
+}
@@ -4,6 +4,17 @@
 #include <stdlib.h>
 #include <string.h>
 
+/**
+ * Min-heap of indexes that may be free, used by arrays with free slot tracking enabled.
+ * This structure is private and should not be used directly
+ */
+typedef struct {
+    unsigned int *items;
+    unsigned int size;
+    unsigned int capacity;
+    int enabled;
+} array_free_slots;
+
 /**
  * Creates an array structure
  * @param T The type of item that the array holds
@@ -17,6 +28,7 @@ struct { \
     unsigned int bit_offset; \
     void (*constructor)(T *, unsigned int); \
     int (*in_use)(const T *); \
+    array_free_slots free_slots; \
 }
 
 /**
@@ -26,6 +38,7 @@ struct { \
 #define array_clear(a) \
 ( \
     array_free((void **)(a).items, (a).blocks), \
+    free((a).free_slots.items), \
     memset(&(a), 0, sizeof(a)) \
 )
 
@@ -81,6 +94,8 @@ struct { \
 
 /**
  * Creates a new item for the array, either by finding an available empty item or by expanding the array.
+ * The first available item at or after index is always the one returned, whether or not free slot
+ * tracking is enabled, so item ids are reused in the same order either way.
  * @param a The array structure
  * @param index The index upon which to start searching for a free slot. If index is greater than the array size,
  *        the array will be expanded.
@@ -96,7 +111,20 @@ struct { \
             break; \
         } \
     } \
-    if (!error && (a).in_use) { \
+    if (!error && (a).in_use && (a).free_slots.enabled) { \
+        while ((a).free_slots.size) { \
+            unsigned int array_index = (a).free_slots.items[0]; \
+            if (array_index >= (index) && array_index < (a).size && !(a).in_use(array_item(a, array_index))) { \
+                ptr = array_item(a, array_index); \
+                memset(ptr, 0, sizeof(**(a).items)); \
+                if ((a).constructor) { \
+                    (a).constructor(ptr, array_index); \
+                } \
+                break; \
+            } \
+            array_free_slots_pop(&(a).free_slots); \
+        } \
+    } else if (!error && (a).in_use) { \
         for (unsigned int array_index = index; array_index < (a).size; array_index++) { \
             if (!(a).in_use(array_item(a, array_index))) { \
                 ptr = array_item(a, array_index); \
@@ -110,9 +138,57 @@ struct { \
     } \
     if (!error && !ptr) { \
         ptr = array_advance(a); \
+        if (ptr && (a).free_slots.enabled) { \
+            array_release_item(a, (a).size - 1); \
+        } \
     } \
 }
 
+/**
+ * Enables free slot tracking for an array, making array_new_item_after_index find a free item
+ * in O(log n) instead of scanning the array.
+ * Once enabled, array_release_item MUST be called whenever an item stops being in use.
+ * Free items before the index given to array_new_item_after_index are dropped from the tracking,
+ * so the same index must be used for every new item.
+ * Tracking is disabled again by array_init and array_clear.
+ * @param a The array structure
+ */
+#define array_enable_free_slot_tracking(a) \
+{ \
+    (a).free_slots.enabled = 1; \
+    array_rebuild_free_slots(a); \
+}
+
+/**
+ * Rebuilds the list of free slots from scratch. Use after changing many items at once, such as when loading.
+ * Does nothing if free slot tracking is not enabled.
+ * @param a The array structure
+ */
+#define array_rebuild_free_slots(a) \
+{ \
+    if ((a).free_slots.enabled && (a).in_use) { \
+        (a).free_slots.size = 0; \
+        for (unsigned int array_index = 0; array_index < (a).size; array_index++) { \
+            if (!(a).in_use(array_item(a, array_index))) { \
+                array_release_item(a, array_index); \
+            } \
+        } \
+    } \
+}
+
+/**
+ * Marks an item as available for reuse. Only needed when free slot tracking is enabled.
+ * Items may be released more than once, and a released item may safely be reused later by other means.
+ * If memory runs out, free slot tracking is disabled and the array goes back to scanning for free items.
+ * @param a The array structure
+ * @param index The index of the item that is no longer in use
+ */
+#define array_release_item(a, index) \
+( \
+    (a).free_slots.enabled && !array_free_slots_push(&(a).free_slots, index) ? \
+        (void) ((a).free_slots.enabled = 0) : (void) 0 \
+)
+
 /**
  * Removes an item from an array, moving the other items left and calling their constructors if applicable
  * @param a The array structure
@@ -130,6 +206,7 @@ struct { \
         memset(array_item(a, (a).size - 1), 0, sizeof(**(a).items)); \
         (a).size--; \
     } \
+    array_rebuild_free_slots(a); \
 }
 
 /**
@@ -235,6 +312,7 @@ struct { \
             } \
             (a).size -= items_to_move; \
         } \
+        array_rebuild_free_slots(a); \
     } \
 }
 
@@ -281,6 +359,16 @@ int array_add_blocks(void ***data, unsigned int *blocks, unsigned int items_per_
  */
 void array_free(void **data, unsigned int blocks);
 
+/**
+ * This function is private and should not be used
+ */
+int array_free_slots_push(array_free_slots *slots, unsigned int index);
+
+/**
+ * This function is private and should not be used
+ */
+void array_free_slots_pop(array_free_slots *slots);
+
 /**
  * Private helper compile-time functions for finding the next power of two into which a number fits
  */
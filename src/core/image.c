@@ -2,13 +2,16 @@
 
 #include "assets/assets.h"
 #include "core/buffer.h"
+#include "core/dir.h"
 #include "core/file.h"
 #include "core/image_packer.h"
 #include "core/io.h"
 #include "core/log.h"
+#include "core/zlib_helper.h"
 #include "graphics/font.h"
 #include "graphics/renderer.h"
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -43,6 +46,13 @@
 
 #define IMAGE_TYPE_ISOMETRIC 30
 
+#define CLIMATE_CACHE_MAGIC 0x41545543 // "CUTA"
+#define CLIMATE_CACHE_VERSION 1
+#define CLIMATE_CACHE_HEADER_SIZE 40
+#define CLIMATE_CACHE_PAGE_HEADER_SIZE 12
+#define CLIMATE_CACHE_GEOMETRY_SIZE 28
+#define CLIMATE_CACHE_IMAGE_SIZE (2 * CLIMATE_CACHE_GEOMETRY_SIZE + 1)
+
 enum {
     NO_EXTRA_FONT = 0,
     FULL_CHARSET_IN_FONT = 1,
@@ -66,6 +76,30 @@ typedef struct {
     int half_width;
 } multibyte_font_sizes;
 
+typedef struct {
+    uint32_t index_hash;
+    uint32_t data_hash;
+    int data_size;
+    int max_image_width;
+    int max_image_height;
+} climate_cache_key;
+
+typedef struct {
+    int x_offset;
+    int y_offset;
+    int width;
+    int height;
+    int atlas_id;
+    int atlas_x_offset;
+    int atlas_y_offset;
+} cached_image_geometry;
+
+typedef struct {
+    cached_image_geometry main;
+    int has_top;
+    cached_image_geometry top;
+} cached_image;
+
 typedef struct {
     const char *name;
     const char *file_v1;
@@ -332,6 +366,23 @@ static int prepare_images(buffer *buf, image *images, image_draw_data *draw_data
 static void convert_compressed(buffer *buf, int width, int height, int x_offset, int y_offset,
     int buf_length, color_t *dst, int dst_width);
 
+static void copy_external_draw_data(const image *images, const image_draw_data *draw_datas, int num_images)
+{
+    for (int i = 1; i < num_images; i++) {
+        const image *img = &images[i];
+        if (!image_is_external(img)) {
+            continue;
+        }
+        image_draw_data *external_data = &data.external_draw_data[img->atlas.id & IMAGE_ATLAS_BIT_MASK];
+        memcpy(external_data, &draw_datas[i], sizeof(image_draw_data));
+        if (!external_data->offset) {
+            external_data->offset = 1;
+        }
+        external_data->width = img->original.width;
+        external_data->height = img->original.height;
+    }
+}
+
 static int crop_and_pack_images(buffer *buf, image *images, image_draw_data *draw_datas,
     int num_images, atlas_type type)
 {
@@ -343,19 +394,14 @@ static int crop_and_pack_images(buffer *buf, image *images, image_draw_data *dra
     data.packer.options.reduce_image_size = 1;
     data.packer.options.sort_by = IMAGE_PACKER_SORT_BY_AREA;
 
+    copy_external_draw_data(images, draw_datas, num_images);
+
     int offset = 4;
     for (int i = 1, rect = 1; i < num_images; i++, rect++) {
         image *img = &images[i];
         image_draw_data *draw_data = &draw_datas[i];
 
         if (image_is_external(img)) {
-            image_draw_data *external_data = &data.external_draw_data[img->atlas.id & IMAGE_ATLAS_BIT_MASK];
-            memcpy(external_data, draw_data, sizeof(image_draw_data));
-            if (!external_data->offset) {
-                external_data->offset = 1;
-            }
-            external_data->width = img->original.width;
-            external_data->height = img->original.height;
             continue;
         }
         draw_data->offset = offset;
@@ -613,6 +659,274 @@ static void release_external_buffers(void)
     }
 }
 
+static uint32_t hash_data(const uint8_t *bytes, int size)
+{
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void get_climate_cache_filename(char *filename, int climate_id, int is_editor)
+{
+    char name[FILE_NAME_MAX];
+    snprintf(name, FILE_NAME_MAX, "climate_cache_%d%s.bin", climate_id, is_editor ? "_editor" : "");
+    snprintf(filename, FILE_NAME_MAX, "%s", dir_append_location(name, PATH_LOCATION_CONFIG));
+}
+
+static void write_cached_geometry(buffer *buf, const image *img)
+{
+    buffer_write_i32(buf, img->x_offset);
+    buffer_write_i32(buf, img->y_offset);
+    buffer_write_i32(buf, img->width);
+    buffer_write_i32(buf, img->height);
+    buffer_write_i32(buf, img->atlas.id);
+    buffer_write_i32(buf, img->atlas.x_offset);
+    buffer_write_i32(buf, img->atlas.y_offset);
+}
+
+static void read_cached_geometry(buffer *buf, cached_image_geometry *geometry)
+{
+    geometry->x_offset = buffer_read_i32(buf);
+    geometry->y_offset = buffer_read_i32(buf);
+    geometry->width = buffer_read_i32(buf);
+    geometry->height = buffer_read_i32(buf);
+    geometry->atlas_id = buffer_read_i32(buf);
+    geometry->atlas_x_offset = buffer_read_i32(buf);
+    geometry->atlas_y_offset = buffer_read_i32(buf);
+}
+
+static void apply_cached_geometry(image *img, const cached_image_geometry *geometry)
+{
+    img->x_offset = geometry->x_offset;
+    img->y_offset = geometry->y_offset;
+    img->width = geometry->width;
+    img->height = geometry->height;
+    img->atlas.id = geometry->atlas_id;
+    img->atlas.x_offset = geometry->atlas_x_offset;
+    img->atlas.y_offset = geometry->atlas_y_offset;
+}
+
+static void write_cache_header(buffer *buf, const climate_cache_key *key, int num_pages, int metadata_size)
+{
+    buffer_write_u32(buf, CLIMATE_CACHE_MAGIC);
+    buffer_write_i32(buf, CLIMATE_CACHE_VERSION);
+    buffer_write_u32(buf, key->index_hash);
+    buffer_write_u32(buf, key->data_hash);
+    buffer_write_i32(buf, key->data_size);
+    buffer_write_i32(buf, key->max_image_width);
+    buffer_write_i32(buf, key->max_image_height);
+    buffer_write_i32(buf, IMAGE_MAIN_ENTRIES);
+    buffer_write_i32(buf, num_pages);
+    buffer_write_i32(buf, metadata_size);
+}
+
+static int write_page(FILE *fp, const color_t *pixels, int width, int height)
+{
+    int size = width * height * sizeof(color_t);
+    int compressed_size = zlib_helper_compress_bound(size);
+    uint8_t *compressed = malloc(compressed_size);
+    if (!compressed || !zlib_helper_compress((void *) pixels, size, compressed, compressed_size, &compressed_size)) {
+        free(compressed);
+        return 0;
+    }
+    uint8_t header[CLIMATE_CACHE_PAGE_HEADER_SIZE];
+    buffer buf;
+    buffer_init(&buf, header, CLIMATE_CACHE_PAGE_HEADER_SIZE);
+    buffer_write_i32(&buf, width);
+    buffer_write_i32(&buf, height);
+    buffer_write_i32(&buf, compressed_size);
+    int ok = fwrite(header, 1, CLIMATE_CACHE_PAGE_HEADER_SIZE, fp) == CLIMATE_CACHE_PAGE_HEADER_SIZE &&
+        fwrite(compressed, 1, compressed_size, fp) == (size_t) compressed_size;
+    free(compressed);
+    return ok;
+}
+
+static void save_climate_cache(const char *filename, const climate_cache_key *key,
+    const image *images, const image_atlas_data *atlas_data)
+{
+    int metadata_size = IMAGE_MAIN_ENTRIES * CLIMATE_CACHE_IMAGE_SIZE;
+    uint8_t *metadata = malloc(metadata_size);
+    if (!metadata) {
+        return;
+    }
+    buffer buf;
+    buffer_init(&buf, metadata, metadata_size);
+    for (int i = 0; i < IMAGE_MAIN_ENTRIES; i++) {
+        write_cached_geometry(&buf, &images[i]);
+        buffer_write_u8(&buf, images[i].top != 0);
+        if (images[i].top) {
+            write_cached_geometry(&buf, images[i].top);
+        }
+    }
+    metadata_size = buf.index;
+
+    // Write to a temporary file first so an interrupted write never leaves a truncated cache behind
+    char temp_filename[FILE_NAME_MAX];
+    snprintf(temp_filename, FILE_NAME_MAX, "%s.tmp", filename);
+    FILE *fp = file_open(temp_filename, "wb");
+    if (!fp) {
+        free(metadata);
+        return;
+    }
+    uint8_t header[CLIMATE_CACHE_HEADER_SIZE];
+    buffer_init(&buf, header, CLIMATE_CACHE_HEADER_SIZE);
+    write_cache_header(&buf, key, atlas_data->num_images, metadata_size);
+    int ok = fwrite(header, 1, CLIMATE_CACHE_HEADER_SIZE, fp) == CLIMATE_CACHE_HEADER_SIZE &&
+        fwrite(metadata, 1, metadata_size, fp) == (size_t) metadata_size;
+    free(metadata);
+    for (int i = 0; i < atlas_data->num_images && ok; i++) {
+        ok = write_page(fp, atlas_data->buffers[i], atlas_data->image_widths[i], atlas_data->image_heights[i]);
+    }
+    file_close(fp);
+    if (!ok || !file_rename(temp_filename, filename)) {
+        log_error("Unable to write climate cache", filename, 0);
+        file_remove(temp_filename);
+    }
+}
+
+static int read_page(FILE *fp, color_t *pixels, int width, int height)
+{
+    uint8_t header[CLIMATE_CACHE_PAGE_HEADER_SIZE];
+    if (fread(header, 1, CLIMATE_CACHE_PAGE_HEADER_SIZE, fp) != CLIMATE_CACHE_PAGE_HEADER_SIZE) {
+        return 0;
+    }
+    buffer buf;
+    buffer_init(&buf, header, CLIMATE_CACHE_PAGE_HEADER_SIZE);
+    int cached_width = buffer_read_i32(&buf);
+    int cached_height = buffer_read_i32(&buf);
+    int compressed_size = buffer_read_i32(&buf);
+    if (cached_width != width || cached_height != height || compressed_size <= 0) {
+        return 0;
+    }
+    uint8_t *compressed = malloc(compressed_size);
+    if (!compressed) {
+        return 0;
+    }
+    int size = width * height * sizeof(color_t);
+    int ok = fread(compressed, 1, compressed_size, fp) == (size_t) compressed_size &&
+        zlib_helper_decompress(compressed, compressed_size, pixels, size, &size);
+    free(compressed);
+    return ok;
+}
+
+static int read_cached_images(FILE *fp, int metadata_size, int num_pages, const image *images, cached_image *cached)
+{
+    uint8_t *metadata = malloc(metadata_size);
+    if (!metadata) {
+        return 0;
+    }
+    if (fread(metadata, 1, metadata_size, fp) != (size_t) metadata_size) {
+        free(metadata);
+        return 0;
+    }
+    buffer buf;
+    buffer_init(&buf, metadata, metadata_size);
+    int ok = 1;
+    for (int i = 0; i < IMAGE_MAIN_ENTRIES && ok; i++) {
+        read_cached_geometry(&buf, &cached[i].main);
+        cached[i].has_top = buffer_read_u8(&buf);
+        if (cached[i].has_top) {
+            read_cached_geometry(&buf, &cached[i].top);
+        }
+        // Tops can only be removed by cropping, never added
+        if (cached[i].has_top && !images[i].top) {
+            ok = 0;
+        }
+        if (!image_is_external(&images[i]) && ((cached[i].main.atlas_id & IMAGE_ATLAS_BIT_MASK) >= num_pages ||
+            (cached[i].has_top && (cached[i].top.atlas_id & IMAGE_ATLAS_BIT_MASK) >= num_pages))) {
+            ok = 0;
+        }
+    }
+    free(metadata);
+    return ok && !buf.overflow;
+}
+
+static const image_atlas_data *load_climate_cache(const char *filename, const climate_cache_key *key, image *images)
+{
+    FILE *fp = file_open(filename, "rb");
+    if (!fp) {
+        return 0;
+    }
+    uint8_t header[CLIMATE_CACHE_HEADER_SIZE];
+    if (fread(header, 1, CLIMATE_CACHE_HEADER_SIZE, fp) != CLIMATE_CACHE_HEADER_SIZE) {
+        file_close(fp);
+        return 0;
+    }
+    buffer buf;
+    buffer_init(&buf, header, CLIMATE_CACHE_HEADER_SIZE);
+    buffer_skip(&buf, CLIMATE_CACHE_HEADER_SIZE - 8);
+    int num_pages = buffer_read_i32(&buf);
+    int metadata_size = buffer_read_i32(&buf);
+
+    uint8_t expected[CLIMATE_CACHE_HEADER_SIZE];
+    buffer_init(&buf, expected, CLIMATE_CACHE_HEADER_SIZE);
+    write_cache_header(&buf, key, num_pages, metadata_size);
+    cached_image *cached = malloc(sizeof(cached_image) * IMAGE_MAIN_ENTRIES);
+    if (num_pages <= 0 || metadata_size <= 0 || !cached || memcmp(header, expected, CLIMATE_CACHE_HEADER_SIZE) != 0 ||
+        !read_cached_images(fp, metadata_size, num_pages, images, cached)) {
+        free(cached);
+        file_close(fp);
+        return 0;
+    }
+
+    // Only the size of the last page is free, the others use the maximum image size
+    long pages_start = ftell(fp);
+    int last_width = 0;
+    int last_height = 0;
+    for (int i = 0; i < num_pages; i++) {
+        uint8_t page_header[CLIMATE_CACHE_PAGE_HEADER_SIZE];
+        if (fread(page_header, 1, CLIMATE_CACHE_PAGE_HEADER_SIZE, fp) != CLIMATE_CACHE_PAGE_HEADER_SIZE) {
+            free(cached);
+            file_close(fp);
+            return 0;
+        }
+        buffer_init(&buf, page_header, CLIMATE_CACHE_PAGE_HEADER_SIZE);
+        last_width = buffer_read_i32(&buf);
+        last_height = buffer_read_i32(&buf);
+        fseek(fp, buffer_read_i32(&buf), SEEK_CUR);
+    }
+    fseek(fp, pages_start, SEEK_SET);
+
+    const image_atlas_data *atlas_data = graphics_renderer()->prepare_image_atlas(ATLAS_MAIN,
+        num_pages, last_width, last_height);
+    int ok = atlas_data != 0;
+    for (int i = 0; i < num_pages && ok; i++) {
+        ok = read_page(fp, atlas_data->buffers[i], atlas_data->image_widths[i], atlas_data->image_heights[i]);
+    }
+    file_close(fp);
+    if (!ok) {
+        if (atlas_data) {
+            graphics_renderer()->free_image_atlas(ATLAS_MAIN);
+        }
+        free(cached);
+        return 0;
+    }
+
+    for (int i = 0; i < IMAGE_MAIN_ENTRIES; i++) {
+        image *img = &images[i];
+        if (image_is_external(img)) {
+            continue;
+        }
+        apply_cached_geometry(img, &cached[i].main);
+        if (!img->top) {
+            continue;
+        }
+        if (!cached[i].has_top) {
+            free(img->top);
+            img->top = 0;
+            continue;
+        }
+        img->top->original.width = img->top->width;
+        img->top->original.height = img->top->height;
+        apply_cached_geometry(img->top, &cached[i].top);
+    }
+    free(cached);
+    return atlas_data;
+}
+
 int image_load_climate(int climate_id, int is_editor, int force_reload, int keep_atlas_buffers)
 {
     if (climate_id == data.current_climate && is_editor == data.is_editor && !force_reload &&
@@ -645,6 +959,7 @@ int image_load_climate(int climate_id, int is_editor, int force_reload, int keep
     memset(data.main, 0, sizeof(data.main));
     memset(draw_data, 0, IMAGE_MAIN_ENTRIES * sizeof(image_draw_data));
 
+    uint32_t index_hash = hash_data(tmp_data, MAIN_INDEX_SIZE);
     buffer buf;
     buffer_init(&buf, tmp_data, HEADER_SIZE);
     read_header(&buf);
@@ -665,37 +980,55 @@ int image_load_climate(int climate_id, int is_editor, int force_reload, int keep
         return 0;
     }
 
-    buffer_init(&buf, tmp_data, data_size);
-    if (!crop_and_pack_images(&buf, data.main, draw_data, IMAGE_MAIN_ENTRIES, ATLAS_MAIN)) {
-        free(tmp_data);
+    climate_cache_key key = {
+        .index_hash = index_hash,
+        .data_hash = hash_data(tmp_data, data_size),
+        .data_size = data_size,
+        .max_image_width = data.max_image_width,
+        .max_image_height = data.max_image_height
+    };
+    char cache_filename[FILE_NAME_MAX];
+    get_climate_cache_filename(cache_filename, climate_id, is_editor);
+
+    const image_atlas_data *atlas_data = load_climate_cache(cache_filename, &key, data.main);
+    if (atlas_data) {
+        copy_external_draw_data(data.main, draw_data, IMAGE_MAIN_ENTRIES);
         free_draw_data(draw_data, IMAGE_MAIN_ENTRIES);
-        release_external_buffers();
-        free(data.external_draw_data);
-        data.external_draw_data = 0;
-        return 0;
-    }
+        free(tmp_data);
+    } else {
+        buffer_init(&buf, tmp_data, data_size);
+        if (!crop_and_pack_images(&buf, data.main, draw_data, IMAGE_MAIN_ENTRIES, ATLAS_MAIN)) {
+            free(tmp_data);
+            free_draw_data(draw_data, IMAGE_MAIN_ENTRIES);
+            release_external_buffers();
+            free(data.external_draw_data);
+            data.external_draw_data = 0;
+            return 0;
+        }
 
-    const image_atlas_data *atlas_data = graphics_renderer()->prepare_image_atlas(ATLAS_MAIN,
-        data.packer.result.images_needed, data.packer.result.last_image_width, data.packer.result.last_image_height);
-    if (!atlas_data) {
+        atlas_data = graphics_renderer()->prepare_image_atlas(ATLAS_MAIN, data.packer.result.images_needed,
+            data.packer.result.last_image_width, data.packer.result.last_image_height);
+        if (!atlas_data) {
+            image_packer_free(&data.packer);
+            free(tmp_data);
+            free_draw_data(draw_data, IMAGE_MAIN_ENTRIES);
+            release_external_buffers();
+            free(data.external_draw_data);
+            data.external_draw_data = 0;
+            return 0;
+        }
+
+        convert_images(data.main, draw_data, IMAGE_MAIN_ENTRIES, &buf, atlas_data);
         image_packer_free(&data.packer);
-        free(tmp_data);
         free_draw_data(draw_data, IMAGE_MAIN_ENTRIES);
-        release_external_buffers();
-        free(data.external_draw_data);
-        data.external_draw_data = 0;
-        return 0;
+        free(tmp_data);
+        make_plain_fonts_white(data.main, atlas_data, image_group(GROUP_FONT));
+        save_climate_cache(cache_filename, &key, data.main, atlas_data);
     }
-
-    convert_images(data.main, draw_data, IMAGE_MAIN_ENTRIES, &buf, atlas_data);
-    free_draw_data(draw_data, IMAGE_MAIN_ENTRIES);
-    free(tmp_data);
-    make_plain_fonts_white(data.main, atlas_data, image_group(GROUP_FONT));
     if (!keep_atlas_buffers) {
         assets_init(data.is_editor != is_editor, atlas_data->buffers, atlas_data->image_widths);
     }
     graphics_renderer()->create_image_atlas(atlas_data, !keep_atlas_buffers);
-    image_packer_free(&data.packer);
 
     // Fix engineer's post animation offset
     if (!is_editor) {
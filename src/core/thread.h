@@ -0,0 +1,41 @@
+#ifndef CORE_THREAD_H
+#define CORE_THREAD_H
+
+/**
+ * @file
+ * Minimal thread support, implemented by the platform layer.
+ * Code running on a thread must not touch game state, log messages or call into the platform layer.
+ */
+
+typedef struct thread_handle thread_handle;
+
+/**
+ * Starts running a function on a new thread
+ * @param name The name of the thread, used for debugging
+ * @param function The function to run
+ * @param data The data to pass to the function
+ * @return A handle to the thread, or 0 if threads are not supported or the thread could not be created
+ */
+thread_handle *thread_create(const char *name, int (*function)(void *data), void *data);
+
+/**
+ * Checks whether the thread function has returned, without blocking
+ * @param thread The thread to check
+ * @return 1 if the function has returned, 0 otherwise
+ */
+int thread_is_finished(thread_handle *thread);
+
+/**
+ * Waits for the thread function to return and frees the thread handle
+ * @param thread The thread to wait for
+ * @return The value returned by the thread function
+ */
+int thread_wait(thread_handle *thread);
+
+/**
+ * Gets the number of logical CPU cores
+ * @return The number of cores, at least 1
+ */
+int thread_get_cpu_count(void);
+
+#endif // CORE_THREAD_H
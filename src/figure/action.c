@@ -22,6 +22,7 @@
 #include "figuretype/wall.h"
 #include "figuretype/water.h"
 #include "figuretype/workcamp.h"
+#include "game/tick_profiler.h"
 
 
 static void figure_nobody_action(figure *f)
@@ -143,7 +144,7 @@ void figure_action_handle(void)
                     f->targeted_by_figure_id = 0;
                 }
             }
-            figure_action_callbacks[f->type](f);
+            TICK_PROFILE_FIGURE(f->type, figure_action_callbacks[f->type](f));
             if (f->state == FIGURE_STATE_DEAD) {
                 figure_delete(f);
             }
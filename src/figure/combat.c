@@ -169,31 +169,56 @@ void figure_combat_handle_attack(figure *f)
     }
 }
 
-int figure_combat_get_target_for_soldier(int x, int y, int max_distance)
+static struct {
+    int x;
+    int y;
+    int max_distance;
+    int min_distance;
+    int min_figure_id;
+} target_search;
+
+static void start_target_search(int x, int y, int max_distance)
 {
-    int min_figure_id = 0;
-    int min_distance = 10000;
-    for (int i = 1; i < figure_count(); i++) {
-        figure *f = figure_get(i);
-        if (figure_is_dead(f) || f->is_ghost ) {
-            // Do not allow to target dead and enemies located outside of the map
-            continue;
-        }
-        if (figure_is_enemy(f) || f->type == FIGURE_RIOTER || is_attacking_native(f)) {
-            int distance = calc_maximum_distance(x, y, f->x, f->y);
-            if (distance <= max_distance) {
-                if (f->targeted_by_figure_id) {
-                    distance *= 2; // penalty
-                }
-                if (distance < min_distance) {
-                    min_distance = distance;
-                    min_figure_id = i;
-                }
+    target_search.x = x;
+    target_search.y = y;
+    target_search.max_distance = max_distance;
+    target_search.min_distance = 10000;
+    target_search.min_figure_id = 0;
+}
+
+static void consider_target(const figure *f, int distance)
+{
+    // Figures can be visited in any order, so ties go to the lowest id, as when scanning all figures
+    if (distance < target_search.min_distance ||
+        (distance == target_search.min_distance && f->id < target_search.min_figure_id)) {
+        target_search.min_distance = distance;
+        target_search.min_figure_id = f->id;
+    }
+}
+
+static void consider_soldier_target(figure *f)
+{
+    if (figure_is_dead(f) || f->is_ghost) {
+        // Do not allow to target dead and enemies located outside of the map
+        return;
+    }
+    if (figure_is_enemy(f) || f->type == FIGURE_RIOTER || is_attacking_native(f)) {
+        int distance = calc_maximum_distance(target_search.x, target_search.y, f->x, f->y);
+        if (distance <= target_search.max_distance) {
+            if (f->targeted_by_figure_id) {
+                distance *= 2; // penalty
             }
+            consider_target(f, distance);
         }
     }
-    if (min_figure_id) {
-        return min_figure_id;
+}
+
+int figure_combat_get_target_for_soldier(int x, int y, int max_distance)
+{
+    start_target_search(x, y, max_distance);
+    map_figure_foreach_in_range(x, y, max_distance, consider_soldier_target);
+    if (target_search.min_figure_id) {
+        return target_search.min_figure_id;
     }
     for (int i = 1; i < figure_count(); i++) {
         figure *f = figure_get(i);
@@ -207,76 +232,82 @@ int figure_combat_get_target_for_soldier(int x, int y, int max_distance)
     return 0;
 }
 
-int figure_combat_get_target_for_wolf(int x, int y, int max_distance)
+static void consider_wolf_target(figure *f)
 {
-    int min_figure_id = 0;
-    int min_distance = 10000;
-    for (int i = 1; i < figure_count(); i++) {
-        figure *f = figure_get(i);
-        if (figure_is_dead(f) || !f->type) {
-            continue;
-        }
-        switch (f->type) {
-            case FIGURE_EXPLOSION:
-            case FIGURE_FORT_STANDARD:
-            case FIGURE_TRADE_SHIP:
-            case FIGURE_FISHING_BOAT:
-            case FIGURE_MAP_FLAG:
-            case FIGURE_FLOTSAM:
-            case FIGURE_SHIPWRECK:
-            case FIGURE_INDIGENOUS_NATIVE:
-            case FIGURE_TOWER_SENTRY:
-            case FIGURE_NATIVE_TRADER:
-            case FIGURE_ARROW:
-            case FIGURE_JAVELIN:
-            case FIGURE_BOLT:
-            case FIGURE_BALLISTA:
-            case FIGURE_CATAPULT_MISSILE:
-            case FIGURE_FRIENDLY_ARROW:
-            case FIGURE_WATCHTOWER_ARCHER:
-            case FIGURE_CREATURE:
-                continue;
-        }
-        if (figure_is_herd(f)) {
-            continue;
-        }
-        if (figure_is_legion(f) && f->action_state == FIGURE_ACTION_80_SOLDIER_AT_REST) {
-            continue;
-        }
-        int distance = calc_maximum_distance(x, y, f->x, f->y);
-        if (f->targeted_by_figure_id) {
-            distance *= 2;
-        }
-        if (distance < min_distance) {
-            min_distance = distance;
-            min_figure_id = i;
-        }
+    if (figure_is_dead(f) || !f->type) {
+        return;
+    }
+    switch (f->type) {
+        case FIGURE_EXPLOSION:
+        case FIGURE_FORT_STANDARD:
+        case FIGURE_TRADE_SHIP:
+        case FIGURE_FISHING_BOAT:
+        case FIGURE_MAP_FLAG:
+        case FIGURE_FLOTSAM:
+        case FIGURE_SHIPWRECK:
+        case FIGURE_INDIGENOUS_NATIVE:
+        case FIGURE_TOWER_SENTRY:
+        case FIGURE_NATIVE_TRADER:
+        case FIGURE_ARROW:
+        case FIGURE_JAVELIN:
+        case FIGURE_BOLT:
+        case FIGURE_BALLISTA:
+        case FIGURE_CATAPULT_MISSILE:
+        case FIGURE_FRIENDLY_ARROW:
+        case FIGURE_WATCHTOWER_ARCHER:
+        case FIGURE_CREATURE:
+            return;
+    }
+    if (figure_is_herd(f)) {
+        return;
+    }
+    if (figure_is_legion(f) && f->action_state == FIGURE_ACTION_80_SOLDIER_AT_REST) {
+        return;
+    }
+    int distance = calc_maximum_distance(target_search.x, target_search.y, f->x, f->y);
+    if (distance > target_search.max_distance) {
+        // Can never be chosen: the penalty only makes the distance larger
+        return;
     }
-    if (min_distance <= max_distance && min_figure_id) {
-        return min_figure_id;
+    if (f->targeted_by_figure_id) {
+        distance *= 2;
+    }
+    consider_target(f, distance);
+}
+
+int figure_combat_get_target_for_wolf(int x, int y, int max_distance)
+{
+    start_target_search(x, y, max_distance);
+    map_figure_foreach_in_range(x, y, max_distance, consider_wolf_target);
+    if (target_search.min_distance <= max_distance && target_search.min_figure_id) {
+        return target_search.min_figure_id;
     }
     return 0;
 }
 
+static void consider_enemy_target(figure *f)
+{
+    if (figure_is_dead(f)) {
+        return;
+    }
+    if (!f->targeted_by_figure_id && figure_is_legion(f)) {
+        consider_target(f, calc_maximum_distance(target_search.x, target_search.y, f->x, f->y));
+    }
+}
+
 int figure_combat_get_target_for_enemy(int x, int y)
 {
-    int min_figure_id = 0;
-    int min_distance = 10000;
-    for (int i = 1; i < figure_count(); i++) {
-        figure *f = figure_get(i);
-        if (figure_is_dead(f)) {
-            continue;
-        }
-        if (!f->targeted_by_figure_id && figure_is_legion(f)) {
-            int distance = calc_maximum_distance(x, y, f->x, f->y);
-            if (distance < min_distance) {
-                min_distance = distance;
-                min_figure_id = i;
-            }
+    start_target_search(x, y, 0);
+    // Widen the search until the closest soldier found is inside the searched area,
+    // at which point no soldier outside of it can be closer
+    for (int range = 8; range < 512; range *= 2) {
+        map_figure_foreach_in_range(x, y, range, consider_enemy_target);
+        if (target_search.min_figure_id && target_search.min_distance <= range) {
+            break;
         }
     }
-    if (min_figure_id) {
-        return min_figure_id;
+    if (target_search.min_figure_id) {
+        return target_search.min_figure_id;
     }
     // no 'free' soldier found, take first one
     for (int i = 1; i < figure_count(); i++) {
@@ -204,6 +204,7 @@ void figure_delete(figure *f)
     memset(f, 0, sizeof(figure));
     f->id = figure_id;
 
+    array_release_item(data.figures, figure_id);
     array_trim(data.figures);
 }
 
@@ -243,6 +244,7 @@ void figure_init_scenario(void)
         !array_next(data.figures)) { // Ignore first figure
         log_error("Unable to create figures array. The game will now crash.", 0, 0);
     }
+    array_enable_free_slot_tracking(data.figures);
     data.created_sequence = 0;
 }
 
@@ -556,4 +558,5 @@ void figure_load_state(buffer *list, buffer *seq, int version)
         }
     }
     data.figures.size = highest_id_in_use + 1;
+    array_enable_free_slot_tracking(data.figures);
 }
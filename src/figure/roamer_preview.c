@@ -2,6 +2,7 @@
 
 #include "building/industry.h"
 #include "building/properties.h"
+#include "building/roadblock.h"
 #include "building/rotation.h"
 #include "core/config.h"
 #include "figure/figure.h"
@@ -10,17 +11,52 @@
 #include "map/building.h"
 #include "map/grid.h"
 #include "map/road_access.h"
+#include "map/routing_terrain.h"
 
+#include <stdlib.h>
 #include <string.h>
 
 #define TOTAL_ROAMERS 4
 #define MAX_STORED_BUILDING_TYPES 2
 #define SHOWN_BUILDING_OFFSET 12
+#define MAX_CACHED_PREVIEWS 32
+#define STEPS_CHUNK 1024
+
+typedef enum {
+    STEP_PASSAGE = 0,
+    STEP_EXIT = 1,
+    STEP_ENTRY = 2
+} preview_step;
+
+// The tile changes made by the roamers of a building, which only depend on the road access tiles
+// and the figure type as long as the roads and roadblocks stay the same
+typedef struct {
+    int in_use;
+    figure_type type;
+    int road_offset;
+    int return_offset;
+    unsigned int last_used;
+    int *steps;
+    int num_steps;
+    int capacity;
+} cached_preview;
 
 static struct {
     grid_u8 travelled_tiles;
     building_type types[MAX_STORED_BUILDING_TYPES];
     int stored_building_types;
+    struct {
+        grid_u8 travelled_tiles;
+        int is_valid;
+    } stored_buildings;
+    struct {
+        cached_preview previews[MAX_CACHED_PREVIEWS];
+        cached_preview *recording;
+        unsigned int use_counter;
+        int routing_generation;
+        int roadblock_generation;
+        int disallow_diagonal;
+    } cache;
 } data;
 
 static figure_type building_type_to_figure_type(building_type type)
@@ -201,48 +237,111 @@ static int determine_road_access(int x, int y, int size, building_type type, map
     }
 }
 
-void figure_roamer_preview_create(building_type b_type, int x, int y)
+static void invalidate_stale_cache(void)
 {
-    if (!config_get(CONFIG_UI_SHOW_ROAMING_PATH)) {
-        figure_roamer_preview_reset_building_types();
+    int routing_generation = map_routing_land_citizen_generation();
+    int roadblock_generation = building_roadblock_permission_generation();
+    int disallow_diagonal = config_get(CONFIG_GP_CH_ROAMERS_DONT_SKIP_CORNERS);
+    if (data.cache.routing_generation == routing_generation &&
+        data.cache.roadblock_generation == roadblock_generation &&
+        data.cache.disallow_diagonal == disallow_diagonal) {
         return;
     }
-
-    figure_type fig_type = building_type_to_figure_type(b_type);
-    if (fig_type == FIGURE_NONE) {
-        return;
+    for (int i = 0; i < MAX_CACHED_PREVIEWS; i++) {
+        data.cache.previews[i].in_use = 0;
     }
+    data.stored_buildings.is_valid = 0;
+    data.cache.routing_generation = routing_generation;
+    data.cache.roadblock_generation = roadblock_generation;
+    data.cache.disallow_diagonal = disallow_diagonal;
+}
 
-    if (fig_type == FIGURE_LABOR_SEEKER && config_get(CONFIG_GP_CH_GLOBAL_LABOUR)) {
-        return;
+static cached_preview *find_cached_preview(figure_type type, int road_offset, int return_offset)
+{
+    for (int i = 0; i < MAX_CACHED_PREVIEWS; i++) {
+        cached_preview *preview = &data.cache.previews[i];
+        if (preview->in_use && preview->type == type &&
+            preview->road_offset == road_offset && preview->return_offset == return_offset) {
+            preview->last_used = ++data.cache.use_counter;
+            return preview;
+        }
     }
+    return 0;
+}
 
-    int grid_offset = map_grid_offset(x, y);
-
-    if (data.travelled_tiles.items[grid_offset] == SHOWN_BUILDING_OFFSET) {
-        return;
+static cached_preview *start_recording(figure_type type, int road_offset, int return_offset)
+{
+    cached_preview *preview = &data.cache.previews[0];
+    for (int i = 0; i < MAX_CACHED_PREVIEWS; i++) {
+        if (!data.cache.previews[i].in_use) {
+            preview = &data.cache.previews[i];
+            break;
+        }
+        if (data.cache.previews[i].last_used < preview->last_used) {
+            preview = &data.cache.previews[i];
+        }
     }
+    preview->in_use = 1;
+    preview->type = type;
+    preview->road_offset = road_offset;
+    preview->return_offset = return_offset;
+    preview->last_used = ++data.cache.use_counter;
+    preview->num_steps = 0;
+    return preview;
+}
 
-    data.travelled_tiles.items[grid_offset] = SHOWN_BUILDING_OFFSET;
-
-    int b_size = building_is_farm(b_type) ? 3 : building_properties_for_type(b_type)->size;
+static void apply_step(int grid_offset, preview_step step)
+{
+    uint8_t *tile = &data.travelled_tiles.items[grid_offset];
+    switch (step) {
+        case STEP_PASSAGE:
+            if (*tile < FIGURE_ROAMER_PREVIEW_MAX_PASSAGES) {
+                (*tile)++;
+            }
+            break;
+        case STEP_EXIT:
+            *tile = FIGURE_ROAMER_PREVIEW_EXIT_TILE;
+            break;
+        case STEP_ENTRY:
+            *tile = *tile < FIGURE_ROAMER_PREVIEW_EXIT_TILE ?
+                FIGURE_ROAMER_PREVIEW_ENTRY_TILE : FIGURE_ROAMER_PREVIEW_ENTRY_EXIT_TILE;
+            break;
+    }
+}
 
-    map_point road;
-    if (!determine_road_access(x, y, b_size, b_type, &road)) {
+static void add_step(int grid_offset, preview_step step)
+{
+    apply_step(grid_offset, step);
+    cached_preview *preview = data.cache.recording;
+    if (!preview) {
         return;
     }
+    if (preview->num_steps == preview->capacity) {
+        int capacity = preview->capacity + STEPS_CHUNK;
+        int *steps = realloc(preview->steps, capacity * sizeof(int));
+        if (!steps) {
+            // Out of memory: the preview is still drawn, it just isn't cached
+            preview->in_use = 0;
+            data.cache.recording = 0;
+            return;
+        }
+        preview->steps = steps;
+        preview->capacity = capacity;
+    }
+    preview->steps[preview->num_steps++] = (grid_offset << 2) | step;
+}
 
-    int figure_walks_into_building = figure_enters_exits_building(fig_type);
-
-    int x_road, y_road;
-    int has_closest_road = map_closest_road_within_radius(x, y, b_size, 2, &x_road, &y_road);
-
-    if (figure_walks_into_building && !has_closest_road) {
-        return;
+static void replay_steps(const cached_preview *preview)
+{
+    for (int i = 0; i < preview->num_steps; i++) {
+        apply_step(preview->steps[i] >> 2, preview->steps[i] & 3);
     }
+}
 
+static void simulate_roamers(figure_type fig_type, const map_point *road, int has_closest_road, int x_road, int y_road)
+{
+    int figure_walks_into_building = figure_enters_exits_building(fig_type);
     int roam_length = roam_length_for_figure_type(fig_type);
-
     int should_return = fig_type != FIGURE_SCHOOL_CHILD;
 
     for (int i = 0; i < TOTAL_ROAMERS; i++) {
@@ -250,8 +349,8 @@ void figure_roamer_preview_create(building_type b_type, int x, int y)
         
         memset(&roamer, 0, sizeof(figure));
         
-        roamer.source_x = roamer.destination_x = roamer.previous_tile_x = road.x;
-        roamer.source_y = roamer.destination_y = roamer.previous_tile_y = road.y;
+        roamer.source_x = roamer.destination_x = roamer.previous_tile_x = road->x;
+        roamer.source_y = roamer.destination_y = roamer.previous_tile_y = road->y;
         roamer.terrain_usage = TERRAIN_USAGE_ROADS;
         roamer.direction = DIR_0_TOP;
         roamer.faction_id = FIGURE_FACTION_ROAMER_PREVIEW;
@@ -262,17 +361,17 @@ void figure_roamer_preview_create(building_type b_type, int x, int y)
             roamer.x = x_road;
             roamer.y = y_road;
         } else {
-            roamer.x = road.x;
-            roamer.y = road.y;
+            roamer.x = road->x;
+            roamer.y = road->y;
         }
         roamer.grid_offset = map_grid_offset(roamer.x, roamer.y);
         if (map_grid_is_valid_offset(roamer.grid_offset)) {
-            data.travelled_tiles.items[roamer.grid_offset] = FIGURE_ROAMER_PREVIEW_EXIT_TILE;
+            add_step(roamer.grid_offset, STEP_EXIT);
         }
         init_roaming(&roamer, i * 2, roamer.x, roamer.y);
         while (++roamer.roam_length < roamer.max_roam_length) {
-            if (roamer.progress_on_tile == 0 && data.travelled_tiles.items[roamer.grid_offset] < FIGURE_ROAMER_PREVIEW_MAX_PASSAGES) {
-                data.travelled_tiles.items[roamer.grid_offset]++;
+            if (roamer.progress_on_tile == 0) {
+                add_step(roamer.grid_offset, STEP_PASSAGE);
             }
             figure_movement_roam_ticks(&roamer, 1);
         }
@@ -286,21 +385,70 @@ void figure_roamer_preview_create(building_type b_type, int x, int y)
         roamer.destination_y = y_road;
         while (roamer.direction != DIR_FIGURE_AT_DESTINATION &&
             roamer.direction != DIR_FIGURE_REROUTE && roamer.direction != DIR_FIGURE_LOST) {
-            if (data.travelled_tiles.items[roamer.grid_offset] < FIGURE_ROAMER_PREVIEW_MAX_PASSAGES) {
-                data.travelled_tiles.items[roamer.grid_offset]++;
-            }
+            add_step(roamer.grid_offset, STEP_PASSAGE);
             roamer.progress_on_tile = 15;
             figure_movement_move_ticks(&roamer, 1);
         }
         figure_route_remove(&roamer);
         if (roamer.direction == DIR_FIGURE_AT_DESTINATION) {
-            int tile_type = data.travelled_tiles.items[roamer.grid_offset];
-            data.travelled_tiles.items[roamer.grid_offset] = tile_type < FIGURE_ROAMER_PREVIEW_EXIT_TILE ?
-                FIGURE_ROAMER_PREVIEW_ENTRY_TILE : FIGURE_ROAMER_PREVIEW_ENTRY_EXIT_TILE;
+            add_step(roamer.grid_offset, STEP_ENTRY);
         }
     }
 }
 
+void figure_roamer_preview_create(building_type b_type, int x, int y)
+{
+    if (!config_get(CONFIG_UI_SHOW_ROAMING_PATH)) {
+        figure_roamer_preview_reset_building_types();
+        return;
+    }
+
+    figure_type fig_type = building_type_to_figure_type(b_type);
+    if (fig_type == FIGURE_NONE) {
+        return;
+    }
+
+    if (fig_type == FIGURE_LABOR_SEEKER && config_get(CONFIG_GP_CH_GLOBAL_LABOUR)) {
+        return;
+    }
+
+    int grid_offset = map_grid_offset(x, y);
+
+    if (data.travelled_tiles.items[grid_offset] == SHOWN_BUILDING_OFFSET) {
+        return;
+    }
+
+    data.travelled_tiles.items[grid_offset] = SHOWN_BUILDING_OFFSET;
+
+    int b_size = building_is_farm(b_type) ? 3 : building_properties_for_type(b_type)->size;
+
+    map_point road;
+    if (!determine_road_access(x, y, b_size, b_type, &road)) {
+        return;
+    }
+
+    int figure_walks_into_building = figure_enters_exits_building(fig_type);
+
+    int x_road, y_road;
+    int has_closest_road = map_closest_road_within_radius(x, y, b_size, 2, &x_road, &y_road);
+
+    if (figure_walks_into_building && !has_closest_road) {
+        return;
+    }
+
+    invalidate_stale_cache();
+    int road_offset = map_grid_offset(road.x, road.y);
+    int return_offset = has_closest_road ? map_grid_offset(x_road, y_road) : -1;
+    cached_preview *preview = find_cached_preview(fig_type, road_offset, return_offset);
+    if (preview) {
+        replay_steps(preview);
+        return;
+    }
+    data.cache.recording = start_recording(fig_type, road_offset, return_offset);
+    simulate_roamers(fig_type, &road, has_closest_road, x_road, y_road);
+    data.cache.recording = 0;
+}
+
 void figure_roamer_preview_create_all_for_building_type(building_type type)
 {
     if (type == BUILDING_NONE) {
@@ -323,10 +471,12 @@ void figure_roamer_preview_create_all_for_building_type(building_type type)
     }
     data.types[data.stored_building_types] = type;
     data.stored_building_types++;
+    data.stored_buildings.is_valid = 0;
 }
 
 void figure_roamer_preview_reset(building_type type)
 {
+    invalidate_stale_cache();
     map_grid_clear_u8(data.travelled_tiles.items);
     int show_other_roamers = 0;
     figure_type fig_type = building_type_to_figure_type(type);
@@ -343,18 +493,27 @@ void figure_roamer_preview_reset(building_type type)
             }
         }
     }
-    if (show_other_roamers) {
-        for (int i = 0; i < data.stored_building_types; i++) {
-            for (building *b = building_first_of_type(data.types[i]); b; b = b->next_of_type) {
-                figure_roamer_preview_create(b->type, b->x, b->y);
-            }
+    if (!show_other_roamers) {
+        return;
+    }
+    // The roamers of the stored building types are drawn for every ghost position, so keep the result
+    if (data.stored_buildings.is_valid) {
+        memcpy(data.travelled_tiles.items, data.stored_buildings.travelled_tiles.items, sizeof(grid_u8));
+        return;
+    }
+    for (int i = 0; i < data.stored_building_types; i++) {
+        for (building *b = building_first_of_type(data.types[i]); b; b = b->next_of_type) {
+            figure_roamer_preview_create(b->type, b->x, b->y);
         }
     }
+    memcpy(data.stored_buildings.travelled_tiles.items, data.travelled_tiles.items, sizeof(grid_u8));
+    data.stored_buildings.is_valid = 1;
 }
 
 void figure_roamer_preview_reset_building_types(void)
 {
     data.stored_building_types = 0;
+    data.stored_buildings.is_valid = 0;
     figure_roamer_preview_reset(BUILDING_NONE);
 }
 
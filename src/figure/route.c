@@ -2,11 +2,16 @@
 
 #include "core/array.h"
 #include "core/log.h"
+#include "map/grid.h"
 #include "map/routing.h"
 #include "map/routing_path.h"
+#include "map/routing_terrain.h"
+
+#include <string.h>
 
 #define ARRAY_SIZE_STEP 600
 #define MAX_PATH_LENGTH 500
+#define ROUTE_CACHE_SIZE 4096
 
 typedef struct {
     unsigned int id;
@@ -14,7 +19,23 @@ typedef struct {
     uint8_t directions[MAX_PATH_LENGTH];
 } figure_path_data;
 
+typedef struct {
+    int source_offset;
+    int destination_offset;
+    int terrain_usage;
+    int direction_limit;
+    int generation;
+    int path_length;
+    uint8_t directions[MAX_PATH_LENGTH];
+} cached_route;
+
 static array(figure_path_data) paths;
+static array(figure_route_request) recorded_requests;
+
+// Routes over roads only depend on the citizen land routing grid, so they are kept
+// until that grid is recalculated. Paths that had to fall back to land routing are never
+// cached, as those also depend on where fighting is happening.
+static cached_route route_cache[ROUTE_CACHE_SIZE];
 
 static void create_new_path(figure_path_data *path, unsigned int position)
 {
@@ -41,110 +62,205 @@ void figure_route_clean(void)
             const figure *f = figure_get(figure_id);
             if (f->state != FIGURE_STATE_ALIVE || f->routing_path_id != array_index) {
                 path->figure_id = 0;
+                array_release_item(paths, array_index);
             }
         }
     }
     array_trim(paths);
 }
 
-void figure_route_add(figure *f)
+static int calculate_path(uint8_t *directions, const figure_route_request *request, int *is_road_route)
 {
-    f->routing_path_id = 0;
-    f->routing_path_current_tile = 0;
-    f->routing_path_length = 0;
-    int direction_limit = 8;
-    if (f->disallow_diagonal) {
-        direction_limit = 4;
-    }
-    if (!paths.blocks && !array_init(paths, ARRAY_SIZE_STEP, create_new_path, path_is_used)) {
-        log_error("Unable to create paths array. The game will likely crash.", 0, 0);
-        return;
-    }
-    figure_path_data *path;
-    array_new_item_after_index(paths, 1, path);
-    if (!path) {
-        return;
-    }
     int path_length;
-    if (f->is_boat) {
-        if (f->is_boat == 2) { // flotsam
-            map_routing_calculate_distances_water_flotsam(f->x, f->y);
-            path_length = map_routing_get_path_on_water(path->directions,
-                f->destination_x, f->destination_y, 1);
+    *is_road_route = 0;
+    int direction_limit = request->direction_limit;
+    if (request->is_boat) {
+        if (request->is_boat == 2) { // flotsam
+            map_routing_calculate_distances_water_flotsam(request->x, request->y);
+            path_length = map_routing_get_path_on_water(directions,
+                request->destination_x, request->destination_y, 1);
         } else {
-            map_routing_calculate_distances_water_boat(f->x, f->y);
-            path_length = map_routing_get_path_on_water(path->directions,
-                f->destination_x, f->destination_y, 0);
+            map_routing_calculate_distances_water_boat(request->x, request->y);
+            path_length = map_routing_get_path_on_water(directions,
+                request->destination_x, request->destination_y, 0);
         }
     } else {
         // land figure
         int can_travel;
-        switch (f->terrain_usage) {
+        switch (request->terrain_usage) {
             case TERRAIN_USAGE_ENEMY:
                 // check to see if we can reach our destination by going around the city walls
-                can_travel = map_routing_noncitizen_can_travel_over_land(f->x, f->y,
-                    f->destination_x, f->destination_y, direction_limit, f->destination_building_id, 5000);
+                can_travel = map_routing_noncitizen_can_travel_over_land(request->x, request->y,
+                    request->destination_x, request->destination_y, direction_limit,
+                    request->destination_building_id, 5000);
                 if (!can_travel) {
-                    can_travel = map_routing_noncitizen_can_travel_over_land(f->x, f->y,
-                        f->destination_x, f->destination_y, direction_limit, 0, 25000);
+                    can_travel = map_routing_noncitizen_can_travel_over_land(request->x, request->y,
+                        request->destination_x, request->destination_y, direction_limit, 0, 25000);
                     if (!can_travel) {
-                        can_travel = map_routing_noncitizen_can_travel_through_everything(
-                            f->x, f->y, f->destination_x, f->destination_y, direction_limit);
+                        can_travel = map_routing_noncitizen_can_travel_through_everything(request->x, request->y,
+                            request->destination_x, request->destination_y, direction_limit);
                     }
                 }
                 break;
             case TERRAIN_USAGE_WALLS:
-                can_travel = map_routing_can_travel_over_walls(f->x, f->y,
-                    f->destination_x, f->destination_y, 4);
+                can_travel = map_routing_can_travel_over_walls(request->x, request->y,
+                    request->destination_x, request->destination_y, 4);
                 break;
             case TERRAIN_USAGE_ANIMAL:
-                can_travel = map_routing_noncitizen_can_travel_over_land(f->x, f->y,
-                    f->destination_x, f->destination_y, direction_limit, -1, 5000);
+                can_travel = map_routing_noncitizen_can_travel_over_land(request->x, request->y,
+                    request->destination_x, request->destination_y, direction_limit, -1, 5000);
                 break;
             case TERRAIN_USAGE_PREFER_ROADS:
-                can_travel = map_routing_citizen_can_travel_over_road_garden(f->x, f->y,
-                    f->destination_x, f->destination_y, direction_limit);
+                can_travel = map_routing_citizen_can_travel_over_road_garden(request->x, request->y,
+                    request->destination_x, request->destination_y, direction_limit);
+                *is_road_route = can_travel;
                 if (!can_travel) {
-                    can_travel = map_routing_citizen_can_travel_over_land(f->x, f->y,
-                        f->destination_x, f->destination_y, direction_limit);
+                    can_travel = map_routing_citizen_can_travel_over_land(request->x, request->y,
+                        request->destination_x, request->destination_y, direction_limit);
                 }
                 break;
             case TERRAIN_USAGE_ROADS:
-                can_travel = map_routing_citizen_can_travel_over_road_garden(f->x, f->y,
-                    f->destination_x, f->destination_y, direction_limit);
+                can_travel = map_routing_citizen_can_travel_over_road_garden(request->x, request->y,
+                    request->destination_x, request->destination_y, direction_limit);
+                *is_road_route = can_travel;
                 break;
             case TERRAIN_USAGE_PREFER_ROADS_HIGHWAY:
-                can_travel = map_routing_citizen_can_travel_over_road_garden_highway(f->x, f->y,
-                    f->destination_x, f->destination_y, direction_limit);
+                can_travel = map_routing_citizen_can_travel_over_road_garden_highway(request->x, request->y,
+                    request->destination_x, request->destination_y, direction_limit);
+                *is_road_route = can_travel;
                 if (!can_travel) {
-                    can_travel = map_routing_citizen_can_travel_over_land(f->x, f->y,
-                        f->destination_x, f->destination_y, direction_limit);
+                    can_travel = map_routing_citizen_can_travel_over_land(request->x, request->y,
+                        request->destination_x, request->destination_y, direction_limit);
                 }
                 break;
             case TERRAIN_USAGE_ROADS_HIGHWAY:
-                can_travel = map_routing_citizen_can_travel_over_road_garden_highway(f->x, f->y,
-                    f->destination_x, f->destination_y, direction_limit);
+                can_travel = map_routing_citizen_can_travel_over_road_garden_highway(request->x, request->y,
+                    request->destination_x, request->destination_y, direction_limit);
+                *is_road_route = can_travel;
                 break;
             default:
-                can_travel = map_routing_citizen_can_travel_over_land(f->x, f->y,
-                    f->destination_x, f->destination_y, direction_limit);
+                can_travel = map_routing_citizen_can_travel_over_land(request->x, request->y,
+                    request->destination_x, request->destination_y, direction_limit);
                 break;
         }
         if (can_travel) {
-            if (f->terrain_usage == TERRAIN_USAGE_WALLS) {
-                path_length = map_routing_get_path(path->directions, f->destination_x, f->destination_y, 4);
+            if (request->terrain_usage == TERRAIN_USAGE_WALLS) {
+                path_length = map_routing_get_path(directions, request->destination_x, request->destination_y, 4);
                 if (path_length <= 0) {
-                    path_length = map_routing_get_path(path->directions,
-                        f->destination_x, f->destination_y, direction_limit);
+                    path_length = map_routing_get_path(directions,
+                        request->destination_x, request->destination_y, direction_limit);
                 }
             } else {
-                path_length = map_routing_get_path(path->directions,
-                    f->destination_x, f->destination_y, direction_limit);
+                path_length = map_routing_get_path(directions,
+                    request->destination_x, request->destination_y, direction_limit);
             }
         } else { // cannot travel
             path_length = 0;
         }
     }
+    return path_length;
+}
+
+static int can_cache_route(const figure_route_request *request)
+{
+    if (request->is_boat) {
+        return 0;
+    }
+    switch (request->terrain_usage) {
+        case TERRAIN_USAGE_ROADS:
+        case TERRAIN_USAGE_ROADS_HIGHWAY:
+        case TERRAIN_USAGE_PREFER_ROADS:
+        case TERRAIN_USAGE_PREFER_ROADS_HIGHWAY:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static cached_route *get_cache_slot(const figure_route_request *request)
+{
+    unsigned int source_offset = map_grid_offset(request->x, request->y);
+    unsigned int destination_offset = map_grid_offset(request->destination_x, request->destination_y);
+    unsigned int hash = (source_offset * 2654435761u) ^ (destination_offset * 40503u) ^
+        (request->terrain_usage << 8) ^ request->direction_limit;
+    return &route_cache[(hash ^ (hash >> 16)) % ROUTE_CACHE_SIZE];
+}
+
+static int is_cached_route_for(const cached_route *route, const figure_route_request *request)
+{
+    return route->path_length > 0 &&
+        route->generation == map_routing_land_citizen_generation() &&
+        route->source_offset == map_grid_offset(request->x, request->y) &&
+        route->destination_offset == map_grid_offset(request->destination_x, request->destination_y) &&
+        route->terrain_usage == request->terrain_usage &&
+        route->direction_limit == request->direction_limit;
+}
+
+static int get_path(uint8_t *directions, const figure_route_request *request)
+{
+    if (!can_cache_route(request)) {
+        int is_road_route;
+        return calculate_path(directions, request, &is_road_route);
+    }
+    cached_route *route = get_cache_slot(request);
+    if (is_cached_route_for(route, request)) {
+        memcpy(directions, route->directions, route->path_length);
+        map_routing_count_reused_route();
+        return route->path_length;
+    }
+    int is_road_route;
+    int path_length = calculate_path(directions, request, &is_road_route);
+    if (path_length > 0 && is_road_route) {
+        route->source_offset = map_grid_offset(request->x, request->y);
+        route->destination_offset = map_grid_offset(request->destination_x, request->destination_y);
+        route->terrain_usage = request->terrain_usage;
+        route->direction_limit = request->direction_limit;
+        route->generation = map_routing_land_citizen_generation();
+        route->path_length = path_length;
+        memcpy(route->directions, directions, path_length);
+    }
+    return path_length;
+}
+
+static void record_request(const figure_route_request *request)
+{
+    figure_route_request *recorded = array_advance(recorded_requests);
+    if (recorded) {
+        *recorded = *request;
+    }
+}
+
+void figure_route_add(figure *f)
+{
+    f->routing_path_id = 0;
+    f->routing_path_current_tile = 0;
+    f->routing_path_length = 0;
+    if (!paths.blocks) {
+        if (!array_init(paths, ARRAY_SIZE_STEP, create_new_path, path_is_used)) {
+            log_error("Unable to create paths array. The game will likely crash.", 0, 0);
+            return;
+        }
+        array_enable_free_slot_tracking(paths);
+    }
+    figure_path_data *path;
+    array_new_item_after_index(paths, 1, path);
+    if (!path) {
+        return;
+    }
+    figure_route_request request = {
+        .x = f->x,
+        .y = f->y,
+        .destination_x = f->destination_x,
+        .destination_y = f->destination_y,
+        .destination_building_id = f->destination_building_id,
+        .terrain_usage = f->terrain_usage,
+        .is_boat = f->is_boat,
+        .direction_limit = f->disallow_diagonal ? 4 : 8
+    };
+    if (recorded_requests.blocks) {
+        record_request(&request);
+    }
+    int path_length = get_path(path->directions, &request);
     if (path_length) {
         path->figure_id = f->id;
         f->routing_path_id = path->id;
@@ -157,6 +273,7 @@ void figure_route_remove(figure *f)
     if (f->routing_path_id > 0) {
         if (f->routing_path_id < paths.size && array_item(paths, f->routing_path_id)->figure_id == f->id) {
             array_item(paths, f->routing_path_id)->figure_id = 0;
+            array_release_item(paths, f->routing_path_id);
         }
         f->routing_path_id = 0;
     }
@@ -168,10 +285,33 @@ int figure_route_get_direction(int path_id, int index)
     return array_item(paths, path_id)->directions[index];
 }
 
+void figure_route_record_requests(int enable)
+{
+    if (enable) {
+        if (!array_init(recorded_requests, ARRAY_SIZE_STEP, 0, 0)) {
+            log_error("Unable to create route requests array.", 0, 0);
+        }
+    } else {
+        array_clear(recorded_requests);
+    }
+}
+
+int figure_route_replay_recorded_requests(void)
+{
+    uint8_t directions[MAX_PATH_LENGTH];
+    int is_road_route;
+    const figure_route_request *request;
+    array_foreach(recorded_requests, request) {
+        calculate_path(directions, request, &is_road_route);
+    }
+    return recorded_requests.size;
+}
+
 void figure_route_save_state(buffer *figures, buffer *buf_paths)
 {
     int size = paths.size * sizeof(int);
     uint8_t *buf_data = malloc(size);
+    memset(buf_data, 0, size);
     buffer_init(figures, buf_data, size);
 
     size = paths.size * sizeof(uint8_t) * MAX_PATH_LENGTH;
@@ -206,4 +346,5 @@ void figure_route_load_state(buffer *figures, buffer *buf_paths)
         }
     }
     paths.size = highest_id_in_use + 1;
+    array_enable_free_slot_tracking(paths);
 }
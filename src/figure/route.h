@@ -4,6 +4,17 @@
 #include "core/buffer.h"
 #include "figure/figure.h"
 
+typedef struct {
+    int x;
+    int y;
+    int destination_x;
+    int destination_y;
+    int destination_building_id;
+    int terrain_usage;
+    int is_boat;
+    int direction_limit;
+} figure_route_request;
+
 void figure_route_clear_all(void);
 
 void figure_route_clean(void);
@@ -14,6 +25,19 @@ void figure_route_remove(figure *f);
 
 int figure_route_get_direction(int path_id, int index);
 
+/**
+ * Starts or stops recording every route request made through figure_route_add
+ * @param enable Whether to record requests. Disabling discards the recorded requests.
+ */
+void figure_route_record_requests(int enable);
+
+/**
+ * Calculates again every recorded route request on the current map, discarding the resulting paths.
+ * Used to benchmark the routing code.
+ * @return The number of requests that were replayed
+ */
+int figure_route_replay_recorded_requests(void);
+
 void figure_route_save_state(buffer *figures, buffer *buf_paths);
 
 void figure_route_load_state(buffer *figures, buffer *buf_paths);
@@ -21,19 +21,13 @@
 static int provide_culture(int x, int y, void (*callback)(building *))
 {
     int serviced = 0;
-    int x_min, y_min, x_max, y_max;
-    map_grid_get_area(x, y, 1, 2, &x_min, &y_min, &x_max, &y_max);
-    for (int yy = y_min; yy <= y_max; yy++) {
-        for (int xx = x_min; xx <= x_max; xx++) {
-            int grid_offset = map_grid_offset(xx, yy);
-            int building_id = map_building_at(grid_offset);
-            if (building_id) {
-                building *b = building_get(building_id);
-                if (b->house_size && b->house_population > 0) {
-                    callback(b);
-                    serviced++;
-                }
-            }
+    const uint16_t *building_ids;
+    int num_buildings = map_building_get_nearby(x, y, &building_ids);
+    for (int i = 0; i < num_buildings; i++) {
+        building *b = building_get(building_ids[i]);
+        if (b->house_size && b->house_population > 0) {
+            callback(b);
+            serviced++;
         }
     }
     return serviced;
@@ -41,20 +35,14 @@ static int provide_culture(int x, int y, void (*callback)(building *))
 
 static void provide_sickness(int x, int y, void (*callback)(building *, int sickness_dest), int sickness_dest)
 {
-    int x_min, y_min, x_max, y_max;
-    map_grid_get_area(x, y, 1, 2, &x_min, &y_min, &x_max, &y_max);
-    for (int yy = y_min; yy <= y_max; yy++) {
-        for (int xx = x_min; xx <= x_max; xx++) {
-            int grid_offset = map_grid_offset(xx, yy);
-            int building_id = map_building_at(grid_offset);
-            if (building_id) {
-                building *b = building_get(building_id);
-                random_generate_next();
-                // 1/16 chance of spreading sickness
-                if (b->house_size && b->house_population > 0 && !(random_short() & 0xf)) {
-                    callback(b, sickness_dest);
-                }
-            }
+    const uint16_t *building_ids;
+    int num_buildings = map_building_get_nearby(x, y, &building_ids);
+    for (int i = 0; i < num_buildings; i++) {
+        building *b = building_get(building_ids[i]);
+        random_generate_next();
+        // 1/16 chance of spreading sickness
+        if (b->house_size && b->house_population > 0 && !(random_short() & 0xf)) {
+            callback(b, sickness_dest);
         }
     }
 }
@@ -62,19 +50,13 @@ static void provide_sickness(int x, int y, void (*callback)(building *, int sick
 static int provide_entertainment(int x, int y, int shows, void (*callback)(building *, int))
 {
     int serviced = 0;
-    int x_min, y_min, x_max, y_max;
-    map_grid_get_area(x, y, 1, 2, &x_min, &y_min, &x_max, &y_max);
-    for (int yy = y_min; yy <= y_max; yy++) {
-        for (int xx = x_min; xx <= x_max; xx++) {
-            int grid_offset = map_grid_offset(xx, yy);
-            int building_id = map_building_at(grid_offset);
-            if (building_id) {
-                building *b = building_get(building_id);
-                if (b->house_size && b->house_population > 0) {
-                    callback(b, shows);
-                    serviced++;
-                }
-            }
+    const uint16_t *building_ids;
+    int num_buildings = map_building_get_nearby(x, y, &building_ids);
+    for (int i = 0; i < num_buildings; i++) {
+        building *b = building_get(building_ids[i]);
+        if (b->house_size && b->house_population > 0) {
+            callback(b, shows);
+            serviced++;
         }
     }
     return serviced;
@@ -220,17 +202,11 @@ static int provide_missionary_coverage(int x, int y)
 static int tourist_visit(int x, int y, figure *f, void (*callback)(building *, figure *))
 {
     int serviced = 0;
-    int x_min, y_min, x_max, y_max;
-    map_grid_get_area(x, y, 1, 2, &x_min, &y_min, &x_max, &y_max);
-    for (int yy = y_min; yy <= y_max; yy++) {
-        for (int xx = x_min; xx <= x_max; xx++) {
-            int grid_offset = map_grid_offset(xx, yy);
-            int building_id = map_building_at(grid_offset);
-            if (building_id) {
-                building *b = building_get(building_id);
-                callback(b, f);
-            }
-        }
+    const uint16_t *building_ids;
+    int num_buildings = map_building_get_nearby(x, y, &building_ids);
+    for (int i = 0; i < num_buildings; i++) {
+        building *b = building_get(building_ids[i]);
+        callback(b, f);
     }
     return serviced;
 }
@@ -272,19 +248,13 @@ static void tourist_spend(building *b, figure *f)
 static int provide_service(int x, int y, int *data, void (*callback)(building *, int *))
 {
     int serviced = 0;
-    int x_min, y_min, x_max, y_max;
-    map_grid_get_area(x, y, 1, 2, &x_min, &y_min, &x_max, &y_max);
-    for (int yy = y_min; yy <= y_max; yy++) {
-        for (int xx = x_min; xx <= x_max; xx++) {
-            int grid_offset = map_grid_offset(xx, yy);
-            int building_id = map_building_at(grid_offset);
-            if (building_id) {
-                building *b = building_get(building_id);
-                callback(b, data);
-                if (b->house_size && b->house_population > 0) {
-                    serviced++;
-                }
-            }
+    const uint16_t *building_ids;
+    int num_buildings = map_building_get_nearby(x, y, &building_ids);
+    for (int i = 0; i < num_buildings; i++) {
+        building *b = building_get(building_ids[i]);
+        callback(b, data);
+        if (b->house_size && b->house_population > 0) {
+            serviced++;
         }
     }
     return serviced;
@@ -427,20 +397,13 @@ static int provide_market_goods(int market_building_id, int x, int y)
 {
     int serviced = 0;
     building *market = building_get(market_building_id);
-    int x_min, y_min, x_max, y_max;
-    map_grid_get_area(x, y, 1, 2, &x_min, &y_min, &x_max, &y_max);
-    for (int yy = y_min; yy <= y_max; yy++) {
-        for (int xx = x_min; xx <= x_max; xx++) {
-            int grid_offset = map_grid_offset(xx, yy);
-            int building_id = map_building_at(grid_offset);
-            if (building_id) {
-                building *b = building_get(building_id);
-                if (b->house_size && b->house_population > 0) {
-                    distribute_market_resources(b, market);
-                    serviced++;
-                }
-
-            }
+    const uint16_t *building_ids;
+    int num_buildings = map_building_get_nearby(x, y, &building_ids);
+    for (int i = 0; i < num_buildings; i++) {
+        building *b = building_get(building_ids[i]);
+        if (b->house_size && b->house_population > 0) {
+            distribute_market_resources(b, market);
+            serviced++;
         }
     }
     return serviced;
@@ -450,28 +413,22 @@ static int provide_venus_wine_to_taverns(int market_building_id, int x, int y)
 {
     int serviced = 0;
     building *market = building_get(market_building_id);
-    int x_min, y_min, x_max, y_max;
-    map_grid_get_area(x, y, 1, 2, &x_min, &y_min, &x_max, &y_max);
-    for (int yy = y_min; yy <= y_max; yy++) {
-        for (int xx = x_min; xx <= x_max; xx++) {
-            int grid_offset = map_grid_offset(xx, yy);
-            int building_id = map_building_at(grid_offset);
-            if (building_id) {
-                building *b = building_get(building_id);
-                if (b->type == BUILDING_TAVERN) {
-                    int amount_wanted = 200 - b->resources[RESOURCE_WINE];
-                    if (market->resources[RESOURCE_WINE] > 0 && amount_wanted > 0) {
-                        if (amount_wanted <= market->resources[RESOURCE_WINE]) {
-                            b->resources[RESOURCE_WINE] += amount_wanted;
-                            market->resources[RESOURCE_WINE] -= amount_wanted;
-                        } else {
-                            b->resources[RESOURCE_WINE] += market->resources[RESOURCE_WINE];
-                            market->resources[RESOURCE_WINE] = 0;
-                        }
-                    }
-                    serviced++;
+    const uint16_t *building_ids;
+    int num_buildings = map_building_get_nearby(x, y, &building_ids);
+    for (int i = 0; i < num_buildings; i++) {
+        building *b = building_get(building_ids[i]);
+        if (b->type == BUILDING_TAVERN) {
+            int amount_wanted = 200 - b->resources[RESOURCE_WINE];
+            if (market->resources[RESOURCE_WINE] > 0 && amount_wanted > 0) {
+                if (amount_wanted <= market->resources[RESOURCE_WINE]) {
+                    b->resources[RESOURCE_WINE] += amount_wanted;
+                    market->resources[RESOURCE_WINE] -= amount_wanted;
+                } else {
+                    b->resources[RESOURCE_WINE] += market->resources[RESOURCE_WINE];
+                    market->resources[RESOURCE_WINE] = 0;
                 }
             }
+            serviced++;
         }
     }
     return serviced;
@@ -481,19 +438,13 @@ static int collect_offerings(int market_building_id, int x, int y)
 {
     int serviced = 0;
     building *market = building_get(market_building_id);
-    int x_min, y_min, x_max, y_max;
-    map_grid_get_area(x, y, 1, 2, &x_min, &y_min, &x_max, &y_max);
-    for (int yy = y_min; yy <= y_max; yy++) {
-        for (int xx = x_min; xx <= x_max; xx++) {
-            int grid_offset = map_grid_offset(xx, yy);
-            int building_id = map_building_at(grid_offset);
-            if (building_id) {
-                building *b = building_get(building_id);
-                if (b->house_size && b->house_population > 0) {
-                    collect_offerings_from_house(b, market);
-                    serviced++;
-                }
-            }
+    const uint16_t *building_ids;
+    int num_buildings = map_building_get_nearby(x, y, &building_ids);
+    for (int i = 0; i < num_buildings; i++) {
+        building *b = building_get(building_ids[i]);
+        if (b->house_size && b->house_population > 0) {
+            collect_offerings_from_house(b, market);
+            serviced++;
         }
     }
     return serviced;
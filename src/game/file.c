@@ -35,6 +35,7 @@
 #include "game/campaign.h"
 #include "game/difficulty.h"
 #include "game/file_io.h"
+#include "game/journal.h"
 #include "game/settings.h"
 #include "game/state.h"
 #include "game/time.h"
@@ -305,6 +306,7 @@ static void initialize_saved_game(void)
 
 static int start_scenario(const uint8_t *scenario_name, const char *scenario_file)
 {
+    game_journal_game_unloading();
     int mission = scenario_campaign_mission();
     int rank = scenario_campaign_rank();
     map_bookmarks_clear();
@@ -338,6 +340,7 @@ static int start_scenario(const uint8_t *scenario_name, const char *scenario_fil
     }
     building_menu_update();
     city_message_init_scenario();
+    game_journal_game_loaded();
 
     return 1;
 }
@@ -354,6 +357,7 @@ static const char *get_scenario_filename(const uint8_t *scenario_name, const cha
 
 int game_file_start_scenario_from_buffer(uint8_t *data, int length, int is_save_game)
 {
+    game_journal_game_unloading();
     buffer buf;
     buffer_init(&buf, data, length);
     int mission = scenario_campaign_mission();
@@ -410,6 +414,7 @@ int game_file_start_scenario_from_buffer(uint8_t *data, int length, int is_save_
     }
     building_menu_update();
     city_message_init_scenario();
+    game_journal_game_loaded();
 
     return 1;
 }
@@ -430,6 +435,7 @@ int game_file_start_scenario_by_name(const uint8_t *scenario_name)
 
 int game_file_load_saved_game(const char *filename)
 {
+    game_journal_game_unloading();
     game_campaign_suspend();
     int result = game_file_io_read_saved_game(filename, 0);
     if (result != FILE_LOAD_SUCCESS) {
@@ -444,6 +450,7 @@ int game_file_load_saved_game(const char *filename)
     building_storage_reset_building_ids();
 
     sound_music_update(1);
+    game_journal_game_loaded();
     return 1;
 }
 
@@ -452,6 +459,16 @@ int game_file_write_saved_game(const char *filename)
     return game_file_io_write_saved_game(filename);
 }
 
+int game_file_write_saved_game_in_background(const char **filenames, int num_files)
+{
+    return game_file_io_write_saved_game_in_background(filenames, num_files);
+}
+
+void game_file_finish_background_save(int wait)
+{
+    game_file_io_finish_background_save(wait);
+}
+
 int game_file_delete_saved_game(const char *filename)
 {
     return game_file_io_delete_saved_game(filename);
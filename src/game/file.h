@@ -41,6 +41,21 @@ int game_file_load_saved_game(const char *filename);
  */
 int game_file_write_saved_game(const char *filename);
 
+/**
+ * Write the current game state to one or more saved games without blocking the game:
+ * the state is serialized right away, compression and writing happen in the background
+ * @param filenames Files to save to, at most two
+ * @param num_files Number of files
+ * @return Boolean true if the save was started, false if no file could be opened
+ */
+int game_file_write_saved_game_in_background(const char **filenames, int num_files);
+
+/**
+ * Complete a background save once it is done writing
+ * @param wait Whether to wait for the background save to finish
+ */
+void game_file_finish_background_save(int wait);
+
 /**
  * Delete saved game
  * @param filename File to delete
@@ -16,6 +16,7 @@
 #include "core/memory_block.h"
 #include "core/random.h"
 #include "core/string.h"
+#include "core/thread.h"
 #include "core/zip.h"
 #include "core/zlib_helper.h"
 #include "empire/city.h"
@@ -277,12 +278,52 @@ typedef struct {
     } features;
 } savegame_version_data;
 
+#define MAX_SAVEGAME_PIECES (sizeof(savegame_state) / sizeof(buffer *) + 1)
+
 static struct {
     int num_pieces;
-    file_piece pieces[sizeof(savegame_state) / sizeof(buffer *) + 1];
+    file_piece pieces[MAX_SAVEGAME_PIECES];
     savegame_state state;
 } savegame_data;
 
+#define MAX_COMPRESSION_THREADS 8
+
+typedef struct {
+    int index;
+    void *data;
+    int size;
+    memory_block compressed;
+    int compressed_size;
+    int result;
+} piece_compression;
+
+typedef struct {
+    piece_compression *pieces;
+    int num_pieces;
+    int first;
+    int step;
+    int (*process)(piece_compression *piece);
+} compression_worker;
+
+#define MAX_BACKGROUND_SAVE_FILES 2
+
+typedef struct {
+    int num_pieces;
+    file_piece pieces[MAX_SAVEGAME_PIECES];
+    int num_files;
+    FILE *files[MAX_BACKGROUND_SAVE_FILES];
+    char filenames[MAX_BACKGROUND_SAVE_FILES][FILE_NAME_MAX];
+    char temp_filenames[MAX_BACKGROUND_SAVE_FILES][FILE_NAME_MAX];
+    int result;
+} background_save_job;
+
+static struct {
+    thread_handle *thread;
+    int in_progress;
+    int rename_failed;
+    background_save_job job;
+} background_save;
+
 static struct {
     minimap_functions functions;
     savegame_version_t version;
@@ -1396,17 +1437,143 @@ static int savegame_read_from_buffer(buffer *buf, savegame_version_t version)
     return 1;
 }
 
-static int savegame_read_from_file(FILE *fp, savegame_version_t version)
+static int run_compression_worker(void *data)
+{
+    compression_worker *worker = data;
+    for (int i = worker->first; i < worker->num_pieces; i += worker->step) {
+        worker->pieces[i].result = worker->process(&worker->pieces[i]);
+    }
+    return 1;
+}
+
+static void process_pieces_in_parallel(piece_compression *pieces, int num_pieces,
+    int (*process)(piece_compression *piece))
 {
+    compression_worker workers[MAX_COMPRESSION_THREADS];
+    thread_handle *threads[MAX_COMPRESSION_THREADS];
+    int num_workers = thread_get_cpu_count();
+    if (num_workers > MAX_COMPRESSION_THREADS) {
+        num_workers = MAX_COMPRESSION_THREADS;
+    }
+    if (num_workers > num_pieces) {
+        num_workers = num_pieces;
+    }
+    for (int i = 0; i < num_workers; i++) {
+        workers[i].pieces = pieces;
+        workers[i].num_pieces = num_pieces;
+        workers[i].first = i;
+        workers[i].step = num_workers;
+        workers[i].process = process;
+    }
+    // The calling thread handles its share of the pieces as well
+    for (int i = 1; i < num_workers; i++) {
+        threads[i] = thread_create("savegame compression", run_compression_worker, &workers[i]);
+    }
+    if (num_workers > 0) {
+        run_compression_worker(&workers[0]);
+    }
+    for (int i = 1; i < num_workers; i++) {
+        if (threads[i]) {
+            thread_wait(threads[i]);
+        } else {
+            run_compression_worker(&workers[i]);
+        }
+    }
+}
+
+static void free_piece_compressions(piece_compression *pieces, int num_pieces)
+{
+    for (int i = 0; i < num_pieces; i++) {
+        core_memory_block_free(&pieces[i].compressed);
+    }
+}
+
+static int decompress_piece(piece_compression *piece)
+{
+    int output_size = 0;
+    return zlib_helper_decompress(piece->compressed.memory, piece->compressed_size,
+        piece->data, piece->size, &output_size);
+}
+
+static int read_piece_for_decompression(FILE *fp, file_piece *piece, piece_compression *compression)
+{
+    int input_size = read_int32(fp);
+    if ((unsigned int) input_size == UNCOMPRESSED) {
+        return fread(piece->buf.data, 1, piece->buf.size, fp) == piece->buf.size;
+    }
+    if (!core_memory_block_init(&compression->compressed, input_size)) {
+        return 0;
+    }
+    if (fread(compression->compressed.memory, 1, input_size, fp) != input_size) {
+        core_memory_block_free(&compression->compressed);
+        return 0;
+    }
+    compression->data = piece->buf.data;
+    compression->size = (int) piece->buf.size;
+    compression->compressed_size = input_size;
+    return 1;
+}
+
+static int is_file_info_piece(const file_piece *piece)
+{
+    const savegame_state *state = &savegame_data.state;
+    const buffer *info_pieces[] = {
+        state->resource_version, state->scenario_campaign_mission, state->file_version, state->scenario_version,
+        state->scenario_is_custom, state->scenario_name, state->campaign_name, state->city_data, state->game_time,
+        state->scenario, state->invasions, state->terrain_grid, state->edge_grid, state->bitfields_grid,
+        state->random_grid, state->building_grid, state->buildings
+    };
+    for (int i = 0; i < sizeof(info_pieces) / sizeof(buffer *); i++) {
+        if (info_pieces[i] == &piece->buf) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int skip_piece_in_file(FILE *fp, const file_piece *piece)
+{
+    long size = (long) piece->buf.size;
+    if (piece->dynamic) {
+        size = read_int32(fp);
+        if (!size) {
+            return 1;
+        }
+    }
+    if (piece->compressed) {
+        int input_size = read_int32(fp);
+        if ((unsigned int) input_size != UNCOMPRESSED) {
+            size = input_size;
+        }
+    }
+    return fseek(fp, size, SEEK_CUR) == 0;
+}
+
+static int savegame_read_from_file(FILE *fp, savegame_version_t version, int info_only)
+{
+    // Old saved games use the PKWare compression, which can't run on threads: those are decompressed in place
+    int decompress_in_parallel = version > SAVE_GAME_LAST_ZIP_COMPRESSION;
+    piece_compression compression[MAX_SAVEGAME_PIECES];
+    int num_compressed = 0;
     memory_block compress_buffer;
     core_memory_block_init(&compress_buffer, COMPRESS_BUFFER_INITIAL_SIZE);
     for (int i = 0; i < savegame_data.num_pieces; i++) {
         file_piece *piece = &savegame_data.pieces[i];
         int result = 0;
-        if (!prepare_dynamic_piece_from_file(fp, piece)) {
+        if (info_only && !is_file_info_piece(piece)) {
+            // Only the pieces needed for the saved game info are read, the rest is skipped without decompressing
+            result = skip_piece_in_file(fp, piece);
+        } else if (!prepare_dynamic_piece_from_file(fp, piece)) {
             continue;
-        }
-        if (piece->compressed) {
+        } else if (piece->compressed && decompress_in_parallel) {
+            piece_compression *current = &compression[num_compressed];
+            memset(current, 0, sizeof(piece_compression));
+            current->index = i;
+            result = read_piece_for_decompression(fp, piece, current);
+            if (result && current->compressed.memory) {
+                num_compressed++;
+            }
+        } else if (piece->compressed) {
             result = read_compressed_savegame_chunk(fp, piece->buf.data, piece->buf.size, version, &compress_buffer);
         } else {
             result = fread(piece->buf.data, 1, piece->buf.size, fp) == piece->buf.size;
@@ -1415,30 +1582,101 @@ static int savegame_read_from_file(FILE *fp, savegame_version_t version)
         if (!result && i != (savegame_data.num_pieces - 1)) {
             log_info("Incorrect buffer size, got", 0, result);
             log_info("Incorrect buffer size, expected", 0, (int) piece->buf.size);
+            free_piece_compressions(compression, num_compressed);
             core_memory_block_free(&compress_buffer);
             return 0;
         }
     }
     core_memory_block_free(&compress_buffer);
-    return 1;
+
+    process_pieces_in_parallel(compression, num_compressed, decompress_piece);
+    int result = 1;
+    for (int i = 0; i < num_compressed; i++) {
+        if (!compression[i].result && compression[i].index != (savegame_data.num_pieces - 1)) {
+            log_info("Incorrect buffer size, got", 0, 0);
+            log_info("Incorrect buffer size, expected", 0, compression[i].size);
+            result = 0;
+            break;
+        }
+    }
+    free_piece_compressions(compression, num_compressed);
+    return result;
 }
 
-static void savegame_write_to_file(FILE *fp, memory_block *compress_buffer)
+static void write_int32_to_files(FILE **files, int num_files, int value)
 {
-    for (int i = 0; i < savegame_data.num_pieces; i++) {
-        file_piece *piece = &savegame_data.pieces[i];
+    for (int i = 0; i < num_files; i++) {
+        write_int32(files[i], value);
+    }
+}
+
+static void write_to_files(FILE **files, int num_files, const void *data, size_t size)
+{
+    for (int i = 0; i < num_files; i++) {
+        fwrite(data, 1, size, files[i]);
+    }
+}
+
+static int compress_piece(piece_compression *piece)
+{
+    // Compressed data that doesn't fit in COMPRESS_BUFFER_INITIAL_SIZE is stored uncompressed,
+    // so the buffer never needs to be larger than that
+    int capacity = zlib_helper_compress_bound(piece->size);
+    if (capacity > COMPRESS_BUFFER_INITIAL_SIZE) {
+        capacity = COMPRESS_BUFFER_INITIAL_SIZE;
+    }
+    if (!core_memory_block_init(&piece->compressed, capacity)) {
+        return 0;
+    }
+    return zlib_helper_compress(piece->data, piece->size, piece->compressed.memory, capacity, &piece->compressed_size);
+}
+
+static void write_savegame_pieces(const file_piece *pieces, int num_pieces, FILE **files, int num_files)
+{
+    piece_compression compression[MAX_SAVEGAME_PIECES];
+    int num_compressed = 0;
+    for (int i = 0; i < num_pieces; i++) {
+        const file_piece *piece = &pieces[i];
+        if (piece->compressed && (!piece->dynamic || piece->buf.size)) {
+            piece_compression *current = &compression[num_compressed++];
+            memset(current, 0, sizeof(piece_compression));
+            current->index = i;
+            current->data = piece->buf.data;
+            current->size = (int) piece->buf.size;
+        }
+    }
+    process_pieces_in_parallel(compression, num_compressed, compress_piece);
+
+    // Each piece is compressed once and written to all files
+    int current = 0;
+    for (int i = 0; i < num_pieces; i++) {
+        const file_piece *piece = &pieces[i];
         if (piece->dynamic) {
-            write_int32(fp, (int) piece->buf.size);
+            write_int32_to_files(files, num_files, (int) piece->buf.size);
             if (!piece->buf.size) {
                 continue;
             }
         }
-        if (piece->compressed) {
-            write_compressed_chunk(fp, piece->buf.data, piece->buf.size, compress_buffer);
+        if (!piece->compressed) {
+            write_to_files(files, num_files, piece->buf.data, piece->buf.size);
+            continue;
+        }
+        const piece_compression *compressed = &compression[current++];
+        if (compressed->result) {
+            write_int32_to_files(files, num_files, compressed->compressed_size);
+            write_to_files(files, num_files, compressed->compressed.memory, compressed->compressed_size);
         } else {
-            fwrite(piece->buf.data, 1, piece->buf.size, fp);
+            // unable to compress: write uncompressed
+            write_int32_to_files(files, num_files, UNCOMPRESSED);
+            write_to_files(files, num_files, piece->buf.data, piece->buf.size);
         }
     }
+    free_piece_compressions(compression, num_compressed);
+}
+
+static void savegame_write_to_file(FILE *fp)
+{
+    write_savegame_pieces(savegame_data.pieces, savegame_data.num_pieces, &fp, 1);
 }
 
 static int get_savegame_versions_from_buffer(buffer *buf, savegame_version_t *save_version,
@@ -1508,6 +1746,7 @@ int game_file_io_read_save_game_from_buffer(buffer *buf)
 
 int game_file_io_read_saved_game(const char *filename, int offset)
 {
+    game_file_io_finish_background_save(1);
     log_info("Loading saved game", filename, 0);
     FILE *fp = file_open(filename, "rb");
     if (!fp) {
@@ -1529,7 +1768,7 @@ int game_file_io_read_saved_game(const char *filename, int offset)
         log_info("Savegame version", 0, save_version);
         resource_set_mapping(resource_version);
         init_savegame_data(save_version);
-        result = savegame_read_from_file(fp, save_version);
+        result = savegame_read_from_file(fp, save_version, 0);
     }
     file_close(fp);
     if (!result) {
@@ -1696,7 +1935,7 @@ int game_file_io_read_saved_game_info(const char *filename, int offset, saved_ga
     }
     resource_set_mapping(resource_version);
     init_savegame_data(save_version);
-    result = savegame_read_from_file(fp, save_version);
+    result = savegame_read_from_file(fp, save_version, 1);
     file_close(fp);
     if (result != SAVEGAME_STATUS_OK) {
         return FILE_LOAD_WRONG_FILE_FORMAT;
@@ -1731,8 +1970,124 @@ int game_file_io_read_saved_game_info_from_buffer(buffer *buf, saved_game_info *
     return savegame_read_file_info(info, save_version);
 }
 
+static int run_background_save(void *data)
+{
+    // Runs on the background thread: only touches the job data
+    background_save_job *job = data;
+    write_savegame_pieces(job->pieces, job->num_pieces, job->files, job->num_files);
+    int result = 1;
+    for (int i = 0; i < job->num_files; i++) {
+        if (fflush(job->files[i]) != 0 || ferror(job->files[i])) {
+            result = 0;
+        }
+    }
+    return result;
+}
+
+static void write_background_save_directly(background_save_job *job, const char *filename)
+{
+    FILE *fp = file_open(filename, "wb");
+    if (!fp) {
+        log_error("Unable to save game", filename, 0);
+        return;
+    }
+    write_savegame_pieces(job->pieces, job->num_pieces, &fp, 1);
+    file_close(fp);
+}
+
+static void complete_background_save(void)
+{
+    background_save_job *job = &background_save.job;
+    int result = job->result;
+    if (background_save.thread) {
+        result = thread_wait(background_save.thread);
+        background_save.thread = 0;
+    }
+    for (int i = 0; i < job->num_files; i++) {
+        file_close(job->files[i]);
+        if (!result) {
+            log_error("Unable to save game", job->filenames[i], 0);
+        } else if (!file_rename(job->temp_filenames[i], job->filenames[i])) {
+            // Some platforms can't rename files: write the file in place from now on
+            background_save.rename_failed = 1;
+            write_background_save_directly(job, job->filenames[i]);
+        }
+        file_remove(job->temp_filenames[i]);
+    }
+    for (int i = 0; i < job->num_pieces; i++) {
+        free(job->pieces[i].buf.data);
+    }
+    job->num_pieces = 0;
+    job->num_files = 0;
+    background_save.in_progress = 0;
+}
+
+void game_file_io_finish_background_save(int wait)
+{
+    if (!background_save.in_progress) {
+        return;
+    }
+    if (!wait && background_save.thread && !thread_is_finished(background_save.thread)) {
+        return;
+    }
+    complete_background_save();
+}
+
+int game_file_io_write_saved_game_in_background(const char **filenames, int num_files)
+{
+    game_file_io_finish_background_save(1);
+    if (background_save.rename_failed) {
+        int result = 1;
+        for (int i = 0; i < num_files; i++) {
+            result &= game_file_io_write_saved_game(filenames[i]);
+        }
+        return result;
+    }
+    if (num_files > MAX_BACKGROUND_SAVE_FILES) {
+        num_files = MAX_BACKGROUND_SAVE_FILES;
+    }
+    background_save_job *job = &background_save.job;
+    job->num_files = 0;
+    for (int i = 0; i < num_files; i++) {
+        log_info("Saving game", filenames[i], 0);
+        snprintf(job->filenames[job->num_files], FILE_NAME_MAX, "%s", filenames[i]);
+        if (snprintf(job->temp_filenames[job->num_files], FILE_NAME_MAX, "%s.tmp", filenames[i]) >= FILE_NAME_MAX) {
+            log_error("Unable to save game", filenames[i], 0);
+            continue;
+        }
+        job->files[job->num_files] = file_open(job->temp_filenames[job->num_files], "wb");
+        if (!job->files[job->num_files]) {
+            log_error("Unable to save game", filenames[i], 0);
+            continue;
+        }
+        job->num_files++;
+    }
+    if (!job->num_files) {
+        return 0;
+    }
+
+    resource_set_mapping(RESOURCE_CURRENT_VERSION);
+    init_savegame_data(SAVE_GAME_CURRENT_VERSION);
+    savegame_save_to_state(&savegame_data.state);
+
+    // Take over the saved pieces: they are freed once the background save completes
+    memcpy(job->pieces, savegame_data.pieces, sizeof(file_piece) * savegame_data.num_pieces);
+    job->num_pieces = savegame_data.num_pieces;
+    savegame_data.num_pieces = 0;
+
+    background_save.in_progress = 1;
+    background_save.thread = thread_create("background save", run_background_save, job);
+    if (!background_save.thread) {
+        log_info("Unable to start the background save thread, saving now", 0, 0);
+        job->result = run_background_save(job);
+        complete_background_save();
+    }
+    return 1;
+}
+
 int game_file_io_write_saved_game(const char *filename)
 {
+    game_file_io_finish_background_save(1);
     resource_set_mapping(RESOURCE_CURRENT_VERSION);
     init_savegame_data(SAVE_GAME_CURRENT_VERSION);
 
@@ -1744,17 +2099,47 @@ int game_file_io_write_saved_game(const char *filename)
         log_error("Unable to save game", 0, 0);
         return 0;
     }
-    memory_block compress_buffer;
-    core_memory_block_init(&compress_buffer, COMPRESS_BUFFER_INITIAL_SIZE);
-    savegame_write_to_file(fp, &compress_buffer);
-    core_memory_block_free(&compress_buffer);
+    savegame_write_to_file(fp);
     clear_savegame_pieces();
     file_close(fp);
     return 1;
 }
 
+static int is_unsimulated_piece(const buffer *buf)
+{
+    // The camera, bookmarks and message read flags change without affecting the simulation.
+    // The routing counters are only statistics, which loading a game already increases.
+    const savegame_state *state = &savegame_data.state;
+    return buf == state->city_view_camera || buf == state->bookmarks || buf == state->messages ||
+        buf == state->routing_counters;
+}
+
+uint32_t game_file_io_hash_game_state(void)
+{
+    game_file_io_finish_background_save(1);
+    resource_set_mapping(RESOURCE_CURRENT_VERSION);
+    init_savegame_data(SAVE_GAME_CURRENT_VERSION);
+    savegame_save_to_state(&savegame_data.state);
+
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < savegame_data.num_pieces; i++) {
+        const buffer *buf = &savegame_data.pieces[i].buf;
+        if (is_unsimulated_piece(buf)) {
+            continue;
+        }
+        for (size_t j = 0; j < buf->size; j++) {
+            hash ^= buf->data[j];
+            hash *= 16777619u;
+        }
+    }
+    clear_savegame_pieces();
+    return hash;
+}
+
 int game_file_io_delete_saved_game(const char *filename)
 {
+    game_file_io_finish_background_save(1);
     log_info("Deleting game", filename, 0);
     int result = file_remove(filename);
     if (!result) {
@@ -53,6 +53,12 @@ int game_file_io_read_saved_game_info_from_buffer(buffer *buf, saved_game_info *
 
 int game_file_io_write_saved_game(const char *filename);
 
+int game_file_io_write_saved_game_in_background(const char **filenames, int num_files);
+
+void game_file_io_finish_background_save(int wait);
+
 int game_file_io_delete_saved_game(const char *filename);
 
+uint32_t game_file_io_hash_game_state(void);
+
 #endif // GAME_FILE_IO_H
@@ -18,12 +18,15 @@
 #include "game/campaign.h"
 #include "game/file.h"
 #include "game/file_editor.h"
+#include "game/journal.h"
 #include "game/settings.h"
 #include "game/speed.h"
 #include "game/state.h"
 #include "game/tick.h"
+#include "game/tick_profiler.h"
 #include "graphics/font.h"
 #include "graphics/graphics.h"
+#include "graphics/screenshot.h"
 #include "graphics/text.h"
 #include "graphics/video.h"
 #include "graphics/window.h"
@@ -39,6 +42,8 @@
 #include "window/logo.h"
 #include "window/main_menu.h"
 
+#include <stdio.h>
+
 static void errlog(const char *msg)
 {
     log_error(msg, 0, 0);
@@ -140,6 +145,32 @@ int game_init(void)
     return 1;
 }
 
+int game_init_headless(void)
+{
+    if (!image_load_climate(CLIMATE_CENTRAL, 0, 1, 0)) {
+        errlog("unable to load main graphics");
+        return 0;
+    }
+    if (!image_load_enemy(ENEMY_0_BARBARIAN)) {
+        errlog("unable to load enemy graphics");
+        return 0;
+    }
+    if (!model_load()) {
+        errlog("unable to load c3_model.txt");
+        return 0;
+    }
+
+    building_properties_init();
+    load_augustus_messages();
+    game_state_init();
+    resource_init();
+
+    // Nothing is drawn, but the game asks which window is open, for example to queue popup messages
+    window_type window = { WINDOW_LOGO };
+    window_show(&window);
+    return 1;
+}
+
 static int reload_language(int is_editor, int reload_images)
 {
     if (!lang_load(is_editor)) {
@@ -171,6 +202,7 @@ static int reload_language(int is_editor, int reload_images)
 
 int game_init_editor(void)
 {
+    game_journal_game_unloading();
     if (!reload_language(1, 0)) {
         return 0;
     }
@@ -204,6 +236,8 @@ int game_reload_language(void)
 void game_run(void)
 {
     game_animation_update();
+    game_file_finish_background_save(0);
+    graphics_finish_screenshot(0);
     int num_ticks = game_speed_get_elapsed_ticks();
     for (int i = 0; i < num_ticks; i++) {
         game_tick_run();
@@ -221,7 +255,7 @@ void game_draw(void)
     sound_city_play();
 }
 
-void game_display_fps(int fps)
+void game_display_fps(int fps, int draw_calls, int batches, int sprites)
 {
     int x_offset = 8;
     int y_offset = 24;
@@ -230,10 +264,24 @@ void game_display_fps(int fps)
     graphics_draw_rect(x_offset, y_offset, width + 2, height + 2, COLOR_BLACK);
     graphics_fill_rect(x_offset + 1, y_offset + 1, width, height, COLOR_WHITE);
     text_draw_number_centered_colored(fps, x_offset, y_offset + 6, width, FONT_SMALL_PLAIN, COLOR_BLACK);
+
+    // Renderer counters of the last frame, to check how well sprites are batched
+    char stats[64];
+    snprintf(stats, sizeof(stats), "%d draw calls, %d batches, %d sprites", draw_calls, batches, sprites);
+    int stats_x = x_offset + width + 8;
+    int stats_width = 220;
+    graphics_draw_rect(stats_x, y_offset, stats_width + 2, height + 2, COLOR_BLACK);
+    graphics_fill_rect(stats_x + 1, y_offset + 1, stats_width, height, COLOR_WHITE);
+    text_draw(string_from_ascii(stats), stats_x + 4, y_offset + 6, FONT_SMALL_PLAIN, COLOR_BLACK);
+
+    tick_profiler_draw(x_offset, y_offset + height + 8);
 }
 
 void game_exit(void)
 {
+    game_journal_game_unloading();
+    game_file_finish_background_save(1);
+    graphics_finish_screenshot(1);
     video_shutdown();
     settings_save();
     config_save();
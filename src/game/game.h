@@ -5,6 +5,13 @@ int game_pre_init(void);
 
 int game_init(void);
 
+/**
+ * Initializes only what the simulation needs: image metadata, building models and game state.
+ * No sound, fonts or windows are set up, so the game can run without a display.
+ * @return Boolean true on success, false on failure
+ */
+int game_init_headless(void);
+
 int game_init_editor(void);
 
 int game_reload_language(void);
@@ -13,7 +20,14 @@ void game_run(void);
 
 void game_draw(void);
 
-void game_display_fps(int fps);
+/**
+ * Draws the frame rate counter along with the renderer counters of the last frame
+ * @param fps The frames per second
+ * @param draw_calls The number of draw calls the renderer made in the last frame
+ * @param batches The number of sprite batches drawn in the last frame
+ * @param sprites The number of sprites drawn in the last frame
+ */
+void game_display_fps(int fps, int draw_calls, int batches, int sprites);
 
 void game_exit_editor(void);
 
@@ -0,0 +1,563 @@
+#include "journal.h"
+
+#include "building/barracks.h"
+#include "building/building.h"
+#include "building/construction.h"
+#include "building/distribution.h"
+#include "building/dock.h"
+#include "building/menu.h"
+#include "building/monument.h"
+#include "building/roadblock.h"
+#include "building/rotation.h"
+#include "building/storage.h"
+#include "city/emperor.h"
+#include "city/festival.h"
+#include "city/finance.h"
+#include "city/games.h"
+#include "city/labor.h"
+#include "city/military.h"
+#include "city/ratings.h"
+#include "city/resource.h"
+#include "city/trade_policy.h"
+#include "core/config.h"
+#include "core/file.h"
+#include "core/log.h"
+#include "empire/city.h"
+#include "figure/formation.h"
+#include "figure/formation_legion.h"
+#include "game/file.h"
+#include "game/file_io.h"
+#include "game/orientation.h"
+#include "game/settings.h"
+#include "game/tick.h"
+#include "game/time.h"
+#include "game/undo.h"
+#include "map/grid.h"
+#include "map/point.h"
+#include "scenario/request.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define JOURNAL_VERSION 2
+#define MAX_PARAMS 8
+#define MAX_LINE 256
+#define CHECKPOINT_INTERVAL_TICKS (GAME_TIME_TICKS_PER_DAY * GAME_TIME_DAYS_PER_MONTH)
+
+static const struct {
+    const char *name;
+    int num_params;
+} COMMANDS[JOURNAL_MAX_COMMANDS] = {
+    { "construction", 8 }, // type, x_start, y_start, x_end, y_end, rotation, extra_rotation, road_orientation
+    { "undo", 0 },
+    { "rotate_left", 0 },
+    { "rotate_right", 0 },
+    { "rotate_north", 0 },
+    { "labor_priority", 2 }, // category, priority
+    { "wages", 1 }, // change
+    { "tax", 1 }, // change
+    { "trade_status", 2 }, // resource, status
+    { "import_over", 2 }, // resource, change
+    { "export_over", 2 }, // resource, change
+    { "stockpile", 1 }, // resource
+    { "mothball", 1 }, // resource
+    { "legion_move", 3 }, // formation_id, x, y
+    { "legion_return_home", 1 }, // formation_id
+    { "legion_layout", 2 }, // formation_id, layout
+    { "empire_service", 1 }, // formation_id
+    { "clear_empire_service", 0 },
+    { "distant_battle", 0 },
+    { "barracks_priority", 2 }, // building_id, priority
+    { "barracks_delivery", 1 }, // building_id
+    { "storage_state", 2 }, // storage_id, resource
+    { "storage_partial_state", 2 }, // storage_id, resource
+    { "storage_accept_all", 1 }, // storage_id
+    { "storage_accept_none", 1 }, // storage_id
+    { "storage_empty_all", 1 }, // storage_id
+    { "storage_permission", 2 }, // building_id, permission
+    { "distribution_good", 2 }, // building_id, resource
+    { "distribution_accept_all", 1 }, // building_id
+    { "distribution_accept_none", 1 }, // building_id
+    { "building_stockpile", 1 }, // building_id
+    { "building_mothball", 1 }, // building_id
+    { "dock_route", 3 }, // route_id, building_id, can_trade
+    { "roadblock_permission", 2 }, // building_id, permission
+    { "roadblock_accept_all", 1 }, // building_id
+    { "roadblock_accept_none", 1 }, // building_id
+    { "monument_halt", 1 }, // building_id
+    { "monument_module", 2 }, // building_id, module
+    { "trade_policy", 2 }, // type, policy
+    { "open_trade", 1 }, // city_id
+    { "request_dispatch", 1 }, // request_id
+    { "festival", 2 }, // god, size
+    { "games", 1 }, // game_id
+    { "gift", 1 }, // size
+    { "salary", 1 }, // rank
+    { "donation", 1 } // amount
+};
+
+static struct {
+    int is_recording;
+    int session_pending;
+    int is_replaying;
+    char filename[FILE_NAME_MAX];
+    char save_filename[FILE_NAME_MAX];
+    FILE *fp;
+    int ticks;
+} data;
+
+void game_journal_start_recording(const char *filename)
+{
+    snprintf(data.filename, FILE_NAME_MAX, "%s", filename);
+    snprintf(data.save_filename, FILE_NAME_MAX, "%s.svx", filename);
+    data.is_recording = 1;
+}
+
+static void write_hash(const char *keyword)
+{
+    fprintf(data.fp, "%d %s %08x\n", data.ticks, keyword, (unsigned int) game_file_io_hash_game_state());
+    fflush(data.fp);
+}
+
+static void start_session(void)
+{
+    data.session_pending = 0;
+    if (!game_file_write_saved_game(data.save_filename)) {
+        log_error("Unable to save the start of the journal", data.save_filename, 0);
+        return;
+    }
+    data.fp = file_open(data.filename, "w");
+    if (!data.fp) {
+        log_error("Unable to write journal", data.filename, 0);
+        return;
+    }
+    log_info("Recording journal", data.filename, 0);
+    data.ticks = 0;
+    fprintf(data.fp, "journal %d\n", JOURNAL_VERSION);
+    fprintf(data.fp, "save %s\n", data.save_filename);
+    fprintf(data.fp, "difficulty %d\n", (int) setting_difficulty());
+    fprintf(data.fp, "gods %d\n", setting_gods_enabled());
+    for (int i = 0; i < CONFIG_MAX_ENTRIES; i++) {
+        fprintf(data.fp, "config %d %d\n", i, config_get(i));
+    }
+    fflush(data.fp);
+}
+
+static int ensure_session(void)
+{
+    if (data.session_pending) {
+        start_session();
+    }
+    return data.fp != 0;
+}
+
+void game_journal_game_unloading(void)
+{
+    data.session_pending = 0;
+    if (data.is_replaying || !data.fp) {
+        return;
+    }
+    write_hash("end");
+    file_close(data.fp);
+    data.fp = 0;
+}
+
+void game_journal_game_loaded(void)
+{
+    if (data.is_recording && !data.is_replaying) {
+        data.session_pending = 1;
+    }
+}
+
+void game_journal_before_tick(void)
+{
+    ensure_session();
+}
+
+void game_journal_after_tick(void)
+{
+    // While replaying, the replay itself counts the ticks
+    if (data.is_replaying || !data.fp) {
+        return;
+    }
+    data.ticks++;
+    if (data.ticks % CHECKPOINT_INTERVAL_TICKS == 0) {
+        write_hash("hash");
+    }
+}
+
+static void write_command(journal_command command, const int *params)
+{
+    fprintf(data.fp, "%d %s", data.ticks, COMMANDS[command].name);
+    for (int i = 0; i < COMMANDS[command].num_params; i++) {
+        fprintf(data.fp, " %d", params[i]);
+    }
+    fprintf(data.fp, "\n");
+    fflush(data.fp);
+}
+
+void game_journal_record(journal_command command, ...)
+{
+    if (data.is_replaying || !ensure_session()) {
+        return;
+    }
+    int params[MAX_PARAMS];
+    va_list args;
+    va_start(args, command);
+    for (int i = 0; i < COMMANDS[command].num_params; i++) {
+        params[i] = va_arg(args, int);
+    }
+    va_end(args);
+    write_command(command, params);
+}
+
+void game_journal_record_construction(int x_start, int y_start, int x_end, int y_end)
+{
+    if (data.is_replaying || !ensure_session()) {
+        return;
+    }
+    int params[MAX_PARAMS] = { building_construction_type(), x_start, y_start, x_end, y_end };
+    building_rotation_get_state(&params[5], &params[6], &params[7]);
+    write_command(JOURNAL_CONSTRUCTION, params);
+}
+
+void game_journal_record_unsupported(const char *action)
+{
+    if (data.is_replaying || !ensure_session()) {
+        return;
+    }
+    fprintf(data.fp, "%d unsupported %s\n", data.ticks, action);
+    fflush(data.fp);
+}
+
+static void replay_construction(const int *params)
+{
+    building_construction_set_type(params[0]);
+    building_rotation_set_state(params[5], params[6], params[7]);
+    building_construction_start(params[1], params[2], map_grid_offset(params[1], params[2]));
+    building_construction_update(params[3], params[4], map_grid_offset(params[3], params[4]));
+    building_construction_place();
+    building_construction_clear_type();
+}
+
+static void replay_command(journal_command command, const int *params)
+{
+    switch (command) {
+        case JOURNAL_CONSTRUCTION:
+            replay_construction(params);
+            break;
+        case JOURNAL_UNDO:
+            game_undo_perform();
+            break;
+        case JOURNAL_ROTATE_LEFT:
+            game_orientation_rotate_left();
+            break;
+        case JOURNAL_ROTATE_RIGHT:
+            game_orientation_rotate_right();
+            break;
+        case JOURNAL_ROTATE_NORTH:
+            game_orientation_rotate_north();
+            break;
+        case JOURNAL_LABOR_PRIORITY:
+            city_labor_set_priority(params[0], params[1]);
+            break;
+        case JOURNAL_WAGES:
+            city_labor_change_wages(params[0]);
+            break;
+        case JOURNAL_TAX:
+            city_finance_change_tax_percentage(params[0]);
+            break;
+        case JOURNAL_TRADE_STATUS:
+            city_resource_cycle_trade_status(params[0], params[1]);
+            break;
+        case JOURNAL_IMPORT_OVER:
+            city_resource_change_import_over(params[0], params[1]);
+            break;
+        case JOURNAL_EXPORT_OVER:
+            city_resource_change_export_over(params[0], params[1]);
+            break;
+        case JOURNAL_STOCKPILE:
+            city_resource_toggle_stockpiled(params[0]);
+            break;
+        case JOURNAL_MOTHBALL:
+            city_resource_toggle_mothballed(params[0]);
+            break;
+        case JOURNAL_LEGION_MOVE: {
+            map_tile tile = { params[1], params[2], map_grid_offset(params[1], params[2]) };
+            formation_legion_move_to(formation_get(params[0]), &tile);
+            break;
+        }
+        case JOURNAL_LEGION_RETURN_HOME:
+            formation_legion_return_home(formation_get(params[0]));
+            break;
+        case JOURNAL_LEGION_LAYOUT:
+            formation_legion_change_layout(formation_get(params[0]), params[1]);
+            break;
+        case JOURNAL_EMPIRE_SERVICE:
+            formation_toggle_empire_service(params[0]);
+            formation_calculate_figures();
+            break;
+        case JOURNAL_CLEAR_EMPIRE_SERVICE:
+            city_military_clear_empire_service_legions();
+            break;
+        case JOURNAL_DISTANT_BATTLE:
+            formation_legions_dispatch_to_distant_battle();
+            break;
+        case JOURNAL_BARRACKS_PRIORITY:
+            building_barracks_set_priority(building_get(params[0]), params[1]);
+            break;
+        case JOURNAL_BARRACKS_DELIVERY:
+            building_barracks_toggle_delivery(building_get(params[0]));
+            break;
+        case JOURNAL_STORAGE_STATE:
+            building_storage_cycle_resource_state(params[0], params[1]);
+            break;
+        case JOURNAL_STORAGE_PARTIAL_STATE:
+            building_storage_cycle_partial_resource_state(params[0], params[1]);
+            break;
+        case JOURNAL_STORAGE_ACCEPT_ALL:
+            building_storage_accept_all(params[0]);
+            break;
+        case JOURNAL_STORAGE_ACCEPT_NONE:
+            building_storage_accept_none(params[0]);
+            break;
+        case JOURNAL_STORAGE_EMPTY_ALL:
+            building_storage_toggle_empty_all(params[0]);
+            break;
+        case JOURNAL_STORAGE_PERMISSION:
+            building_storage_set_permission(params[1], building_get(params[0]));
+            break;
+        case JOURNAL_DISTRIBUTION_GOOD:
+            building_distribution_toggle_good_accepted(params[1], building_get(params[0]));
+            break;
+        case JOURNAL_DISTRIBUTION_ACCEPT_ALL:
+            building_distribution_accept_all_goods(building_get(params[0]));
+            break;
+        case JOURNAL_DISTRIBUTION_ACCEPT_NONE:
+            building_distribution_unaccept_all_goods(building_get(params[0]));
+            break;
+        case JOURNAL_BUILDING_STOCKPILE:
+            building_stockpiling_toggle(building_get(params[0]));
+            break;
+        case JOURNAL_BUILDING_MOTHBALL:
+            building_mothball_toggle(building_get(params[0]));
+            break;
+        case JOURNAL_DOCK_ROUTE:
+            building_dock_set_can_trade_with_route(params[0], params[1], params[2]);
+            break;
+        case JOURNAL_ROADBLOCK_PERMISSION:
+            building_roadblock_set_permission(params[1], building_get(params[0]));
+            break;
+        case JOURNAL_ROADBLOCK_ACCEPT_ALL:
+            building_roadblock_accept_all(building_get(params[0]));
+            break;
+        case JOURNAL_ROADBLOCK_ACCEPT_NONE:
+            building_roadblock_accept_none(building_get(params[0]));
+            break;
+        case JOURNAL_MONUMENT_HALT:
+            building_monument_toggle_construction_halted(building_get(params[0]));
+            break;
+        case JOURNAL_MONUMENT_MODULE:
+            city_finance_process_construction(MONUMENT_MODULE_COST);
+            building_monument_add_module(building_get(params[0]), params[1]);
+            break;
+        case JOURNAL_TRADE_POLICY:
+            city_trade_policy_set(params[0], params[1]);
+            city_finance_process_sundry(TRADE_POLICY_COST);
+            break;
+        case JOURNAL_OPEN_TRADE:
+            empire_city_open_trade(params[0], 1);
+            building_menu_update();
+            break;
+        case JOURNAL_REQUEST_DISPATCH:
+            scenario_request_dispatch(params[0]);
+            break;
+        case JOURNAL_FESTIVAL:
+            city_festival_select_god(params[0]);
+            city_festival_select_size(params[1]);
+            city_festival_schedule();
+            break;
+        case JOURNAL_GAMES:
+            city_games_schedule(params[0]);
+            break;
+        case JOURNAL_GIFT:
+            city_emperor_set_gift_size(params[0]);
+            city_emperor_send_gift();
+            break;
+        case JOURNAL_SALARY:
+            city_emperor_set_salary_rank(params[0]);
+            city_finance_update_salary();
+            city_ratings_update_favor_explanation();
+            break;
+        case JOURNAL_DONATION:
+            city_emperor_set_donation_amount(params[0]);
+            city_emperor_donate_savings_to_city();
+            break;
+        default:
+            break;
+    }
+}
+
+static void restore_difficulty(int difficulty)
+{
+    int previous = -1;
+    while ((int) setting_difficulty() != difficulty && (int) setting_difficulty() != previous) {
+        previous = setting_difficulty();
+        if ((int) setting_difficulty() < difficulty) {
+            setting_increase_difficulty();
+        } else {
+            setting_decrease_difficulty();
+        }
+    }
+}
+
+static void close_replay(void)
+{
+    if (data.fp) {
+        file_close(data.fp);
+        data.fp = 0;
+    }
+    data.is_replaying = 0;
+}
+
+int game_journal_load_replay(const char *filename)
+{
+    game_journal_game_unloading();
+    data.fp = file_open(filename, "r");
+    if (!data.fp) {
+        log_error("Unable to open journal", filename, 0);
+        return 0;
+    }
+    data.is_replaying = 1;
+    char line[MAX_LINE];
+    int version;
+    if (!fgets(line, MAX_LINE, data.fp) || sscanf(line, "journal %d", &version) != 1 || version != JOURNAL_VERSION) {
+        log_error("Unsupported journal", filename, 0);
+        close_replay();
+        return 0;
+    }
+    long header_end = ftell(data.fp);
+    while (fgets(line, MAX_LINE, data.fp)) {
+        int key, value;
+        if (strncmp(line, "save ", 5) == 0) {
+            line[strcspn(line, "\r\n")] = 0;
+            if (game_file_load_saved_game(line + 5) != FILE_LOAD_SUCCESS) {
+                log_error("Unable to load the start of the journal", line + 5, 0);
+                close_replay();
+                return 0;
+            }
+        } else if (sscanf(line, "difficulty %d", &value) == 1) {
+            restore_difficulty(value);
+        } else if (sscanf(line, "gods %d", &value) == 1) {
+            if (setting_gods_enabled() != value) {
+                setting_toggle_gods_enabled();
+            }
+        } else if (sscanf(line, "config %d %d", &key, &value) == 2) {
+            if (key >= 0 && key < CONFIG_MAX_ENTRIES) {
+                config_set(key, value);
+            }
+        } else {
+            break;
+        }
+        header_end = ftell(data.fp);
+    }
+    fseek(data.fp, header_end, SEEK_SET);
+    data.ticks = 0;
+    return 1;
+}
+
+static int find_command(const char *name)
+{
+    for (int i = 0; i < JOURNAL_MAX_COMMANDS; i++) {
+        if (strcmp(COMMANDS[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int parse_params(const char *str, int num_params, int *params)
+{
+    for (int i = 0; i < num_params; i++) {
+        char *end;
+        params[i] = (int) strtol(str, &end, 10);
+        if (end == str) {
+            return 0;
+        }
+        str = end;
+    }
+    return 1;
+}
+
+static void count_unsupported(const char *str, int tick, journal_replay_result *result)
+{
+    if (!result->unsupported) {
+        result->first_unsupported_tick = tick;
+    }
+    result->unsupported++;
+    char action[32];
+    if (sscanf(str, "%31s", action) != 1) {
+        action[0] = 0;
+    }
+    log_error("Journal has an action that cannot be replayed at tick", action, tick);
+}
+
+static void check_hash(const char *str, int tick, journal_replay_result *result)
+{
+    unsigned int expected = (unsigned int) strtoul(str, 0, 16);
+    unsigned int actual = (unsigned int) game_file_io_hash_game_state();
+    result->checkpoints++;
+    if (actual != expected) {
+        if (!result->mismatches) {
+            result->first_mismatch_tick = tick;
+        }
+        result->mismatches++;
+        log_error("Journal replay diverged at tick", 0, tick);
+    }
+}
+
+int game_journal_run_replay(journal_replay_result *result)
+{
+    memset(result, 0, sizeof(journal_replay_result));
+    if (!data.is_replaying) {
+        return 0;
+    }
+    int ok = 1;
+    char line[MAX_LINE];
+    while (fgets(line, MAX_LINE, data.fp)) {
+        int tick;
+        char keyword[32];
+        int length;
+        if (sscanf(line, "%d %31s%n", &tick, keyword, &length) != 2 || tick < data.ticks) {
+            log_error("Invalid journal line at tick", 0, data.ticks);
+            ok = 0;
+            break;
+        }
+        while (data.ticks < tick) {
+            game_tick_run();
+            data.ticks++;
+        }
+        if (strcmp(keyword, "hash") == 0 || strcmp(keyword, "end") == 0) {
+            check_hash(line + length, tick, result);
+            continue;
+        }
+        if (strcmp(keyword, "unsupported") == 0) {
+            count_unsupported(line + length, tick, result);
+            continue;
+        }
+        int command = find_command(keyword);
+        int params[MAX_PARAMS];
+        if (command < 0 || !parse_params(line + length, COMMANDS[command].num_params, params)) {
+            log_error("Invalid journal line at tick", 0, tick);
+            ok = 0;
+            break;
+        }
+        replay_command(command, params);
+        result->commands++;
+    }
+    result->ticks = data.ticks;
+    close_replay();
+    return ok;
+}
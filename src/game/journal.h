@@ -0,0 +1,142 @@
+#ifndef GAME_JOURNAL_H
+#define GAME_JOURNAL_H
+
+/**
+ * @file
+ * Journal of the player actions that change the game state, recorded with the tick at which
+ * they happened so a game session can be replayed without a window.
+ *
+ * A session starts at the first tick or action after a game is loaded. Its starting state is saved
+ * next to the journal, with ".svx" appended to the journal file name. Every game month and when the
+ * session ends, a hash of the game state is recorded, which the replay checks against.
+ *
+ * Actions that change the game state but cannot be replayed are recorded by name only,
+ * so that a replay of such a journal is flagged as inexact instead of silently diverging.
+ */
+
+typedef enum {
+    JOURNAL_CONSTRUCTION = 0,
+    JOURNAL_UNDO,
+    JOURNAL_ROTATE_LEFT,
+    JOURNAL_ROTATE_RIGHT,
+    JOURNAL_ROTATE_NORTH,
+    JOURNAL_LABOR_PRIORITY,
+    JOURNAL_WAGES,
+    JOURNAL_TAX,
+    JOURNAL_TRADE_STATUS,
+    JOURNAL_IMPORT_OVER,
+    JOURNAL_EXPORT_OVER,
+    JOURNAL_STOCKPILE,
+    JOURNAL_MOTHBALL,
+    JOURNAL_LEGION_MOVE,
+    JOURNAL_LEGION_RETURN_HOME,
+    JOURNAL_LEGION_LAYOUT,
+    JOURNAL_EMPIRE_SERVICE,
+    JOURNAL_CLEAR_EMPIRE_SERVICE,
+    JOURNAL_DISTANT_BATTLE,
+    JOURNAL_BARRACKS_PRIORITY,
+    JOURNAL_BARRACKS_DELIVERY,
+    JOURNAL_STORAGE_STATE,
+    JOURNAL_STORAGE_PARTIAL_STATE,
+    JOURNAL_STORAGE_ACCEPT_ALL,
+    JOURNAL_STORAGE_ACCEPT_NONE,
+    JOURNAL_STORAGE_EMPTY_ALL,
+    JOURNAL_STORAGE_PERMISSION,
+    JOURNAL_DISTRIBUTION_GOOD,
+    JOURNAL_DISTRIBUTION_ACCEPT_ALL,
+    JOURNAL_DISTRIBUTION_ACCEPT_NONE,
+    JOURNAL_BUILDING_STOCKPILE,
+    JOURNAL_BUILDING_MOTHBALL,
+    JOURNAL_DOCK_ROUTE,
+    JOURNAL_ROADBLOCK_PERMISSION,
+    JOURNAL_ROADBLOCK_ACCEPT_ALL,
+    JOURNAL_ROADBLOCK_ACCEPT_NONE,
+    JOURNAL_MONUMENT_HALT,
+    JOURNAL_MONUMENT_MODULE,
+    JOURNAL_TRADE_POLICY,
+    JOURNAL_OPEN_TRADE,
+    JOURNAL_REQUEST_DISPATCH,
+    JOURNAL_FESTIVAL,
+    JOURNAL_GAMES,
+    JOURNAL_GIFT,
+    JOURNAL_SALARY,
+    JOURNAL_DONATION,
+    JOURNAL_MAX_COMMANDS
+} journal_command;
+
+typedef struct {
+    int ticks;
+    int commands;
+    int checkpoints;
+    int mismatches;
+    int first_mismatch_tick;
+    int unsupported;
+    int first_unsupported_tick;
+} journal_replay_result;
+
+/**
+ * Records the sessions of the games loaded from now on to a journal file,
+ * each new game replacing the previous recording
+ * @param filename The journal file
+ */
+void game_journal_start_recording(const char *filename);
+
+/**
+ * Ends the recorded session, if any. Must be called before the game state is replaced.
+ */
+void game_journal_game_unloading(void);
+
+/**
+ * Starts a new session at the next tick or action, if recording
+ */
+void game_journal_game_loaded(void);
+
+/**
+ * Called at the start of every game tick
+ */
+void game_journal_before_tick(void);
+
+/**
+ * Called at the end of every game tick
+ */
+void game_journal_after_tick(void);
+
+/**
+ * Records a player action
+ * @param command The action
+ * @param ... The integer parameters of the action, the number of which depends on the action
+ */
+void game_journal_record(journal_command command, ...);
+
+/**
+ * Records the placement of the building currently under construction,
+ * along with the building rotation
+ * @param x_start The x coordinate of the tile where the construction started
+ * @param y_start The y coordinate of the tile where the construction started
+ * @param x_end The x coordinate of the tile where the construction ended
+ * @param y_end The y coordinate of the tile where the construction ended
+ */
+void game_journal_record_construction(int x_start, int y_start, int x_end, int y_end);
+
+/**
+ * Records a player action that changes the game state but that the journal cannot replay
+ * @param action A short name of the action
+ */
+void game_journal_record_unsupported(const char *action);
+
+/**
+ * Opens a journal for replay, loading its starting save and the settings it was recorded with
+ * @param filename The journal file
+ * @return Boolean true on success, false if the journal or its save could not be loaded
+ */
+int game_journal_load_replay(const char *filename);
+
+/**
+ * Runs the ticks and actions of the journal opened with game_journal_load_replay as fast as possible,
+ * comparing the game state with the recorded hashes and counting the actions that could not be replayed
+ * @param result The replay statistics
+ * @return Boolean true if the whole journal was replayed, false if it has invalid lines
+ */
+int game_journal_run_replay(journal_replay_result *result);
+
+#endif // GAME_JOURNAL_H
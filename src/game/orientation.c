@@ -3,6 +3,7 @@
 #include "city/view.h"
 #include "city/warning.h"
 #include "core/direction.h"
+#include "game/journal.h"
 #include "map/orientation.h"
 #include "widget/minimap.h"
 
@@ -10,6 +11,7 @@ static int warning_slot;
 
 void game_orientation_rotate_left(void)
 {
+    game_journal_record(JOURNAL_ROTATE_LEFT);
     city_view_rotate_left();
     map_orientation_change(0);
     widget_minimap_invalidate();
@@ -18,6 +20,7 @@ void game_orientation_rotate_left(void)
 
 void game_orientation_rotate_right(void)
 {
+    game_journal_record(JOURNAL_ROTATE_RIGHT);
     city_view_rotate_right();
     map_orientation_change(1);
     widget_minimap_invalidate();
@@ -26,6 +29,8 @@ void game_orientation_rotate_right(void)
 
 void game_orientation_rotate_north(void)
 {
+    // Recorded before rotating, like the other rotations; replaying it when already north does nothing
+    game_journal_record(JOURNAL_ROTATE_NORTH);
     switch (city_view_orientation()) {
         case DIR_2_RIGHT:
             city_view_rotate_right();
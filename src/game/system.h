@@ -33,6 +33,18 @@ const char *system_OS(void);
  */
 uint64_t system_get_ticks(void);
 
+/**
+ * Gets the value of the high resolution counter, for timing short sections of code
+ * @return The counter value, in units given by system_get_performance_frequency
+ */
+uint64_t system_get_performance_counter(void);
+
+/**
+ * Gets the number of high resolution counter units per second
+ * @return The counter frequency
+ */
+uint64_t system_get_performance_frequency(void);
+
 /**
  * Resize window
  * @param width New width
@@ -33,13 +33,16 @@
 #include "city/victory.h"
 #include "core/config.h"
 #include "core/dir.h"
+#include "core/file.h"
 #include "core/random.h"
 #include "editor/editor.h"
 #include "empire/city.h"
 #include "figure/formation.h"
 #include "figuretype/crime.h"
 #include "game/file.h"
+#include "game/journal.h"
 #include "game/settings.h"
+#include "game/tick_profiler.h"
 #include "game/time.h"
 #include "game/tutorial.h"
 #include "game/undo.h"
@@ -63,6 +66,8 @@
 #include "sound/music.h"
 #include "widget/minimap.h"
 
+#include <stdio.h>
+
 static void advance_year(void)
 {
     game_undo_disable();
@@ -75,6 +80,28 @@ static void advance_year(void)
     city_ratings_update(1,0);
 }
 
+static void autosave(int new_year)
+{
+    char filenames[2][FILE_NAME_MAX];
+    const char *files[2];
+    int num_files = 0;
+    if (setting_monthly_autosave()) {
+        snprintf(filenames[num_files], FILE_NAME_MAX, "%s",
+            dir_append_location("autosave.svx", PATH_LOCATION_SAVEGAME));
+        files[num_files] = filenames[num_files];
+        num_files++;
+    }
+    if (new_year && config_get(CONFIG_GP_CH_YEARLY_AUTOSAVE)) {
+        snprintf(filenames[num_files], FILE_NAME_MAX, "%s",
+            dir_append_location("autosave-year.svx", PATH_LOCATION_SAVEGAME));
+        files[num_files] = filenames[num_files];
+        num_files++;
+    }
+    if (num_files) {
+        game_file_write_saved_game_in_background(files, num_files);
+    }
+}
+
 static void advance_month(void)
 {
     int new_year = 0;
@@ -117,12 +144,7 @@ static void advance_month(void)
     tutorial_on_month_tick();
     scenario_events_progress_paused(1);
     scenario_events_process_all();
-    if (setting_monthly_autosave()) {
-        game_file_write_saved_game(dir_append_location("autosave.svx", PATH_LOCATION_SAVEGAME));
-    }
-    if (new_year && config_get(CONFIG_GP_CH_YEARLY_AUTOSAVE)) {
-        game_file_write_saved_game(dir_append_location("autosave-year.svx", PATH_LOCATION_SAVEGAME));
-    }
+    autosave(new_year);
 }
 
 static void advance_day(void)
@@ -145,68 +167,76 @@ static void advance_tick(void)
     // 0, 10, 11, 13, 14, 15, 18, 26, 41
     // max is 49
     switch (game_time_tick()) {
-        case 1: city_gods_calculate_moods(1); break;
-        case 2: sound_music_update(0); break;
-        case 3: widget_minimap_invalidate(); break;
-        case 4: city_emperor_update(); break;
-        case 5: formation_update_all(0); break;
-        case 6: map_natives_check_land(1); break;
-        case 7: map_road_network_update(); break;
-        case 8: building_granaries_calculate_stocks(); break;
-        case 9: city_buildings_update_plague(); break;
-        case 12: house_service_decay_houses_covered(); break;
-        case 16: city_resource_calculate_warehouse_stocks(); break;
-        case 17: city_resource_calculate_food_stocks_and_supply_wheat(); break;
-        case 19: building_dock_update_open_water_access(); break;
-        case 20: building_industry_update_production(1); break;
-        case 21: building_maintenance_check_rome_access(); break;
-        case 22: house_population_update_room(); break;
-        case 23: house_population_update_migration(); break;
-        case 24: house_population_evict_overcrowded(); break;
-        case 25: city_labor_update(); break;
-        case 27: map_water_supply_update_reservoir_fountain(); break;
-        case 28: map_water_supply_update_buildings(); break;
-        case 29: formation_update_all(1); break;
-        case 30: widget_minimap_invalidate(); break;
-        case 31: building_figure_generate(); break;
-        case 32: city_trade_update(); break;
-        case 33: building_entertainment_run_shows(); city_culture_update_coverage(); break;
-        case 34: building_government_distribute_treasury(); break;
-        case 35: house_service_decay_culture(); break;
-        case 36: house_service_calculate_culture_aggregates(); break;
-        case 37: map_desirability_update(); break;
-        case 38: building_update_desirability(); break;
-        case 39: building_house_process_evolve_and_consume_goods(); break;
-        case 40: building_update_state(); break;
-        case 42: city_finance_spawn_tourist(); break;
-        case 43: building_maintenance_update_burning_ruins(); break;
-        case 44: building_maintenance_check_fire_collapse(); break;
-        case 45: figure_generate_criminals(); break;
-        case 46: building_industry_update_production(0); break;
-        case 47: city_games_decrement_duration(); break;
-        case 48: house_service_decay_tax_collector(); break;
-        case 49: city_culture_calculate(); break;
+        case 1: TICK_PROFILE(city_gods_calculate_moods(1)); break;
+        case 2: TICK_PROFILE(sound_music_update(0)); break;
+        case 3: TICK_PROFILE(widget_minimap_invalidate()); break;
+        case 4: TICK_PROFILE(city_emperor_update()); break;
+        case 5: TICK_PROFILE(formation_update_all(0)); break;
+        case 6: TICK_PROFILE(map_natives_check_land(1)); break;
+        case 7: TICK_PROFILE(map_road_network_update()); break;
+        case 8: TICK_PROFILE(building_granaries_calculate_stocks()); break;
+        case 9: TICK_PROFILE(city_buildings_update_plague()); break;
+        case 12: TICK_PROFILE(house_service_decay_houses_covered()); break;
+        case 16: TICK_PROFILE(city_resource_calculate_warehouse_stocks()); break;
+        case 17: TICK_PROFILE(city_resource_calculate_food_stocks_and_supply_wheat()); break;
+        case 19: TICK_PROFILE(building_dock_update_open_water_access()); break;
+        case 20: TICK_PROFILE(building_industry_update_production(1)); break;
+        case 21: TICK_PROFILE(building_maintenance_check_rome_access()); break;
+        case 22: TICK_PROFILE(house_population_update_room()); break;
+        case 23: TICK_PROFILE(house_population_update_migration()); break;
+        case 24: TICK_PROFILE(house_population_evict_overcrowded()); break;
+        case 25: TICK_PROFILE(city_labor_update()); break;
+        case 27: TICK_PROFILE(map_water_supply_update_reservoir_fountain()); break;
+        case 28: TICK_PROFILE(map_water_supply_update_buildings()); break;
+        case 29: TICK_PROFILE(formation_update_all(1)); break;
+        case 30: TICK_PROFILE(widget_minimap_invalidate()); break;
+        case 31: TICK_PROFILE(building_figure_generate()); break;
+        case 32: TICK_PROFILE(city_trade_update()); break;
+        case 33:
+            TICK_PROFILE(building_entertainment_run_shows());
+            TICK_PROFILE(city_culture_update_coverage());
+            break;
+        case 34: TICK_PROFILE(building_government_distribute_treasury()); break;
+        case 35: TICK_PROFILE(house_service_decay_culture()); break;
+        case 36: TICK_PROFILE(house_service_calculate_culture_aggregates()); break;
+        case 37: TICK_PROFILE(map_desirability_update()); break;
+        case 38: TICK_PROFILE(building_update_desirability()); break;
+        case 39: TICK_PROFILE(building_house_process_evolve_and_consume_goods()); break;
+        case 40: TICK_PROFILE(building_update_state()); break;
+        case 42: TICK_PROFILE(city_finance_spawn_tourist()); break;
+        case 43: TICK_PROFILE(building_maintenance_update_burning_ruins()); break;
+        case 44: TICK_PROFILE(building_maintenance_check_fire_collapse()); break;
+        case 45: TICK_PROFILE(figure_generate_criminals()); break;
+        case 46: TICK_PROFILE(building_industry_update_production(0)); break;
+        case 47: TICK_PROFILE(city_games_decrement_duration()); break;
+        case 48: TICK_PROFILE(house_service_decay_tax_collector()); break;
+        case 49: TICK_PROFILE(city_culture_calculate()); break;
     }
     if (game_time_advance_tick()) {
-        advance_day();
+        TICK_PROFILE(advance_day());
     }
 }
 
 void game_tick_run(void)
 {
+    tick_profiler_begin_tick();
     if (editor_is_active()) {
         random_generate_next(); // update random to randomize native huts
         figure_action_handle(); // just update the flag figures
+        tick_profiler_end_tick();
         return;
     }
+    game_journal_before_tick();
     random_generate_next();
     game_undo_reduce_time_available();
     advance_tick();
     figure_action_handle();
-    scenario_earthquake_process();
-    scenario_gladiator_revolt_process();
-    scenario_emperor_change_process();
-    city_victory_check();
+    TICK_PROFILE(scenario_earthquake_process());
+    TICK_PROFILE(scenario_gladiator_revolt_process());
+    TICK_PROFILE(scenario_emperor_change_process());
+    TICK_PROFILE(city_victory_check());
+    game_journal_after_tick();
+    tick_profiler_end_tick();
 }
 
 void game_tick_cheat_year(void)
@@ -0,0 +1,242 @@
+#include "tick_profiler.h"
+
+#include "core/file.h"
+#include "core/log.h"
+#include "core/string.h"
+#include "game/system.h"
+#include "game/time.h"
+#include "graphics/color.h"
+#include "graphics/font.h"
+#include "graphics/graphics.h"
+#include "graphics/text.h"
+
+#include <stdio.h>
+
+#ifdef PROFILE_TICKS
+
+#define MAX_NAMED_SECTIONS 64
+#define MAX_SECTIONS (FIGURE_TYPE_MAX + MAX_NAMED_SECTIONS)
+#define SECTION_NAME_MAX 80
+
+#define OVERLAY_LINES 10
+#define OVERLAY_WIDTH 400
+#define OVERLAY_LINE_HEIGHT 14
+
+typedef struct {
+    const char *name;
+    uint64_t tick;
+    uint64_t day;
+    uint64_t last_day;
+} profile_section;
+
+// The first FIGURE_TYPE_MAX sections hold the figure actions, indexed by figure type
+static struct {
+    profile_section sections[MAX_SECTIONS];
+    int num_sections;
+    uint64_t tick_start;
+    struct {
+        uint64_t day;
+        uint64_t last_day;
+    } total;
+    int ticks_in_day;
+    int has_last_day;
+    struct {
+        int year;
+        int month;
+        int day;
+        int tick;
+    } date;
+    unsigned int tick_number;
+    FILE *csv;
+} data = { .num_sections = FIGURE_TYPE_MAX };
+
+static double counter_to_micros(uint64_t counter)
+{
+    return counter * 1000000.0 / system_get_performance_frequency();
+}
+
+static const char *section_name(int index)
+{
+    static char name[SECTION_NAME_MAX];
+    if (index >= FIGURE_TYPE_MAX) {
+        return data.sections[index].name;
+    }
+    // Labelled by the value of the figure type enum, so that new figure types need no changes here
+    snprintf(name, SECTION_NAME_MAX, "figure_%d", index);
+    return name;
+}
+
+static int find_section(const char *name)
+{
+    for (int i = FIGURE_TYPE_MAX; i < data.num_sections; i++) {
+        if (data.sections[i].name == name) {
+            return i;
+        }
+    }
+    if (data.num_sections >= MAX_SECTIONS) {
+        return -1;
+    }
+    data.sections[data.num_sections].name = name;
+    return data.num_sections++;
+}
+
+void tick_profiler_begin_tick(void)
+{
+    data.date.year = game_time_year();
+    data.date.month = game_time_month();
+    data.date.day = game_time_day();
+    data.date.tick = game_time_tick();
+    data.tick_start = system_get_performance_counter();
+}
+
+static void write_csv_row(const char *name, uint64_t counter)
+{
+    fprintf(data.csv, "%u,%d,%d,%d,%d,\"%s\",%.3f\n", data.tick_number, data.date.year, data.date.month,
+        data.date.day, data.date.tick, name, counter_to_micros(counter));
+}
+
+void tick_profiler_end_tick(void)
+{
+    uint64_t total = system_get_performance_counter() - data.tick_start;
+    for (int i = 0; i < data.num_sections; i++) {
+        profile_section *s = &data.sections[i];
+        if (!s->tick) {
+            continue;
+        }
+        if (data.csv) {
+            write_csv_row(section_name(i), s->tick);
+        }
+        s->day += s->tick;
+        s->tick = 0;
+    }
+    if (data.csv) {
+        write_csv_row("total", total);
+    }
+    data.total.day += total;
+    data.tick_number++;
+
+    if (++data.ticks_in_day >= GAME_TIME_TICKS_PER_DAY) {
+        for (int i = 0; i < data.num_sections; i++) {
+            data.sections[i].last_day = data.sections[i].day;
+            data.sections[i].day = 0;
+        }
+        data.total.last_day = data.total.day;
+        data.total.day = 0;
+        data.ticks_in_day = 0;
+        data.has_last_day = 1;
+    }
+}
+
+uint64_t tick_profiler_start(void)
+{
+    return system_get_performance_counter();
+}
+
+void tick_profiler_stop(const char *section, uint64_t start)
+{
+    int index = find_section(section);
+    if (index >= 0) {
+        data.sections[index].tick += system_get_performance_counter() - start;
+    }
+}
+
+void tick_profiler_stop_figure(figure_type type, uint64_t start)
+{
+    data.sections[type].tick += system_get_performance_counter() - start;
+}
+
+int tick_profiler_start_csv(const char *filename)
+{
+    tick_profiler_stop_csv();
+    data.csv = file_open(filename, "w");
+    if (!data.csv) {
+        log_error("Unable to open tick profile file", filename, 0);
+        return 0;
+    }
+    fprintf(data.csv, "tick,year,month,day,day_tick,section,microseconds\n");
+    return 1;
+}
+
+void tick_profiler_stop_csv(void)
+{
+    if (data.csv) {
+        file_close(data.csv);
+        data.csv = 0;
+    }
+}
+
+static void draw_line(const char *name, uint64_t counter, int x, int y)
+{
+    char line[SECTION_NAME_MAX + 16];
+    snprintf(line, sizeof(line), "%8.3f ms  %s", counter_to_micros(counter) / 1000, name);
+    text_draw(string_from_ascii(line), x, y, FONT_SMALL_PLAIN, COLOR_BLACK);
+}
+
+void tick_profiler_draw(int x, int y)
+{
+    if (!data.has_last_day) {
+        return;
+    }
+    int top[OVERLAY_LINES];
+    int num_top = 0;
+    for (int i = 0; i < data.num_sections; i++) {
+        uint64_t counter = data.sections[i].last_day;
+        if (!counter) {
+            continue;
+        }
+        int position = num_top;
+        while (position > 0 && data.sections[top[position - 1]].last_day < counter) {
+            position--;
+        }
+        if (position >= OVERLAY_LINES) {
+            continue;
+        }
+        if (num_top < OVERLAY_LINES) {
+            num_top++;
+        }
+        for (int j = num_top - 1; j > position; j--) {
+            top[j] = top[j - 1];
+        }
+        top[position] = i;
+    }
+    int height = (num_top + 1) * OVERLAY_LINE_HEIGHT + 6;
+    graphics_draw_rect(x, y, OVERLAY_WIDTH + 2, height + 2, COLOR_BLACK);
+    graphics_fill_rect(x + 1, y + 1, OVERLAY_WIDTH, height, COLOR_WHITE);
+    draw_line("total per game day", data.total.last_day, x + 4, y + 4);
+    for (int i = 0; i < num_top; i++) {
+        draw_line(section_name(top[i]), data.sections[top[i]].last_day, x + 4, y + 4 + (i + 1) * OVERLAY_LINE_HEIGHT);
+    }
+}
+
+#else
+
+void tick_profiler_begin_tick(void)
+{}
+
+void tick_profiler_end_tick(void)
+{}
+
+uint64_t tick_profiler_start(void)
+{
+    return 0;
+}
+
+void tick_profiler_stop(const char *section, uint64_t start)
+{}
+
+void tick_profiler_stop_figure(figure_type type, uint64_t start)
+{}
+
+int tick_profiler_start_csv(const char *filename)
+{
+    log_error("Tick profiling is not available: the game was built without PROFILE_TICKS", 0, 0);
+    return 0;
+}
+
+void tick_profiler_stop_csv(void)
+{}
+
+void tick_profiler_draw(int x, int y)
+{}
+
+#endif
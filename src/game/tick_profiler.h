@@ -0,0 +1,82 @@
+#ifndef GAME_TICK_PROFILER_H
+#define GAME_TICK_PROFILER_H
+
+#include "figure/type.h"
+
+#include <stdint.h>
+
+/**
+ * @file
+ * Times the parts of a game tick. Only active when built with the PROFILE_TICKS option,
+ * otherwise the TICK_PROFILE macros compile down to the plain calls.
+ */
+
+#ifdef PROFILE_TICKS
+#define TICK_PROFILE(call) \
+    do { \
+        uint64_t tick_profile_start = tick_profiler_start(); \
+        call; \
+        tick_profiler_stop(#call, tick_profile_start); \
+    } while (0)
+#define TICK_PROFILE_FIGURE(type, call) \
+    do { \
+        uint64_t tick_profile_start = tick_profiler_start(); \
+        call; \
+        tick_profiler_stop_figure(type, tick_profile_start); \
+    } while (0)
+#else
+#define TICK_PROFILE(call) call
+#define TICK_PROFILE_FIGURE(type, call) call
+#endif
+
+/**
+ * Marks the start of a game tick
+ */
+void tick_profiler_begin_tick(void);
+
+/**
+ * Marks the end of a game tick, storing its timings and writing them to the CSV file, if any
+ */
+void tick_profiler_end_tick(void);
+
+/**
+ * Starts timing a section of the tick
+ * @return The start time, to pass to tick_profiler_stop
+ */
+uint64_t tick_profiler_start(void);
+
+/**
+ * Stops timing a section of the tick
+ * @param section The name of the section. Must be a string literal: sections are told apart by address.
+ * @param start The start time returned by tick_profiler_start
+ */
+void tick_profiler_stop(const char *section, uint64_t start);
+
+/**
+ * Stops timing the action of a figure
+ * @param type The type of the figure
+ * @param start The start time returned by tick_profiler_start
+ */
+void tick_profiler_stop_figure(figure_type type, uint64_t start);
+
+/**
+ * Writes the time spent in each section of every following tick to a CSV file
+ * @param filename The file to write to
+ * @return Boolean true if the file was opened, false if it could not be opened
+ * or the game was built without PROFILE_TICKS
+ */
+int tick_profiler_start_csv(const char *filename);
+
+/**
+ * Closes the CSV file, if any
+ */
+void tick_profiler_stop_csv(void);
+
+/**
+ * Draws the sections that took the most time during the last game day
+ * @param x The left edge of the overlay
+ * @param y The top edge of the overlay
+ */
+void tick_profiler_draw(int x, int y);
+
+#endif // GAME_TICK_PROFILER_H
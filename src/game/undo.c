@@ -15,6 +15,7 @@
 #include "core/calc.h"
 #include "core/image.h"
 #include "figure/roamer_preview.h"
+#include "game/journal.h"
 #include "game/resource.h"
 #include "graphics/window.h"
 #include "map/aqueduct.h"
@@ -153,18 +154,16 @@ void game_undo_restore_building_state(void)
     clear_buildings();
 }
 
+static int is_restorable_image_tile(int grid_offset)
+{
+    return map_grid_is_inside(map_grid_offset_to_x(grid_offset), map_grid_offset_to_y(grid_offset), 1) &&
+        !map_building_at(grid_offset);
+}
+
 static void restore_map_images(void)
 {
-    int map_width, map_height;
-    map_grid_size(&map_width, &map_height);
-    for (int y = 0; y < map_height; y++) {
-        for (int x = 0; x < map_width; x++) {
-            int grid_offset = map_grid_offset(x, y);
-            if (!map_building_at(grid_offset)) {
-                map_image_restore_at(grid_offset);
-            }
-        }
-    }
+    // Only tiles changed since the backup are visited, so previews don't cost a pass over the whole map
+    map_image_restore_where(is_restorable_image_tile);
 }
 
 void game_undo_restore_map(int include_properties)
@@ -211,6 +210,7 @@ void game_undo_perform(void)
     if (!game_can_undo()) {
         return;
     }
+    game_journal_record(JOURNAL_UNDO);
     data.available = 0;
     city_finance_process_construction(-data.building_cost);
     if (data.type == BUILDING_CLEAR_LAND) {
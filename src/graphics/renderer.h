@@ -63,6 +63,7 @@ typedef struct {
     color_t *(*get_custom_image_buffer)(custom_image_type type, int *actual_texture_width);
     void (*release_custom_image_buffer)(custom_image_type type);
     void (*update_custom_image)(custom_image_type type);
+    void (*update_custom_image_rect)(custom_image_type type, int x, int y, int width, int height);
     void (*update_custom_image_from)(custom_image_type type, const color_t *buffer,
         int x_offset, int y_offset, int width, int height);
     void (*update_custom_image_yuv)(custom_image_type type, const uint8_t *y_data, int y_width,
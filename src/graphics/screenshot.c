@@ -3,10 +3,12 @@
 #include "city/view.h"
 #include "city/warning.h"
 #include "core/buffer.h"
+#include "core/calc.h"
 #include "core/config.h"
 #include "core/file.h"
 #include "core/log.h"
 #include "core/string.h"
+#include "core/thread.h"
 #include "graphics/screen.h"
 #include "graphics/graphics.h"
 #include "graphics/menu.h"
@@ -30,6 +32,8 @@
 #define IMAGE_HEIGHT_CHUNK (TILE_Y_SIZE * 15)
 #define IMAGE_BYTES_PER_PIXEL 3
 #define MINIMAP_SCALE 2.0f
+#define MAX_FULL_CITY_BANDS ((GRID_SIZE + 1) * TILE_Y_SIZE / IMAGE_HEIGHT_CHUNK + 1)
+#define MAX_QUEUED_BAND_BYTES (128 * 1024 * 1024)
 
 static struct {
     int width;
@@ -44,6 +48,26 @@ static struct {
     spng_ctx *ctx;
 } screenshot;
 
+typedef struct {
+    const color_t *canvas;
+    int canvas_width;
+} encoder_job;
+
+// The city is drawn in bands of rows, which are queued and encoded one at a time on a thread
+static struct {
+    int in_progress;
+    int show_notice;
+    int notice_id;
+    char filename[FILE_NAME_MAX];
+    int band_width;
+    color_t *bands[MAX_FULL_CITY_BANDS];
+    int total_bands;
+    int drawn_bands;
+    int encoded_bands;
+    thread_handle *thread;
+    encoder_job job;
+} full_city;
+
 static void image_free(void)
 {
     screenshot.width = 0;
@@ -185,7 +209,6 @@ static int image_write_rows(const color_t *canvas, int canvas_width)
         }
         int result = spng_encode_scanline(screenshot.ctx, screenshot.pixels, (size_t) screenshot.width * bytes_per_pixel);
         if (result != SPNG_OK && result != SPNG_EOI) {
-            image_free();
             return 0;
         }
     }
@@ -254,11 +277,116 @@ static void create_window_screenshot(void)
     image_free();
 }
 
-static void create_full_city_screenshot(void)
+static int run_encoder(void *data)
 {
-    if (!window_is(WINDOW_CITY) && !window_is(WINDOW_CITY_MILITARY)) {
+    encoder_job *job = data;
+    return image_write_rows(job->canvas, job->canvas_width);
+}
+
+static void finish_encoded_band(void)
+{
+    free(full_city.bands[full_city.encoded_bands]);
+    full_city.bands[full_city.encoded_bands] = 0;
+    full_city.encoded_bands++;
+}
+
+/**
+ * Starts encoding the next drawn band when the encoder is idle
+ * @param wait Boolean true to wait for the band being encoded, false to return if it is not done yet
+ * @return Boolean true if no error occurred
+ */
+static int advance_encoding(int wait)
+{
+    if (full_city.thread) {
+        if (!wait && !thread_is_finished(full_city.thread)) {
+            return 1;
+        }
+        int result = thread_wait(full_city.thread);
+        full_city.thread = 0;
+        finish_encoded_band();
+        if (!result) {
+            return 0;
+        }
+    }
+    while (full_city.encoded_bands < full_city.drawn_bands) {
+        full_city.job.canvas = full_city.bands[full_city.encoded_bands];
+        full_city.job.canvas_width = full_city.band_width;
+        full_city.thread = thread_create("screenshot encoder", run_encoder, &full_city.job);
+        if (full_city.thread) {
+            return 1;
+        }
+        int result = run_encoder(&full_city.job);
+        finish_encoded_band();
+        if (!result) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static color_t *allocate_band(void)
+{
+    size_t band_bytes = sizeof(color_t) * full_city.band_width * IMAGE_HEIGHT_CHUNK;
+    while (1) {
+        int queued_bands = full_city.drawn_bands - full_city.encoded_bands;
+        if (!queued_bands || (queued_bands + 1) * band_bytes <= MAX_QUEUED_BAND_BYTES) {
+            color_t *band = calloc(1, band_bytes);
+            if (band || !queued_bands) {
+                return band;
+            }
+        }
+        // Too many bands waiting: only now does drawing wait for the encoder
+        if (!advance_encoding(1)) {
+            return 0;
+        }
+    }
+}
+
+static void show_progress_notice(void)
+{
+    if (!full_city.show_notice) {
         return;
     }
+    uint8_t notice_text[FILE_NAME_MAX];
+    const uint8_t *prefix = translation_for(TR_WARNING_SCREENSHOT_WRITING);
+    uint8_t *cursor = string_copy(prefix, notice_text, FILE_NAME_MAX);
+    cursor += string_from_int(cursor, calc_percentage(full_city.encoded_bands, full_city.total_bands), 0);
+    cursor[0] = '%';
+    cursor[1] = 0;
+    full_city.notice_id = city_warning_show_custom(notice_text, full_city.notice_id);
+}
+
+static int complete_full_city_screenshot(int error)
+{
+    if (full_city.thread) {
+        if (!thread_wait(full_city.thread)) {
+            error = 1;
+        }
+        full_city.thread = 0;
+    }
+    for (int i = 0; i < MAX_FULL_CITY_BANDS; i++) {
+        free(full_city.bands[i]);
+        full_city.bands[i] = 0;
+    }
+    if (full_city.notice_id) {
+        city_warning_clear_id(full_city.notice_id);
+        full_city.notice_id = 0;
+    }
+    if (error) {
+        log_error("Error writing image", 0, 0);
+    } else {
+        log_info("Saved full city screenshot:", full_city.filename, 0);
+        if (full_city.show_notice) {
+            show_saved_notice(full_city.filename);
+        }
+    }
+    image_free();
+    full_city.in_progress = 0;
+    return !error;
+}
+
+static int create_full_city_screenshot(const char *filename, int show_notice)
+{
     pixel_offset original_camera_pixels;
     city_view_get_camera_in_pixels(&original_camera_pixels.x, &original_camera_pixels.y);
 
@@ -267,21 +395,21 @@ static void create_full_city_screenshot(void)
 
     if (!image_create(city_width_pixels, city_height_pixels + TILE_Y_SIZE, 0, IMAGE_HEIGHT_CHUNK)) {
         log_error("Unable to set memory for full city screenshot", 0, 0);
-        return;
+        return 0;
     }
-    const char *filename = generate_filename(SCREENSHOT_FULL_CITY);
     if (!image_begin_io(filename) || !image_write_header()) {
         log_error("Unable to write screenshot to:", filename, 0);
         image_free();
-        return;
-    }
-
-    color_t *canvas = malloc(sizeof(color_t) * city_width_pixels * IMAGE_HEIGHT_CHUNK);
-    if (!canvas) {
-        image_free();
-        return;
+        return 0;
     }
-    memset(canvas, 0, sizeof(color_t) * city_width_pixels * IMAGE_HEIGHT_CHUNK);
+    snprintf(full_city.filename, FILE_NAME_MAX, "%s", filename);
+    full_city.show_notice = show_notice;
+    full_city.notice_id = 0;
+    full_city.band_width = city_width_pixels;
+    full_city.total_bands = (city_height_pixels + TILE_Y_SIZE + IMAGE_HEIGHT_CHUNK - 1) / IMAGE_HEIGHT_CHUNK;
+    full_city.drawn_bands = 0;
+    full_city.encoded_bands = 0;
+    full_city.in_progress = 1;
 
     int canvas_width = 8 * TILE_X_SIZE;
     int old_scale = city_view_get_scale();
@@ -304,6 +432,11 @@ static void create_full_city_screenshot(void)
         IMAGE_HEIGHT_CHUNK + TOP_MENU_HEIGHT);
     int current_height = base_height;
     while ((size = image_request_rows()) != 0) {
+        color_t *canvas = allocate_band();
+        if (!canvas) {
+            error = 1;
+            break;
+        }
         int y_offset = current_height + IMAGE_HEIGHT_CHUNK > max_height ?
             IMAGE_HEIGHT_CHUNK - (max_height - current_height) - TILE_Y_SIZE: 0;
         for (int width = 0; width < city_width_pixels; width += canvas_width) {
@@ -318,8 +451,8 @@ static void create_full_city_screenshot(void)
             graphics_renderer()->save_screen_buffer(&canvas[width], x_offset, TOP_MENU_HEIGHT + y_offset,
                 image_section_width, IMAGE_HEIGHT_CHUNK - y_offset, city_width_pixels);
         }
-        if (!image_write_rows(canvas, city_width_pixels)) {
-            log_error("Error writing image", 0, 0);
+        full_city.bands[full_city.drawn_bands++] = canvas;
+        if (!advance_encoding(0)) {
             error = 1;
             break;
         }
@@ -330,12 +463,12 @@ static void create_full_city_screenshot(void)
     config_set(CONFIG_UI_DRAW_CLOUD_SHADOWS, draw_cloud_shadows);
     graphics_reset_clip_rectangle();
     city_view_set_camera_from_pixel_position(original_camera_pixels.x, original_camera_pixels.y);
-    if (!error) {
-        log_info("Saved full city screenshot:", filename, 0);
-        show_saved_notice(filename);
+    // The queued bands are encoded while the game goes on, see graphics_finish_screenshot()
+    if (error || full_city.encoded_bands == full_city.total_bands) {
+        return complete_full_city_screenshot(error);
     }
-    image_free();
-    window_invalidate();
+    show_progress_notice();
+    return 1;
 }
 
 static void create_minimap_screenshot(void)
@@ -376,11 +509,45 @@ static void create_minimap_screenshot(void)
     window_invalidate();
 }
 
+static int continue_full_city_screenshot(int wait)
+{
+    do {
+        if (!advance_encoding(wait)) {
+            return complete_full_city_screenshot(1);
+        }
+    } while (wait && full_city.encoded_bands < full_city.total_bands);
+    if (full_city.encoded_bands == full_city.total_bands) {
+        return complete_full_city_screenshot(0);
+    }
+    show_progress_notice();
+    return 1;
+}
+
+void graphics_finish_screenshot(int wait)
+{
+    if (full_city.in_progress) {
+        continue_full_city_screenshot(wait);
+    }
+}
+
+int graphics_save_full_city_screenshot(const char *filename)
+{
+    graphics_finish_screenshot(1);
+    if (!create_full_city_screenshot(filename, 0)) {
+        return 0;
+    }
+    return !full_city.in_progress || continue_full_city_screenshot(1);
+}
+
 void graphics_save_screenshot(screenshot_type type)
 {
+    graphics_finish_screenshot(1);
     switch (type) {
         case SCREENSHOT_FULL_CITY:
-            create_full_city_screenshot();
+            if (window_is(WINDOW_CITY) || window_is(WINDOW_CITY_MILITARY)) {
+                create_full_city_screenshot(generate_filename(SCREENSHOT_FULL_CITY), 1);
+                window_invalidate();
+            }
             return;
         case SCREENSHOT_MINIMAP:
             create_minimap_screenshot();
@@ -10,4 +10,19 @@ typedef enum {
 
 void graphics_save_screenshot(screenshot_type type);
 
+/**
+ * Draws the whole city at 100% zoom and saves it, without needing the city window to be shown.
+ * Waits for the file to be written.
+ * @param filename The PNG file to write
+ * @return Boolean true on success
+ */
+int graphics_save_full_city_screenshot(const char *filename);
+
+/**
+ * Continues writing the full city screenshot whose drawn rows are still being encoded, if any.
+ * Called every frame, it starts encoding the next queued rows and shows how much is written.
+ * @param wait Boolean true to wait for the file to be written, false to only complete it if it already was
+ */
+void graphics_finish_screenshot(int wait);
+
 #endif // GRAPHICS_SCREENSHOT_H
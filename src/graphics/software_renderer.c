@@ -0,0 +1,891 @@
+#include "software_renderer.h"
+
+#include "core/config.h"
+#include "core/image.h"
+#include "core/image_group.h"
+#include "graphics/renderer.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_IMAGE_SIZE 4096
+#define MAX_PACKED_IMAGE_SIZE 64000
+#define MAX_UNPACKED_IMAGES 20
+
+#define PI 3.14159265358979323846
+
+#define SILHOUETTE_COLOR 0x00d6f3d6
+
+typedef enum {
+    BLEND_ALPHA,
+    BLEND_NONE,
+    BLEND_MULTIPLY
+} blend_mode;
+
+typedef struct {
+    const color_t *pixels;
+    int row_width;
+    int width;
+    int height;
+    blend_mode blend;
+} pixel_source;
+
+typedef struct {
+    color_t mask;
+    blend_mode blend;
+    int is_silhouette;
+} draw_state;
+
+typedef struct saved_image {
+    int id;
+    color_t *pixels;
+    int width;
+    int height;
+    int buffer_size;
+    struct saved_image *next;
+} saved_image;
+
+static struct {
+    struct {
+        color_t *pixels;
+        int width;
+        int height;
+    } framebuffer;
+    struct {
+        int x;
+        int y;
+        int width;
+        int height;
+    } viewport;
+    // Relative to the viewport, like the SDL clip rectangle
+    struct {
+        int enabled;
+        int x;
+        int y;
+        int width;
+        int height;
+    } clip;
+    // The part of the framebuffer that can be drawn to, in framebuffer coordinates
+    struct {
+        int x_min;
+        int y_min;
+        int x_max;
+        int y_max;
+    } draw_area;
+    image_atlas_data atlas_data[ATLAS_MAX];
+    int has_atlas[ATLAS_MAX];
+    struct {
+        color_t *buffer;
+        image img;
+        blend_mode blend;
+    } custom_images[CUSTOM_IMAGE_MAX];
+    struct {
+        int id;
+        int last_used;
+        color_t *pixels;
+    } unpacked_images[MAX_UNPACKED_IMAGES];
+    int unpacked_images_used;
+    struct {
+        saved_image *first;
+        int current_id;
+    } saved_images;
+    struct {
+        int *list;
+        int size;
+    } columns;
+    float city_scale;
+    graphics_renderer_interface renderer_interface;
+} data;
+
+static void update_draw_area(void)
+{
+    int x_min = data.viewport.x;
+    int y_min = data.viewport.y;
+    int x_max = x_min + data.viewport.width;
+    int y_max = y_min + data.viewport.height;
+    if (data.clip.enabled) {
+        int clip_x = data.viewport.x + data.clip.x;
+        int clip_y = data.viewport.y + data.clip.y;
+        x_min = x_min > clip_x ? x_min : clip_x;
+        y_min = y_min > clip_y ? y_min : clip_y;
+        x_max = x_max < clip_x + data.clip.width ? x_max : clip_x + data.clip.width;
+        y_max = y_max < clip_y + data.clip.height ? y_max : clip_y + data.clip.height;
+    }
+    data.draw_area.x_min = x_min > 0 ? x_min : 0;
+    data.draw_area.y_min = y_min > 0 ? y_min : 0;
+    data.draw_area.x_max = x_max < data.framebuffer.width ? x_max : data.framebuffer.width;
+    data.draw_area.y_max = y_max < data.framebuffer.height ? y_max : data.framebuffer.height;
+}
+
+static void clear_screen(void)
+{
+    if (data.framebuffer.pixels) {
+        memset(data.framebuffer.pixels, 0,
+            sizeof(color_t) * data.framebuffer.width * data.framebuffer.height);
+    }
+}
+
+static void set_viewport(int x, int y, int width, int height)
+{
+    data.viewport.x = x;
+    data.viewport.y = y;
+    data.viewport.width = width;
+    data.viewport.height = height;
+    update_draw_area();
+}
+
+static void reset_viewport(void)
+{
+    data.clip.enabled = 0;
+    set_viewport(0, 0, data.framebuffer.width, data.framebuffer.height);
+}
+
+static void set_clip_rectangle(int x, int y, int width, int height)
+{
+    data.clip.enabled = 1;
+    data.clip.x = x;
+    data.clip.y = y;
+    data.clip.width = width;
+    data.clip.height = height;
+    update_draw_area();
+}
+
+static void reset_clip_rectangle(void)
+{
+    data.clip.enabled = 0;
+    update_draw_area();
+}
+
+static inline color_t blend_pixel(color_t src, color_t dst)
+{
+    color_t alpha = src >> COLOR_BITSHIFT_ALPHA;
+    if (alpha == 0xff) {
+        return src;
+    }
+    if (!alpha) {
+        return dst;
+    }
+    if ((dst & COLOR_CHANNEL_ALPHA) == ALPHA_OPAQUE) {
+        return COLOR_BLEND_ALPHA_TO_OPAQUE(src, dst, alpha);
+    }
+    color_t alpha_dst = dst >> COLOR_BITSHIFT_ALPHA;
+    return (COLOR_MIX_ALPHA(alpha, alpha_dst) << COLOR_BITSHIFT_ALPHA) |
+        (COLOR_BLEND_ALPHA_TO_OPAQUE(src, dst, alpha) & COLOR_CHANNEL_RGB);
+}
+
+static inline color_t multiply_channel(color_t a, color_t b, int shift)
+{
+    return ((COLOR_COMPONENT(a, shift) * COLOR_COMPONENT(b, shift) + 0xff) >> 8) << shift;
+}
+
+static color_t mask_pixel(color_t src, color_t mask)
+{
+    return multiply_channel(src, mask, COLOR_BITSHIFT_ALPHA) | multiply_channel(src, mask, COLOR_BITSHIFT_RED) |
+        multiply_channel(src, mask, COLOR_BITSHIFT_GREEN) | multiply_channel(src, mask, COLOR_BITSHIFT_BLUE);
+}
+
+static color_t multiply_pixel(color_t src, color_t dst)
+{
+    return (dst & COLOR_CHANNEL_ALPHA) | multiply_channel(src, dst, COLOR_BITSHIFT_RED) |
+        multiply_channel(src, dst, COLOR_BITSHIFT_GREEN) | multiply_channel(src, dst, COLOR_BITSHIFT_BLUE);
+}
+
+static void draw_row(color_t *dst, const color_t *src, const int *columns, int length, const draw_state *state)
+{
+    // Most sprites are drawn unscaled and without a colour mask, so that case gets the tightest loop
+    if (!columns && state->blend == BLEND_ALPHA && state->mask == COLOR_MASK_NONE && !state->is_silhouette) {
+        for (int i = 0; i < length; i++) {
+            dst[i] = blend_pixel(src[i], dst[i]);
+        }
+        return;
+    }
+    for (int i = 0; i < length; i++) {
+        color_t pixel = columns ? src[columns[i]] : src[i];
+        if (state->is_silhouette) {
+            pixel = (pixel & COLOR_CHANNEL_ALPHA) | SILHOUETTE_COLOR;
+        }
+        if (state->mask != COLOR_MASK_NONE) {
+            pixel = mask_pixel(pixel, state->mask);
+        }
+        if (state->blend == BLEND_NONE) {
+            dst[i] = pixel;
+        } else if (state->blend == BLEND_MULTIPLY) {
+            dst[i] = multiply_pixel(pixel, dst[i]);
+        } else {
+            dst[i] = blend_pixel(pixel, dst[i]);
+        }
+    }
+}
+
+static int *get_columns(int size)
+{
+    if (size > data.columns.size) {
+        int *list = realloc(data.columns.list, sizeof(int) * size);
+        if (!list) {
+            return 0;
+        }
+        data.columns.list = list;
+        data.columns.size = size;
+    }
+    return data.columns.list;
+}
+
+static void draw_rotated(const pixel_source *source, float x, float y, float width, float height,
+    double angle, const draw_state *state)
+{
+    // The angle is in degrees clockwise, around the centre of the destination, as with SDL_RenderCopyEx
+    double radians = angle * PI / 180.0;
+    float cos_angle = (float) cos(radians);
+    float sin_angle = (float) sin(radians);
+    float center_x = x + width / 2;
+    float center_y = y + height / 2;
+    float half_width = (fabsf(width * cos_angle) + fabsf(height * sin_angle)) / 2;
+    float half_height = (fabsf(width * sin_angle) + fabsf(height * cos_angle)) / 2;
+
+    int x_min = (int) floorf(center_x - half_width);
+    int y_min = (int) floorf(center_y - half_height);
+    int x_max = (int) ceilf(center_x + half_width);
+    int y_max = (int) ceilf(center_y + half_height);
+    x_min = x_min > data.draw_area.x_min ? x_min : data.draw_area.x_min;
+    y_min = y_min > data.draw_area.y_min ? y_min : data.draw_area.y_min;
+    x_max = x_max < data.draw_area.x_max ? x_max : data.draw_area.x_max;
+    y_max = y_max < data.draw_area.y_max ? y_max : data.draw_area.y_max;
+
+    float x_ratio = source->width / width;
+    float y_ratio = source->height / height;
+    for (int dst_y = y_min; dst_y < y_max; dst_y++) {
+        color_t *dst = &data.framebuffer.pixels[dst_y * data.framebuffer.width];
+        float relative_y = dst_y + 0.5f - center_y;
+        for (int dst_x = x_min; dst_x < x_max; dst_x++) {
+            float relative_x = dst_x + 0.5f - center_x;
+            int src_x = (int) floorf((relative_x * cos_angle + relative_y * sin_angle + width / 2) * x_ratio);
+            int src_y = (int) floorf((relative_y * cos_angle - relative_x * sin_angle + height / 2) * y_ratio);
+            if (src_x < 0 || src_x >= source->width || src_y < 0 || src_y >= source->height) {
+                continue;
+            }
+            draw_row(&dst[dst_x], &source->pixels[src_y * source->row_width + src_x], 0, 1, state);
+        }
+    }
+}
+
+static void draw_pixels(const pixel_source *source, float x, float y, float width, float height,
+    double angle, const draw_state *state)
+{
+    if (!data.framebuffer.pixels || width <= 0 || height <= 0) {
+        return;
+    }
+    x += data.viewport.x;
+    y += data.viewport.y;
+    if (angle != 0.0) {
+        draw_rotated(source, x, y, width, height, angle, state);
+        return;
+    }
+    int x_start = (int) floorf(x + 0.5f);
+    int y_start = (int) floorf(y + 0.5f);
+    int x_end = (int) floorf(x + width + 0.5f);
+    int y_end = (int) floorf(y + height + 0.5f);
+    int x_min = x_start > data.draw_area.x_min ? x_start : data.draw_area.x_min;
+    int y_min = y_start > data.draw_area.y_min ? y_start : data.draw_area.y_min;
+    int x_max = x_end < data.draw_area.x_max ? x_end : data.draw_area.x_max;
+    int y_max = y_end < data.draw_area.y_max ? y_end : data.draw_area.y_max;
+    if (x_min >= x_max || y_min >= y_max) {
+        return;
+    }
+    int length = x_max - x_min;
+    int is_unscaled = x_end - x_start == source->width && y_end - y_start == source->height;
+    const int *columns = 0;
+    if (!is_unscaled) {
+        // Nearest neighbour sampling: the source column of every destination column is the same on all rows
+        int *list = get_columns(length);
+        if (!list) {
+            return;
+        }
+        float x_ratio = source->width / width;
+        for (int i = 0; i < length; i++) {
+            int src_x = (int) ((x_min + i + 0.5f - x) * x_ratio);
+            list[i] = src_x < source->width ? src_x : source->width - 1;
+        }
+        columns = list;
+    }
+    float y_ratio = source->height / height;
+    for (int dst_y = y_min; dst_y < y_max; dst_y++) {
+        int src_y;
+        if (is_unscaled) {
+            src_y = dst_y - y_start;
+        } else {
+            src_y = (int) ((dst_y + 0.5f - y) * y_ratio);
+            src_y = src_y < source->height ? src_y : source->height - 1;
+        }
+        const color_t *src = &source->pixels[src_y * source->row_width];
+        if (is_unscaled) {
+            src += x_min - x_start;
+        }
+        draw_row(&data.framebuffer.pixels[dst_y * data.framebuffer.width + x_min], src, columns, length, state);
+    }
+}
+
+static void fill_area(int x, int y, int width, int height, color_t color)
+{
+    if (!data.framebuffer.pixels) {
+        return;
+    }
+    x += data.viewport.x;
+    y += data.viewport.y;
+    int x_min = x > data.draw_area.x_min ? x : data.draw_area.x_min;
+    int y_min = y > data.draw_area.y_min ? y : data.draw_area.y_min;
+    int x_max = x + width < data.draw_area.x_max ? x + width : data.draw_area.x_max;
+    int y_max = y + height < data.draw_area.y_max ? y + height : data.draw_area.y_max;
+    for (int dst_y = y_min; dst_y < y_max; dst_y++) {
+        color_t *dst = &data.framebuffer.pixels[dst_y * data.framebuffer.width];
+        if ((color & COLOR_CHANNEL_ALPHA) == ALPHA_OPAQUE) {
+            for (int dst_x = x_min; dst_x < x_max; dst_x++) {
+                dst[dst_x] = color;
+            }
+        } else {
+            for (int dst_x = x_min; dst_x < x_max; dst_x++) {
+                dst[dst_x] = blend_pixel(color, dst[dst_x]);
+            }
+        }
+    }
+}
+
+static void draw_line(int x_start, int x_end, int y_start, int y_end, color_t color)
+{
+    int dx = abs(x_end - x_start);
+    int dy = -abs(y_end - y_start);
+    int step_x = x_start < x_end ? 1 : -1;
+    int step_y = y_start < y_end ? 1 : -1;
+    int error = dx + dy;
+    while (1) {
+        fill_area(x_start, y_start, 1, 1, color);
+        if (x_start == x_end && y_start == y_end) {
+            break;
+        }
+        int error2 = error * 2;
+        if (error2 >= dy) {
+            error += dy;
+            x_start += step_x;
+        }
+        if (error2 <= dx) {
+            error += dx;
+            y_start += step_y;
+        }
+    }
+}
+
+static void draw_rect(int x, int width, int y, int height, color_t color)
+{
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+    fill_area(x, y, width, 1, color);
+    if (height > 1) {
+        fill_area(x, y + height - 1, width, 1, color);
+    }
+    fill_area(x, y + 1, 1, height - 2, color);
+    if (width > 1) {
+        fill_area(x + width - 1, y + 1, 1, height - 2, color);
+    }
+}
+
+static void fill_rect(int x, int width, int y, int height, color_t color)
+{
+    fill_area(x, y, width, height, color);
+}
+
+static const color_t *get_unpacked_image_pixels(int unpacked_image_id)
+{
+    for (int i = 0; i < MAX_UNPACKED_IMAGES; i++) {
+        if (data.unpacked_images[i].pixels && data.unpacked_images[i].id == unpacked_image_id) {
+            data.unpacked_images[i].last_used = ++data.unpacked_images_used;
+            return data.unpacked_images[i].pixels;
+        }
+    }
+    return 0;
+}
+
+static int get_image_pixels(const image *img, pixel_source *source)
+{
+    atlas_type type = img->atlas.id >> IMAGE_ATLAS_BIT_OFFSET;
+    int index = img->atlas.id & IMAGE_ATLAS_BIT_MASK;
+    const color_t *pixels = 0;
+    int row_width = 0;
+    source->blend = BLEND_ALPHA;
+    if (type == ATLAS_CUSTOM || type == ATLAS_EXTERNAL) {
+        custom_image_type custom_type = type == ATLAS_EXTERNAL ? CUSTOM_IMAGE_EXTERNAL : index;
+        if (custom_type >= CUSTOM_IMAGE_MAX) {
+            return 0;
+        }
+        pixels = data.custom_images[custom_type].buffer;
+        row_width = data.custom_images[custom_type].img.width;
+        source->blend = data.custom_images[custom_type].blend;
+    } else if (type == ATLAS_UNPACKED_EXTRA_ASSET) {
+        pixels = get_unpacked_image_pixels(index);
+        row_width = img->width;
+    } else if (type < ATLAS_MAX && data.has_atlas[type] && index < data.atlas_data[type].num_images) {
+        pixels = data.atlas_data[type].buffers[index];
+        row_width = data.atlas_data[type].image_widths[index];
+    }
+    if (!pixels) {
+        return 0;
+    }
+    source->pixels = &pixels[img->atlas.y_offset * row_width + img->atlas.x_offset];
+    source->row_width = row_width;
+    source->width = img->width;
+    source->height = img->height;
+    return 1;
+}
+
+static void draw_image_with_state(const image *img, float x, float y, color_t color,
+    float scale_x, float scale_y, double angle, int disable_coord_scaling, int is_silhouette)
+{
+    pixel_source source;
+    if (!get_image_pixels(img, &source)) {
+        return;
+    }
+    draw_state state = { color ? color : COLOR_MASK_NONE, source.blend, is_silhouette };
+
+    x += img->x_offset;
+    y += img->y_offset;
+
+    // Same as the SDL renderer: when zoomed out, the isometric images are shrunk to simulate the grid
+    int grid_correction = (img->is_isometric && config_get(CONFIG_UI_SHOW_GRID) && data.city_scale > 2.0f) ? 2 : 0;
+
+    float coord_scale_x = disable_coord_scaling ? 1.0f : scale_x;
+    float coord_scale_y = disable_coord_scaling ? 1.0f : scale_y;
+
+    draw_pixels(&source, (x + grid_correction) / coord_scale_x, (y + grid_correction) / coord_scale_y,
+        (img->width - grid_correction) / scale_x, (img->height - grid_correction) / scale_y, angle, &state);
+}
+
+static void draw_image_advanced(const image *img, float x, float y, color_t color,
+    float scale_x, float scale_y, double angle, int disable_coord_scaling)
+{
+    draw_image_with_state(img, x, y, color, scale_x, scale_y, angle, disable_coord_scaling, 0);
+}
+
+static void draw_image(const image *img, int x, int y, color_t color, float scale)
+{
+    draw_image_with_state(img, (float) x, (float) y, color, scale, scale, 0.0, 0, 0);
+}
+
+static void draw_silhouette(const image *img, int x, int y, color_t color, float scale)
+{
+    draw_image_with_state(img, (float) x, (float) y, color, scale, scale, 0.0, 0, 1);
+}
+
+static void create_custom_image(custom_image_type type, int width, int height, int is_yuv)
+{
+    free(data.custom_images[type].buffer);
+    memset(&data.custom_images[type], 0, sizeof(data.custom_images[type]));
+    data.custom_images[type].buffer = calloc((size_t) width * height, sizeof(color_t));
+    if (!data.custom_images[type].buffer) {
+        return;
+    }
+    data.custom_images[type].img.width = width;
+    data.custom_images[type].img.height = height;
+    data.custom_images[type].img.atlas.id = (ATLAS_CUSTOM << IMAGE_ATLAS_BIT_OFFSET) | type;
+    data.custom_images[type].blend = type == CUSTOM_IMAGE_VIDEO ? BLEND_NONE : BLEND_ALPHA;
+}
+
+static int has_custom_image(custom_image_type type)
+{
+    return data.custom_images[type].buffer != 0;
+}
+
+static color_t *get_custom_image_buffer(custom_image_type type, int *actual_texture_width)
+{
+    if (actual_texture_width) {
+        *actual_texture_width = data.custom_images[type].img.width;
+    }
+    return data.custom_images[type].buffer;
+}
+
+static void release_custom_image_buffer(custom_image_type type)
+{
+    // The buffer is the image itself
+}
+
+static void update_custom_image(custom_image_type type)
+{
+    // The buffer is the image itself
+}
+
+static void update_custom_image_rect(custom_image_type type, int x, int y, int width, int height)
+{
+    // The buffer is the image itself
+}
+
+static void update_custom_image_from(custom_image_type type, const color_t *buffer,
+    int x_offset, int y_offset, int width, int height)
+{
+    color_t *pixels = data.custom_images[type].buffer;
+    int image_width = data.custom_images[type].img.width;
+    if (!pixels || x_offset + width > image_width || y_offset + height > data.custom_images[type].img.height) {
+        return;
+    }
+    for (int y = 0; y < height; y++) {
+        memcpy(&pixels[(y_offset + y) * image_width + x_offset], &buffer[y * width], sizeof(color_t) * width);
+    }
+}
+
+static void update_custom_image_yuv(custom_image_type type, const uint8_t *y_data, int y_width,
+    const uint8_t *cb_data, int cb_width, const uint8_t *cr_data, int cr_width)
+{}
+
+static void create_footprint_image(custom_image_type type)
+{
+    create_custom_image(type, FOOTPRINT_WIDTH, FOOTPRINT_HEIGHT, 0);
+    color_t *pixels = data.custom_images[type].buffer;
+    pixel_source flat_tile;
+    if (!pixels || !get_image_pixels(image_get(image_group(GROUP_TERRAIN_FLAT_TILE)), &flat_tile)) {
+        return;
+    }
+    color_t color = type == CUSTOM_IMAGE_RED_FOOTPRINT ? COLOR_MASK_RED : COLOR_MASK_GREEN;
+    int width = flat_tile.width < FOOTPRINT_WIDTH ? flat_tile.width : FOOTPRINT_WIDTH;
+    int height = flat_tile.height < FOOTPRINT_HEIGHT ? flat_tile.height : FOOTPRINT_HEIGHT;
+    for (int i = 0; i < FOOTPRINT_WIDTH * FOOTPRINT_HEIGHT; i++) {
+        pixels[i] = COLOR_WHITE;
+    }
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            color_t pixel = mask_pixel(flat_tile.pixels[y * flat_tile.row_width + x], color);
+            pixels[y * FOOTPRINT_WIDTH + x] = blend_pixel(pixel, pixels[y * FOOTPRINT_WIDTH + x]);
+        }
+    }
+    data.custom_images[type].img.is_isometric = 1;
+    data.custom_images[type].blend = BLEND_MULTIPLY;
+}
+
+static void draw_custom_image(custom_image_type type, int x, int y, float scale, int disable_filtering)
+{
+    if ((type == CUSTOM_IMAGE_RED_FOOTPRINT || type == CUSTOM_IMAGE_GREEN_FOOTPRINT) &&
+        !data.custom_images[type].buffer) {
+        create_footprint_image(type);
+    }
+    draw_image(&data.custom_images[type].img, x, y, 0, scale);
+}
+
+static int has_nothing(void)
+{
+    return 0;
+}
+
+static int start_tooltip_creation(int width, int height)
+{
+    // Tooltips are drawn by the platform over the finished frame, which an image in memory does not need
+    return 0;
+}
+
+static void finish_tooltip_creation(void)
+{}
+
+static void set_tooltip_position(int x, int y)
+{}
+
+static void set_tooltip_opacity(int opacity)
+{}
+
+static saved_image *get_saved_image(int image_id)
+{
+    for (saved_image *saved = data.saved_images.first; saved; saved = saved->next) {
+        if (saved->id == image_id) {
+            return saved;
+        }
+    }
+    return 0;
+}
+
+static int save_image_from_screen(int image_id, int x, int y, int width, int height)
+{
+    if (!data.framebuffer.pixels || width <= 0 || height <= 0) {
+        return 0;
+    }
+    saved_image *saved = get_saved_image(image_id);
+    if (!saved) {
+        saved = calloc(1, sizeof(saved_image));
+        if (!saved) {
+            return 0;
+        }
+        saved->id = ++data.saved_images.current_id;
+        saved->next = data.saved_images.first;
+        data.saved_images.first = saved;
+    }
+    if (saved->buffer_size < width * height) {
+        free(saved->pixels);
+        saved->pixels = malloc(sizeof(color_t) * width * height);
+        saved->buffer_size = saved->pixels ? width * height : 0;
+        if (!saved->pixels) {
+            return 0;
+        }
+    }
+    saved->width = width;
+    saved->height = height;
+    x += data.viewport.x;
+    y += data.viewport.y;
+    for (int row = 0; row < height; row++) {
+        for (int column = 0; column < width; column++) {
+            int src_x = x + column;
+            int src_y = y + row;
+            int is_inside = src_x >= 0 && src_x < data.framebuffer.width && src_y >= 0 && src_y < data.framebuffer.height;
+            saved->pixels[row * width + column] = is_inside ?
+                data.framebuffer.pixels[src_y * data.framebuffer.width + src_x] : ALPHA_TRANSPARENT;
+        }
+    }
+    return saved->id;
+}
+
+static void draw_image_to_screen(int image_id, int x, int y)
+{
+    saved_image *saved = get_saved_image(image_id);
+    if (!saved || !saved->pixels) {
+        return;
+    }
+    pixel_source source = { saved->pixels, saved->width, saved->width, saved->height, BLEND_NONE };
+    draw_state state = { COLOR_MASK_NONE, BLEND_NONE, 0 };
+    draw_pixels(&source, (float) x, (float) y, (float) saved->width, (float) saved->height, 0.0, &state);
+}
+
+static void free_saved_images(void)
+{
+    saved_image *saved = data.saved_images.first;
+    while (saved) {
+        saved_image *current = saved;
+        saved = saved->next;
+        free(current->pixels);
+        free(current);
+    }
+    data.saved_images.first = 0;
+    data.saved_images.current_id = 0;
+}
+
+static int save_screen_buffer(color_t *pixels, int x, int y, int width, int height, int row_width)
+{
+    x += data.viewport.x;
+    y += data.viewport.y;
+    if (!data.framebuffer.pixels || x < 0 || y < 0 ||
+        x + width > data.framebuffer.width || y + height > data.framebuffer.height) {
+        return 0;
+    }
+    // The frame is already in memory: reading it back is just a copy
+    for (int row = 0; row < height; row++) {
+        memcpy(&pixels[row * row_width], &data.framebuffer.pixels[(y + row) * data.framebuffer.width + x],
+            sizeof(color_t) * width);
+    }
+    return 1;
+}
+
+static void get_max_image_size(int *width, int *height)
+{
+    *width = MAX_IMAGE_SIZE;
+    *height = MAX_IMAGE_SIZE;
+}
+
+static void free_atlas(atlas_type type)
+{
+    image_atlas_data *atlas_data = &data.atlas_data[type];
+    if (atlas_data->buffers) {
+        for (int i = 0; i < atlas_data->num_images; i++) {
+            free(atlas_data->buffers[i]);
+        }
+        free(atlas_data->buffers);
+    }
+    free(atlas_data->image_widths);
+    free(atlas_data->image_heights);
+    memset(atlas_data, 0, sizeof(image_atlas_data));
+    atlas_data->type = type;
+    data.has_atlas[type] = 0;
+}
+
+static const image_atlas_data *prepare_atlas(atlas_type type, int num_images, int last_width, int last_height)
+{
+    free_atlas(type);
+    image_atlas_data *atlas_data = &data.atlas_data[type];
+    atlas_data->num_images = num_images;
+    atlas_data->image_widths = malloc(sizeof(int) * num_images);
+    atlas_data->image_heights = malloc(sizeof(int) * num_images);
+    atlas_data->buffers = calloc(num_images, sizeof(color_t *));
+    if (!atlas_data->image_widths || !atlas_data->image_heights || !atlas_data->buffers) {
+        free_atlas(type);
+        return 0;
+    }
+    for (int i = 0; i < num_images; i++) {
+        atlas_data->image_widths[i] = i == num_images - 1 ? last_width : MAX_IMAGE_SIZE;
+        atlas_data->image_heights[i] = i == num_images - 1 ? last_height : MAX_IMAGE_SIZE;
+        atlas_data->buffers[i] = calloc((size_t) atlas_data->image_widths[i] * atlas_data->image_heights[i],
+            sizeof(color_t));
+        if (!atlas_data->buffers[i]) {
+            free_atlas(type);
+            return 0;
+        }
+    }
+    return atlas_data;
+}
+
+static int create_atlas(const image_atlas_data *atlas_data, int delete_buffers)
+{
+    if (!atlas_data || atlas_data != &data.atlas_data[atlas_data->type] || !atlas_data->num_images) {
+        return 0;
+    }
+    // The buffers are what gets drawn, so they are kept even when the caller no longer needs them
+    data.has_atlas[atlas_data->type] = 1;
+    return 1;
+}
+
+static const image_atlas_data *get_atlas(atlas_type type)
+{
+    return data.has_atlas[type] ? &data.atlas_data[type] : 0;
+}
+
+static int has_atlas(atlas_type type)
+{
+    return data.has_atlas[type];
+}
+
+static void load_unpacked_image(const image *img, const color_t *pixels)
+{
+    int unpacked_image_id = img->atlas.id & IMAGE_ATLAS_BIT_MASK;
+    if (get_unpacked_image_pixels(unpacked_image_id)) {
+        return;
+    }
+    int index = 0;
+    for (int i = 0; i < MAX_UNPACKED_IMAGES; i++) {
+        if (!data.unpacked_images[i].pixels) {
+            index = i;
+            break;
+        }
+        if (data.unpacked_images[i].last_used < data.unpacked_images[index].last_used) {
+            index = i;
+        }
+    }
+    int image_height = img->height;
+    if (img->top) {
+        image_height += img->top->height;
+    }
+    free(data.unpacked_images[index].pixels);
+    data.unpacked_images[index].pixels = malloc(sizeof(color_t) * img->width * image_height);
+    if (!data.unpacked_images[index].pixels) {
+        return;
+    }
+    memcpy(data.unpacked_images[index].pixels, pixels, sizeof(color_t) * img->width * image_height);
+    data.unpacked_images[index].id = unpacked_image_id;
+    data.unpacked_images[index].last_used = ++data.unpacked_images_used;
+}
+
+static void free_unpacked_image(const image *img)
+{
+    int unpacked_image_id = img->atlas.id & IMAGE_ATLAS_BIT_MASK;
+    for (int i = 0; i < MAX_UNPACKED_IMAGES; i++) {
+        if (data.unpacked_images[i].pixels && data.unpacked_images[i].id == unpacked_image_id) {
+            free(data.unpacked_images[i].pixels);
+            data.unpacked_images[i].pixels = 0;
+            return;
+        }
+    }
+}
+
+static int should_pack_image(int width, int height)
+{
+    return width * height < MAX_PACKED_IMAGE_SIZE;
+}
+
+static void update_scale(int city_scale)
+{
+    data.city_scale = city_scale / 100.0f;
+}
+
+static void create_renderer_interface(void)
+{
+    data.renderer_interface.clear_screen = clear_screen;
+    data.renderer_interface.set_viewport = set_viewport;
+    data.renderer_interface.reset_viewport = reset_viewport;
+    data.renderer_interface.set_clip_rectangle = set_clip_rectangle;
+    data.renderer_interface.reset_clip_rectangle = reset_clip_rectangle;
+    data.renderer_interface.draw_line = draw_line;
+    data.renderer_interface.draw_rect = draw_rect;
+    data.renderer_interface.fill_rect = fill_rect;
+    data.renderer_interface.draw_image = draw_image;
+    data.renderer_interface.draw_image_advanced = draw_image_advanced;
+    data.renderer_interface.draw_silhouette = draw_silhouette;
+    data.renderer_interface.create_custom_image = create_custom_image;
+    data.renderer_interface.has_custom_image = has_custom_image;
+    data.renderer_interface.get_custom_image_buffer = get_custom_image_buffer;
+    data.renderer_interface.release_custom_image_buffer = release_custom_image_buffer;
+    data.renderer_interface.update_custom_image = update_custom_image;
+    data.renderer_interface.update_custom_image_rect = update_custom_image_rect;
+    data.renderer_interface.update_custom_image_from = update_custom_image_from;
+    data.renderer_interface.update_custom_image_yuv = update_custom_image_yuv;
+    data.renderer_interface.draw_custom_image = draw_custom_image;
+    data.renderer_interface.supports_yuv_image_format = has_nothing;
+    data.renderer_interface.start_tooltip_creation = start_tooltip_creation;
+    data.renderer_interface.finish_tooltip_creation = finish_tooltip_creation;
+    data.renderer_interface.set_tooltip_position = set_tooltip_position;
+    data.renderer_interface.set_tooltip_opacity = set_tooltip_opacity;
+    data.renderer_interface.has_tooltip = has_nothing;
+    data.renderer_interface.save_image_from_screen = save_image_from_screen;
+    data.renderer_interface.draw_image_to_screen = draw_image_to_screen;
+    data.renderer_interface.save_screen_buffer = save_screen_buffer;
+    data.renderer_interface.get_max_image_size = get_max_image_size;
+    data.renderer_interface.prepare_image_atlas = prepare_atlas;
+    data.renderer_interface.create_image_atlas = create_atlas;
+    data.renderer_interface.get_image_atlas = get_atlas;
+    data.renderer_interface.has_image_atlas = has_atlas;
+    data.renderer_interface.free_image_atlas = free_atlas;
+    data.renderer_interface.load_unpacked_image = load_unpacked_image;
+    data.renderer_interface.free_unpacked_image = free_unpacked_image;
+    data.renderer_interface.should_pack_image = should_pack_image;
+    data.renderer_interface.update_scale = update_scale;
+
+    graphics_renderer_set_interface(&data.renderer_interface);
+}
+
+static int resize_framebuffer(int width, int height)
+{
+    color_t *pixels = calloc((size_t) width * height, sizeof(color_t));
+    if (!pixels && width && height) {
+        return 0;
+    }
+    free(data.framebuffer.pixels);
+    data.framebuffer.pixels = pixels;
+    data.framebuffer.width = width;
+    data.framebuffer.height = height;
+    reset_viewport();
+    return 1;
+}
+
+int graphics_software_renderer_init(int width, int height)
+{
+    if (!resize_framebuffer(width, height)) {
+        return 0;
+    }
+    data.city_scale = 1.0f;
+    create_renderer_interface();
+    return 1;
+}
+
+void graphics_software_renderer_shutdown(void)
+{
+    for (atlas_type i = ATLAS_FIRST; i < ATLAS_MAX; i++) {
+        free_atlas(i);
+    }
+    for (int i = 0; i < CUSTOM_IMAGE_MAX; i++) {
+        free(data.custom_images[i].buffer);
+    }
+    memset(data.custom_images, 0, sizeof(data.custom_images));
+    for (int i = 0; i < MAX_UNPACKED_IMAGES; i++) {
+        free(data.unpacked_images[i].pixels);
+    }
+    memset(data.unpacked_images, 0, sizeof(data.unpacked_images));
+    free_saved_images();
+    free(data.columns.list);
+    data.columns.list = 0;
+    data.columns.size = 0;
+    free(data.framebuffer.pixels);
+    data.framebuffer.pixels = 0;
+    data.framebuffer.width = 0;
+    data.framebuffer.height = 0;
+    if (graphics_renderer() == &data.renderer_interface) {
+        graphics_renderer_set_interface(0);
+    }
+}
@@ -0,0 +1,28 @@
+#ifndef GRAPHICS_SOFTWARE_RENDERER_H
+#define GRAPHICS_SOFTWARE_RENDERER_H
+
+/**
+ * @file
+ * Renderer that draws into a framebuffer in memory, without a GPU or a display.
+ * The image atlases are kept as pixel buffers and the sprites are blended into the framebuffer on the CPU.
+ * Tooltips and YUV images are not supported.
+ *
+ * It only has the images that were loaded while it was the active renderer, so it cannot stand in
+ * for the GPU renderer of a running game: it is used by headless mode, which can draw the whole city
+ * to a file with it.
+ */
+
+/**
+ * Creates the framebuffer and makes the software renderer the active renderer
+ * @param width The width of the framebuffer
+ * @param height The height of the framebuffer
+ * @return Boolean true on success, false if there was not enough memory
+ */
+int graphics_software_renderer_init(int width, int height);
+
+/**
+ * Frees the framebuffer and every image held by the software renderer
+ */
+void graphics_software_renderer_shutdown(void);
+
+#endif // GRAPHICS_SOFTWARE_RENDERER_H
@@ -7,6 +7,7 @@
 
 static grid_u8 aqueduct;
 static grid_u8 aqueduct_backup;
+static grid_changes aqueduct_changes;
 
 int map_aqueduct_has_water_access_at(int grid_offset)
 {
@@ -21,16 +22,19 @@ int map_aqueduct_image_at(int grid_offset)
 void map_aqueduct_set_water_access(int grid_offset, int value)
 {
     aqueduct.items[grid_offset] = (value << WATER_ACCESS_OFFSET) | (aqueduct.items[grid_offset] & IMAGE_MASK);
+    map_grid_changes_add(&aqueduct_changes, grid_offset);
 }
 
 void map_aqueduct_set_image(int grid_offset, int value)
 {
     aqueduct.items[grid_offset] = (aqueduct.items[grid_offset] & ~IMAGE_MASK) | value;
+    map_grid_changes_add(&aqueduct_changes, grid_offset);
 }
 
 void map_aqueduct_remove(int grid_offset)
 {
     aqueduct.items[grid_offset] = 0;
+    map_grid_changes_add(&aqueduct_changes, grid_offset);
     if (map_aqueduct_image_at(grid_offset + map_grid_delta(0, -1)) == 5) {
         map_aqueduct_set_image(grid_offset + map_grid_delta(0, -1), 1);
     }
@@ -48,16 +52,18 @@ void map_aqueduct_remove(int grid_offset)
 void map_aqueduct_clear(void)
 {
     map_grid_clear_u8(aqueduct.items);
+    map_grid_changes_add_all(&aqueduct_changes);
 }
 
 void map_aqueduct_backup(void)
 {
     map_grid_copy_u8(aqueduct.items, aqueduct_backup.items);
+    map_grid_changes_clear(&aqueduct_changes);
 }
 
 void map_aqueduct_restore(void)
 {
-    map_grid_copy_u8(aqueduct_backup.items, aqueduct.items);
+    map_grid_restore_changes_u8(aqueduct_backup.items, aqueduct.items, &aqueduct_changes);
 }
 
 void map_aqueduct_save_state(buffer *buf, buffer *backup)
@@ -70,4 +76,5 @@ void map_aqueduct_load_state(buffer *buf, buffer *backup)
 {
     map_grid_load_state_u8(aqueduct.items, buf);
     map_grid_load_state_u8(aqueduct_backup.items, backup);
+    map_grid_changes_add_all(&aqueduct_changes);
 }
@@ -2,12 +2,23 @@
 
 #include "building/building.h"
 #include "core/config.h"
+#include "core/log.h"
 #include "map/grid.h"
 
+#include <string.h>
+
+#define NEARBY_RADIUS 2
+
 static grid_u16 buildings_grid;
 static grid_u8 damage_grid;
 static grid_u8 rubble_type_grid;
 
+static struct {
+    uint8_t is_valid[GRID_SIZE * GRID_SIZE];
+    uint8_t num_ids[GRID_SIZE * GRID_SIZE];
+    uint16_t ids[GRID_SIZE * GRID_SIZE][MAP_BUILDING_MAX_NEARBY];
+} nearby;
+
 int map_building_at(int grid_offset)
 {
     return map_grid_is_valid_offset(grid_offset) ? buildings_grid.items[grid_offset] : 0;
@@ -19,9 +30,78 @@ int map_building_from_buffer(buffer *buildings, int grid_offset)
     return buffer_read_u16(buildings);
 }
 
+static void invalidate_nearby(int grid_offset)
+{
+    for (int dy = -NEARBY_RADIUS; dy <= NEARBY_RADIUS; dy++) {
+        for (int dx = -NEARBY_RADIUS; dx <= NEARBY_RADIUS; dx++) {
+            int offset = grid_offset + map_grid_delta(dx, dy);
+            if (map_grid_is_valid_offset(offset)) {
+                nearby.is_valid[offset] = 0;
+            }
+        }
+    }
+}
+
+static void invalidate_all_nearby(void)
+{
+    memset(nearby.is_valid, 0, sizeof(nearby.is_valid));
+}
+
 void map_building_set(int grid_offset, int building_id)
 {
-    buildings_grid.items[grid_offset] = building_id;
+    if (buildings_grid.items[grid_offset] != building_id) {
+        buildings_grid.items[grid_offset] = building_id;
+        invalidate_nearby(grid_offset);
+    }
+}
+
+static int find_nearby(int x, int y, uint16_t *ids)
+{
+    int num_ids = 0;
+    int x_min, y_min, x_max, y_max;
+    map_grid_get_area(x, y, 1, NEARBY_RADIUS, &x_min, &y_min, &x_max, &y_max);
+    for (int yy = y_min; yy <= y_max; yy++) {
+        for (int xx = x_min; xx <= x_max; xx++) {
+            int building_id = map_building_at(map_grid_offset(xx, yy));
+            if (building_id) {
+                ids[num_ids++] = building_id;
+            }
+        }
+    }
+    return num_ids;
+}
+
+#ifdef VERIFY_INCREMENTAL_UPDATES
+static void verify_nearby(int x, int y, int grid_offset)
+{
+    uint16_t ids[MAP_BUILDING_MAX_NEARBY];
+    int num_ids = find_nearby(x, y, ids);
+    if (num_ids != nearby.num_ids[grid_offset] ||
+        memcmp(ids, nearby.ids[grid_offset], num_ids * sizeof(uint16_t)) != 0) {
+        log_error("Cached nearby buildings differ from the building grid at offset", 0, grid_offset);
+    }
+}
+#endif
+
+int map_building_get_nearby(int x, int y, const uint16_t **ids)
+{
+    if (!map_grid_is_inside(x, y, 1)) {
+        static uint16_t outside_ids[MAP_BUILDING_MAX_NEARBY];
+        *ids = outside_ids;
+        return find_nearby(x, y, outside_ids);
+    }
+    int grid_offset = map_grid_offset(x, y);
+    if (!nearby.is_valid[grid_offset]) {
+        nearby.num_ids[grid_offset] = find_nearby(x, y, nearby.ids[grid_offset]);
+        nearby.is_valid[grid_offset] = 1;
+    }
+#ifdef VERIFY_INCREMENTAL_UPDATES
+    else {
+        verify_nearby(x, y, grid_offset);
+    }
+#endif
+    *ids = nearby.ids[grid_offset];
+    return nearby.num_ids[grid_offset];
 }
 
 void map_building_damage_clear(int grid_offset)
@@ -49,6 +129,7 @@ void map_building_clear(void)
     map_grid_clear_u16(buildings_grid.items);
     map_grid_clear_u8(damage_grid.items);
     map_grid_clear_u8(rubble_type_grid.items);
+    invalidate_all_nearby();
 }
 
 void map_building_save_state(buffer *buildings, buffer *damage)
@@ -61,6 +142,7 @@ void map_building_load_state(buffer *buildings, buffer *damage)
 {
     map_grid_load_state_u16(buildings_grid.items, buildings);
     map_grid_load_state_u8(damage_grid.items, damage);
+    invalidate_all_nearby();
 }
 
 int map_building_is_reservoir(int x, int y)
@@ -4,6 +4,10 @@
 #include "building/type.h"
 #include "core/buffer.h"
 
+#include <stdint.h>
+
+#define MAP_BUILDING_MAX_NEARBY 25
+
 /**
  * Returns the building at the given offset
  * @param grid_offset Map offset
@@ -15,6 +19,17 @@ int map_building_from_buffer(buffer *buildings, int grid_offset);
 
 void map_building_set(int grid_offset, int building_id);
 
+/**
+ * Gets the buildings within two tiles of a tile, as used for service coverage.
+ * The list has one entry for every building tile, in the order of scanning the area row by row,
+ * and is cached until a building is added to or removed from the area.
+ * @param x X coordinate of the tile
+ * @param y Y coordinate of the tile
+ * @param ids Set to the list of building IDs, valid until the building grid changes
+ * @return The number of IDs in the list
+ */
+int map_building_get_nearby(int x, int y, const uint16_t **ids);
+
 /**
  * Increases building damage by 1
  * @param grid_offset Map offset
@@ -3,21 +3,100 @@
 #include "building/building.h"
 #include "building/model.h"
 #include "building/monument.h"
+#include "core/array.h"
 #include "core/calc.h"
+#include "core/log.h"
 #include "map/data.h"
 #include "map/grid.h"
 #include "map/property.h"
 #include "map/ring.h"
 #include "map/terrain.h"
 
+#include <string.h>
+
+#define MIN_DESIRABILITY -100
+#define MAX_DESIRABILITY 100
+#define MAX_DESIRABILITY_RANGE 6
+#define SOURCE_ARRAY_SIZE 500
+
+typedef struct {
+    int x;
+    int y;
+    int size;
+    int value;
+    int step;
+    int step_size;
+    int range;
+} desirability_source;
+
+typedef enum {
+    TERRAIN_SOURCE_NONE = 0,
+    TERRAIN_SOURCE_PLAZA = 1,
+    TERRAIN_SOURCE_EARTHQUAKE = 2,
+    TERRAIN_SOURCE_GARDEN = 3,
+    TERRAIN_SOURCE_RUBBLE = 4,
+    TERRAIN_SOURCE_HIGHWAY = 5
+} terrain_source;
+
 static grid_i8 desirability_grid;
 
+/**
+ * Each tile's desirability is kept as the sums of the positive and negative contributions it receives.
+ * As long as neither sum goes over the desirability bounds, adding the contributions one by one with
+ * clamping, as the full rebuild does, gives the same result as their total. Tiles where that is not the case
+ * depend on the order of the contributions and are only ever set by the full rebuild.
+ */
+static struct {
+    int has_sources;
+    grid_i16 positive;
+    grid_i16 negative;
+    grid_u8 changed;
+    int changed_offsets[GRID_SIZE * GRID_SIZE];
+    int num_changed;
+    array(desirability_source) buildings;
+    grid_u8 terrain;
+    int venus_gt;
+} incremental;
+
 void map_desirability_clear(void)
 {
     map_grid_clear_i8(desirability_grid.items);
+    incremental.has_sources = 0;
+}
+
+static void add_to_tile(int grid_offset, int desirability)
+{
+    desirability_grid.items[grid_offset] =
+        calc_bound(desirability_grid.items[grid_offset] + desirability, MIN_DESIRABILITY, MAX_DESIRABILITY);
 }
 
-static void add_desirability_at_distance(int x, int y, int size, int distance, int desirability)
+static void update_sums(int grid_offset, int desirability, int sign)
+{
+    if (desirability > 0) {
+        incremental.positive.items[grid_offset] += sign * desirability;
+    } else if (desirability < 0) {
+        incremental.negative.items[grid_offset] -= sign * desirability;
+    } else {
+        return;
+    }
+    if (!incremental.changed.items[grid_offset]) {
+        incremental.changed.items[grid_offset] = 1;
+        incremental.changed_offsets[incremental.num_changed++] = grid_offset;
+    }
+}
+
+static void add_to_sums(int grid_offset, int desirability)
+{
+    update_sums(grid_offset, desirability, 1);
+}
+
+static void remove_from_sums(int grid_offset, int desirability)
+{
+    update_sums(grid_offset, desirability, -1);
+}
+
+static void add_desirability_at_distance(int x, int y, int size, int distance, int desirability,
+    void (*add)(int grid_offset, int desirability))
 {
     int partially_outside_map = 0;
     if (x - distance < -1 || x + distance + size - 1 > map_data.width) {
@@ -34,171 +113,336 @@ static void add_desirability_at_distance(int x, int y, int size, int distance, i
         for (int i = start; i < end; i++) {
             const ring_tile *tile = map_ring_tile(i);
             if (map_ring_is_inside_map(x + tile->x, y + tile->y)) {
-                desirability_grid.items[base_offset + tile->grid_offset] =
-                    calc_bound(desirability_grid.items[base_offset + tile->grid_offset] + desirability, -100, 100);
+                add(base_offset + tile->grid_offset, desirability);
             }
         }
     } else {
         for (int i = start; i < end; i++) {
             const ring_tile *tile = map_ring_tile(i);
-            desirability_grid.items[base_offset + tile->grid_offset] =
-                calc_bound(desirability_grid.items[base_offset + tile->grid_offset] + desirability, -100, 100);
+            add(base_offset + tile->grid_offset, desirability);
         }
     }
 }
 
-static void add_to_terrain(int x, int y, int size, int desirability, int step, int step_size, int range)
+static void add_to_terrain(const desirability_source *source, void (*add)(int grid_offset, int desirability))
 {
-    if (size > 0) {
-        if (range > 6) {
-            range = 6;
+    if (source->size > 0) {
+        int desirability = source->value;
+        int range = source->range;
+        if (range > MAX_DESIRABILITY_RANGE) {
+            range = MAX_DESIRABILITY_RANGE;
         }
         int tiles_within_step = 0;
         int distance = 1;
         while (range > 0) {
-            add_desirability_at_distance(x, y, size, distance, desirability);
+            add_desirability_at_distance(source->x, source->y, source->size, distance, desirability, add);
             distance++;
             range--;
             tiles_within_step++;
-            if (tiles_within_step >= step) {
-                desirability += step_size;
+            if (tiles_within_step >= source->step) {
+                desirability += source->step_size;
                 tiles_within_step = 0;
             }
         }
     }
 }
 
-static void update_buildings(void)
+static void set_source(desirability_source *source, int x, int y, int size, int value, int step, int step_size,
+    int range)
 {
-    int value;
-    int value_bonus;
-    int step;
-    int step_size;
-    int range;
-    int venus_module2 = building_monument_gt_module_is_active(VENUS_MODULE_2_DESIRABILITY_ENTERTAINMENT);
-    int venus_gt = building_monument_working(BUILDING_GRAND_TEMPLE_VENUS);
-    for (int i = 1; i < building_count(); i++) {
-        building *b = building_get(i);
-        if (b->state == BUILDING_STATE_IN_USE) {
-
-            const model_building *model = model_get_building(b->type);
-            value = model->desirability_value;
-            step = model->desirability_step;
-            step_size = model->desirability_step_size;
-            range = model->desirability_range;
-
-            // Venus Module 2 House Desirability Bonus
-            if (building_is_house(b->type) && b->data.house.temple_venus && venus_module2) {
-                if (b->subtype.house_level >= HOUSE_SMALL_VILLA) {
-                    value += 4;
-                    range += 1;
-                } else if (b->subtype.house_level <= HOUSE_LARGE_TENT) {
-                    // tents normally confer -3, -2, -1, 0, 0, 0 (range=3)
-                    // now this becomes -1, 0, 0, 0, 0, 0 (range=1)
-                    value += 2;
-                    range = 1;
-                } else {
-                    if (range <= 1) {
-                        range = 1;
-                    }
-                    value += 2;
-                }
-            }
-
-            if (building_monument_is_monument(b) && b->monument.phase != MONUMENT_FINISHED) {
-                value = 0;
-                step = 0;
-                step_size = 0;
-                range = 0;
-            }
-
-            // Venus GT Base Bonus
-            if (building_is_statue_garden_temple(b->type) && venus_gt) {
-                value_bonus = ((value / 4) > 1) ? (value / 4) : 1;
-                value += value_bonus;
-                step += 1;
-                range += 1;
-            }
-
-            add_to_terrain(
-                b->x, b->y, b->size,
-                value,
-                step,
-                step_size,
-                range);
-        }
-    }
+    source->x = x;
+    source->y = y;
+    source->size = size;
+    source->value = value;
+    source->step = step;
+    source->step_size = step_size;
+    source->range = range;
 }
 
-static void add_garden_desirability(int x, int y)
+static int get_building_source(const building *b, int venus_module2, int venus_gt, desirability_source *source)
 {
-    const model_building *model = model_get_building(BUILDING_GARDENS);
-
+    memset(source, 0, sizeof(desirability_source));
+    if (b->state != BUILDING_STATE_IN_USE) {
+        return 0;
+    }
+    const model_building *model = model_get_building(b->type);
     int value = model->desirability_value;
     int step = model->desirability_step;
     int step_size = model->desirability_step_size;
     int range = model->desirability_range;
 
-    if (building_monument_working(BUILDING_GRAND_TEMPLE_VENUS)) {
+    // Venus Module 2 House Desirability Bonus
+    if (building_is_house(b->type) && b->data.house.temple_venus && venus_module2) {
+        if (b->subtype.house_level >= HOUSE_SMALL_VILLA) {
+            value += 4;
+            range += 1;
+        } else if (b->subtype.house_level <= HOUSE_LARGE_TENT) {
+            // tents normally confer -3, -2, -1, 0, 0, 0 (range=3)
+            // now this becomes -1, 0, 0, 0, 0, 0 (range=1)
+            value += 2;
+            range = 1;
+        } else {
+            if (range <= 1) {
+                range = 1;
+            }
+            value += 2;
+        }
+    }
+
+    if (building_monument_is_monument(b) && b->monument.phase != MONUMENT_FINISHED) {
+        value = 0;
+        step = 0;
+        step_size = 0;
+        range = 0;
+    }
+
+    // Venus GT Base Bonus
+    if (building_is_statue_garden_temple(b->type) && venus_gt) {
         int value_bonus = ((value / 4) > 1) ? (value / 4) : 1;
         value += value_bonus;
         step += 1;
         range += 1;
     }
 
-    add_to_terrain(x, y, 1, value, step, step_size, range);
+    set_source(source, b->x, b->y, b->size, value, step, step_size, range);
+    return 1;
+}
+
+static void update_buildings(void)
+{
+    int venus_module2 = building_monument_gt_module_is_active(VENUS_MODULE_2_DESIRABILITY_ENTERTAINMENT);
+    int venus_gt = building_monument_working(BUILDING_GRAND_TEMPLE_VENUS);
+    desirability_source source;
+    for (int i = 1; i < building_count(); i++) {
+        if (get_building_source(building_get(i), venus_module2, venus_gt, &source)) {
+            add_to_terrain(&source, add_to_tile);
+        }
+    }
+}
+
+static terrain_source get_terrain_source(int grid_offset)
+{
+    int terrain = map_terrain_get(grid_offset);
+    if (map_property_is_plaza_earthquake_or_overgrown_garden(grid_offset)) {
+        if (terrain & TERRAIN_ROAD) {
+            return TERRAIN_SOURCE_PLAZA;
+        } else if (terrain & TERRAIN_ROCK) {
+            return TERRAIN_SOURCE_EARTHQUAKE;
+        } else if (terrain & TERRAIN_GARDEN) {
+            return TERRAIN_SOURCE_GARDEN;
+        } else {
+            // invalid plaza/earthquake flag
+            map_property_clear_plaza_earthquake_or_overgrown_garden(grid_offset);
+            return TERRAIN_SOURCE_NONE;
+        }
+    } else if (terrain & TERRAIN_GARDEN) {
+        return TERRAIN_SOURCE_GARDEN;
+    } else if (terrain & TERRAIN_RUBBLE) {
+        return TERRAIN_SOURCE_RUBBLE;
+    } else if (terrain & TERRAIN_HIGHWAY) {
+        return TERRAIN_SOURCE_HIGHWAY;
+    }
+    return TERRAIN_SOURCE_NONE;
+}
+
+static void set_model_source(desirability_source *source, int x, int y, building_type type)
+{
+    const model_building *model = model_get_building(type);
+    set_source(source, x, y, 1,
+        model->desirability_value,
+        model->desirability_step,
+        model->desirability_step_size,
+        model->desirability_range);
+}
+
+static int get_source_for_terrain(terrain_source type, int x, int y, int venus_gt, desirability_source *source)
+{
+    switch (type) {
+        case TERRAIN_SOURCE_PLAZA:
+            set_model_source(source, x, y, BUILDING_PLAZA);
+            return 1;
+        case TERRAIN_SOURCE_EARTHQUAKE:
+            // earthquake fault line: slight negative
+            set_model_source(source, x, y, BUILDING_HOUSE_VACANT_LOT);
+            return 1;
+        case TERRAIN_SOURCE_GARDEN:
+            set_model_source(source, x, y, BUILDING_GARDENS);
+            if (venus_gt) {
+                int value_bonus = ((source->value / 4) > 1) ? (source->value / 4) : 1;
+                source->value += value_bonus;
+                source->step += 1;
+                source->range += 1;
+            }
+            return 1;
+        case TERRAIN_SOURCE_RUBBLE:
+            set_source(source, x, y, 1, -2, 1, 1, 2);
+            return 1;
+        case TERRAIN_SOURCE_HIGHWAY:
+            set_model_source(source, x, y, BUILDING_HIGHWAY);
+            return 1;
+        default:
+            return 0;
+    }
 }
 
 static void update_terrain(void)
 {
+    int venus_gt = building_monument_working(BUILDING_GRAND_TEMPLE_VENUS);
+    desirability_source source;
     int grid_offset = map_data.start_offset;
     for (int y = 0; y < map_data.height; y++, grid_offset += map_data.border_size) {
         for (int x = 0; x < map_data.width; x++, grid_offset++) {
-            int terrain = map_terrain_get(grid_offset);
-            if (map_property_is_plaza_earthquake_or_overgrown_garden(grid_offset)) {
-                int type;
-                if (terrain & TERRAIN_ROAD) {
-                    type = BUILDING_PLAZA;
-                } else if (terrain & TERRAIN_ROCK) {
-                    // earthquake fault line: slight negative
-                    type = BUILDING_HOUSE_VACANT_LOT;
-                } else if (terrain & TERRAIN_GARDEN) {
-                    add_garden_desirability(x, y);
-                    continue;
-                } else {
-                    // invalid plaza/earthquake flag
-                    map_property_clear_plaza_earthquake_or_overgrown_garden(grid_offset);
-                    continue;
-                }
-                const model_building *model = model_get_building(type);
-                add_to_terrain(x, y, 1,
-                    model->desirability_value,
-                    model->desirability_step,
-                    model->desirability_step_size,
-                    model->desirability_range);
-            } else if (terrain & TERRAIN_GARDEN) {
-                add_garden_desirability(x, y);
-            } else if (terrain & TERRAIN_RUBBLE) {
-                add_to_terrain(x, y, 1, -2, 1, 1, 2);
-            } else if (terrain & TERRAIN_HIGHWAY) {
-                const model_building *model = model_get_building(BUILDING_HIGHWAY);
-                add_to_terrain(x, y, 1,
-                    model->desirability_value,
-                    model->desirability_step,
-                    model->desirability_step_size,
-                    model->desirability_range);
+            if (get_source_for_terrain(get_terrain_source(grid_offset), x, y, venus_gt, &source)) {
+                add_to_terrain(&source, add_to_tile);
             }
         }
     }
 }
 
-void map_desirability_update(void)
+static void rebuild(void)
 {
-    map_desirability_clear();
+    map_grid_clear_i8(desirability_grid.items);
     update_buildings();
     update_terrain();
 }
 
+static void clear_changed_tiles(void)
+{
+    for (int i = 0; i < incremental.num_changed; i++) {
+        incremental.changed.items[incremental.changed_offsets[i]] = 0;
+    }
+    incremental.num_changed = 0;
+}
+
+static int update_building_sources(void)
+{
+    int venus_module2 = building_monument_gt_module_is_active(VENUS_MODULE_2_DESIRABILITY_ENTERTAINMENT);
+    int venus_gt = building_monument_working(BUILDING_GRAND_TEMPLE_VENUS);
+    unsigned int total = building_count();
+    if (incremental.buildings.size > total) {
+        total = incremental.buildings.size;
+    }
+    while (incremental.buildings.size < total) {
+        if (!array_advance(incremental.buildings)) {
+            return 0;
+        }
+    }
+    desirability_source source;
+    for (unsigned int i = 1; i < total; i++) {
+        desirability_source *applied = array_item(incremental.buildings, i);
+        if (i < (unsigned int) building_count()) {
+            get_building_source(building_get(i), venus_module2, venus_gt, &source);
+        } else {
+            memset(&source, 0, sizeof(desirability_source));
+        }
+        if (memcmp(&source, applied, sizeof(desirability_source)) != 0) {
+            add_to_terrain(applied, remove_from_sums);
+            add_to_terrain(&source, add_to_sums);
+            *applied = source;
+        }
+    }
+    return 1;
+}
+
+static void update_terrain_sources(void)
+{
+    int venus_gt = building_monument_working(BUILDING_GRAND_TEMPLE_VENUS);
+    int venus_gt_changed = venus_gt != incremental.venus_gt;
+    desirability_source source;
+    int grid_offset = map_data.start_offset;
+    for (int y = 0; y < map_data.height; y++, grid_offset += map_data.border_size) {
+        for (int x = 0; x < map_data.width; x++, grid_offset++) {
+            terrain_source type = get_terrain_source(grid_offset);
+            terrain_source applied_type = incremental.terrain.items[grid_offset];
+            if (type == applied_type && (type != TERRAIN_SOURCE_GARDEN || !venus_gt_changed)) {
+                continue;
+            }
+            if (get_source_for_terrain(applied_type, x, y, incremental.venus_gt, &source)) {
+                add_to_terrain(&source, remove_from_sums);
+            }
+            if (get_source_for_terrain(type, x, y, venus_gt, &source)) {
+                add_to_terrain(&source, add_to_sums);
+            }
+            incremental.terrain.items[grid_offset] = type;
+        }
+    }
+    incremental.venus_gt = venus_gt;
+}
+
+static int reset_sources(void)
+{
+    map_grid_clear_i16(incremental.positive.items);
+    map_grid_clear_i16(incremental.negative.items);
+    map_grid_clear_u8(incremental.terrain.items);
+    incremental.venus_gt = 0;
+    return array_init(incremental.buildings, SOURCE_ARRAY_SIZE, 0, 0) && array_advance(incremental.buildings);
+}
+
+#ifdef VERIFY_INCREMENTAL_UPDATES
+static void verify_incremental_update(void)
+{
+    static grid_i8 incremental_grid;
+    memcpy(incremental_grid.items, desirability_grid.items, sizeof(desirability_grid.items));
+    rebuild();
+    int mismatches = 0;
+    for (int i = 0; i < GRID_SIZE * GRID_SIZE; i++) {
+        if (incremental_grid.items[i] != desirability_grid.items[i]) {
+            if (!mismatches) {
+                log_error("Incremental desirability differs from the full rebuild at offset", 0, i);
+            }
+            mismatches++;
+        }
+    }
+    if (mismatches) {
+        log_error("Number of tiles with mismatched desirability:", 0, mismatches);
+    }
+}
+#endif
+
+static int update_incrementally(void)
+{
+    if (!incremental.has_sources) {
+        if (!reset_sources()) {
+            log_error("Unable to allocate desirability sources, falling back to full rebuilds", 0, 0);
+            return 0;
+        }
+        incremental.has_sources = 1;
+    }
+    if (!update_building_sources()) {
+        log_error("Unable to allocate desirability sources, falling back to full rebuilds", 0, 0);
+        incremental.has_sources = 0;
+        return 0;
+    }
+    update_terrain_sources();
+
+    int depends_on_order = 0;
+    for (int i = 0; i < incremental.num_changed; i++) {
+        int grid_offset = incremental.changed_offsets[i];
+        int positive = incremental.positive.items[grid_offset];
+        int negative = incremental.negative.items[grid_offset];
+        if (positive > MAX_DESIRABILITY || negative > -MIN_DESIRABILITY) {
+            depends_on_order = 1;
+            break;
+        }
+        desirability_grid.items[grid_offset] = positive - negative;
+    }
+    clear_changed_tiles();
+    return !depends_on_order;
+}
+
+void map_desirability_update(void)
+{
+    // The first update after a reset only gathers the sources: the grid still needs a full rebuild
+    int had_sources = incremental.has_sources;
+    if (!update_incrementally() || !had_sources) {
+        rebuild();
+        return;
+    }
+#ifdef VERIFY_INCREMENTAL_UPDATES
+    verify_incremental_update();
+#endif
+}
+
 int map_desirability_get(int grid_offset)
 {
     return desirability_grid.items[grid_offset];
@@ -229,4 +473,5 @@ void map_desirability_save_state(buffer *buf)
 void map_desirability_load_state(buffer *buf)
 {
     map_grid_load_state_i8(desirability_grid.items, buf);
+    incremental.has_sources = 0;
 }
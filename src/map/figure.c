@@ -1,9 +1,117 @@
 #include "figure.h"
 
+#include "core/array.h"
 #include "map/grid.h"
 
+#include <string.h>
+
+#define CHUNK_SIZE_SHIFT 3
+#define CHUNK_SIZE (1 << CHUNK_SIZE_SHIFT)
+#define CHUNKS_PER_SIDE (256 / CHUNK_SIZE)
+#define MAX_COORDINATE 255
+#define LOCATION_ARRAY_SIZE_STEP 1000
+
+typedef struct {
+    int chunk; // chunk index + 1, 0 when the figure is not in the index
+    int prev_figure_id;
+    int next_figure_id;
+} figure_location;
+
 static grid_u16 figures;
 
+/**
+ * Coarse index of figures by position, used to find figures near a tile without going through
+ * the whole figure list. It only depends on the figure's x and y, so it also holds figures outside
+ * the map, and figures stay in it when they are removed from the tile grid to be placed again.
+ */
+static struct {
+    int valid;
+    int first_figure_id[CHUNKS_PER_SIDE * CHUNKS_PER_SIDE];
+    array(figure_location) locations;
+} chunks;
+
+static int get_chunk(int x, int y)
+{
+    return (y >> CHUNK_SIZE_SHIFT) * CHUNKS_PER_SIDE + (x >> CHUNK_SIZE_SHIFT);
+}
+
+static figure_location *get_location(int figure_id)
+{
+    while (chunks.locations.size <= (unsigned int) figure_id) {
+        if (!array_advance(chunks.locations)) {
+            chunks.valid = 0;
+            return 0;
+        }
+    }
+    return array_item(chunks.locations, figure_id);
+}
+
+static void remove_from_chunk(int figure_id, figure_location *location)
+{
+    if (location->prev_figure_id) {
+        array_item(chunks.locations, location->prev_figure_id)->next_figure_id = location->next_figure_id;
+    } else {
+        chunks.first_figure_id[location->chunk - 1] = location->next_figure_id;
+    }
+    if (location->next_figure_id) {
+        array_item(chunks.locations, location->next_figure_id)->prev_figure_id = location->prev_figure_id;
+    }
+    location->chunk = 0;
+    location->prev_figure_id = 0;
+    location->next_figure_id = 0;
+}
+
+static void place_in_chunk(const figure *f)
+{
+    if (!chunks.valid || f->id <= 0) {
+        return;
+    }
+    figure_location *location = get_location(f->id);
+    if (!location) {
+        return;
+    }
+    int chunk = get_chunk(f->x, f->y);
+    if (location->chunk == chunk + 1) {
+        return;
+    }
+    if (location->chunk) {
+        remove_from_chunk(f->id, location);
+    }
+    location->chunk = chunk + 1;
+    location->next_figure_id = chunks.first_figure_id[chunk];
+    if (location->next_figure_id) {
+        array_item(chunks.locations, location->next_figure_id)->prev_figure_id = f->id;
+    }
+    chunks.first_figure_id[chunk] = f->id;
+}
+
+static void remove_from_chunks(const figure *f)
+{
+    if (!chunks.valid || f->id <= 0 || (unsigned int) f->id >= chunks.locations.size) {
+        return;
+    }
+    figure_location *location = array_item(chunks.locations, f->id);
+    if (location->chunk) {
+        remove_from_chunk(f->id, location);
+    }
+}
+
+static void rebuild_chunks(void)
+{
+    memset(chunks.first_figure_id, 0, sizeof(chunks.first_figure_id));
+    if (!array_init(chunks.locations, LOCATION_ARRAY_SIZE_STEP, 0, 0)) {
+        chunks.valid = 0;
+        return;
+    }
+    chunks.valid = 1;
+    for (int i = 1; i < figure_count(); i++) {
+        figure *f = figure_get(i);
+        if (f->state == FIGURE_STATE_ALIVE) {
+            place_in_chunk(f);
+        }
+    }
+}
+
 int map_has_figure_at(int grid_offset)
 {
     return map_grid_is_valid_offset(grid_offset) && figures.items[grid_offset] > 0;
@@ -23,6 +131,7 @@ static void cap_figures_on_same_tile_index(figure *f)
 
 void map_figure_add(figure *f)
 {
+    place_in_chunk(f);
     if (!map_grid_is_valid_offset(f->grid_offset)) {
         return;
     }
@@ -45,6 +154,7 @@ void map_figure_add(figure *f)
 
 void map_figure_update(figure *f)
 {
+    place_in_chunk(f);
     if (!map_grid_is_valid_offset(f->grid_offset)) {
         return;
     }
@@ -64,6 +174,9 @@ void map_figure_update(figure *f)
 
 void map_figure_delete(figure *f)
 {
+    if (f->state != FIGURE_STATE_ALIVE) {
+        remove_from_chunks(f);
+    }
     if (!map_grid_is_valid_offset(f->grid_offset) || !figures.items[f->grid_offset]) {
         f->next_figure_id_on_same_tile = 0;
         return;
@@ -96,9 +209,41 @@ int map_figure_foreach_until(int grid_offset, int (*callback)(figure *f))
     return 0;
 }
 
+void map_figure_foreach_in_range(int x, int y, int distance, void (*callback)(figure *f))
+{
+    if (!chunks.valid) {
+        rebuild_chunks();
+        if (!chunks.valid) {
+            for (int i = 1; i < figure_count(); i++) {
+                callback(figure_get(i));
+            }
+            return;
+        }
+    }
+    int min_x = x - distance < 0 ? 0 : x - distance;
+    int min_y = y - distance < 0 ? 0 : y - distance;
+    int max_x = x + distance > MAX_COORDINATE ? MAX_COORDINATE : x + distance;
+    int max_y = y + distance > MAX_COORDINATE ? MAX_COORDINATE : y + distance;
+    if (min_x > max_x || min_y > max_y) {
+        return;
+    }
+    for (int chunk_y = min_y >> CHUNK_SIZE_SHIFT; chunk_y <= max_y >> CHUNK_SIZE_SHIFT; chunk_y++) {
+        for (int chunk_x = min_x >> CHUNK_SIZE_SHIFT; chunk_x <= max_x >> CHUNK_SIZE_SHIFT; chunk_x++) {
+            int figure_id = chunks.first_figure_id[chunk_y * CHUNKS_PER_SIDE + chunk_x];
+            while (figure_id) {
+                // Fetch the next figure first, in case the callback changes the current one
+                int next_figure_id = array_item(chunks.locations, figure_id)->next_figure_id;
+                callback(figure_get(figure_id));
+                figure_id = next_figure_id;
+            }
+        }
+    }
+}
+
 void map_figure_clear(void)
 {
     map_grid_clear_u16(figures.items);
+    chunks.valid = 0;
 }
 
 void map_figure_save_state(buffer *buf)
@@ -109,4 +254,5 @@ void map_figure_save_state(buffer *buf)
 void map_figure_load_state(buffer *buf)
 {
     map_grid_load_state_u16(figures.items, buf);
+    chunks.valid = 0;
 }
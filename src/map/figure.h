@@ -26,6 +26,16 @@ void map_figure_delete(figure *f);
 
 int map_figure_foreach_until(int grid_offset, int (*callback)(figure *f));
 
+/**
+ * Calls the callback for every figure that is at most the given distance away from a tile.
+ * Figures slightly further away may also be passed, and dead figures are not filtered out.
+ * @param x X coordinate of the tile
+ * @param y Y coordinate of the tile
+ * @param distance The maximum distance of the figures
+ * @param callback The function to call for each figure
+ */
+void map_figure_foreach_in_range(int x, int y, int distance, void (*callback)(figure *f));
+
 /**
  * Clears the map
  */
@@ -258,6 +258,101 @@ void map_grid_copy_u32(const uint32_t *src, uint32_t *dst)
     memcpy(dst, src, GRID_SIZE * GRID_SIZE * sizeof(uint32_t));
 }
 
+void map_grid_changes_clear(grid_changes *changes)
+{
+    if (changes->all_changed) {
+        memset(changes->is_changed, 0, sizeof(changes->is_changed));
+    } else {
+        for (int i = 0; i < changes->num_changed; i++) {
+            changes->is_changed[changes->offsets[i]] = 0;
+        }
+    }
+    changes->all_changed = 0;
+    changes->num_changed = 0;
+}
+
+void map_grid_changes_add(grid_changes *changes, int grid_offset)
+{
+    if (!changes->all_changed && !changes->is_changed[grid_offset]) {
+        changes->is_changed[grid_offset] = 1;
+        changes->offsets[changes->num_changed++] = (uint16_t) grid_offset;
+    }
+}
+
+void map_grid_changes_add_all(grid_changes *changes)
+{
+    changes->all_changed = 1;
+}
+
+void map_grid_and_tracked_u8(uint8_t *grid, uint8_t mask, grid_changes *changes)
+{
+    for (int i = 0; i < GRID_SIZE * GRID_SIZE; i++) {
+        if (grid[i] & ~mask) {
+            grid[i] &= mask;
+            map_grid_changes_add(changes, i);
+        }
+    }
+}
+
+void map_grid_and_tracked_u32(uint32_t *grid, uint32_t mask, grid_changes *changes)
+{
+    for (int i = 0; i < GRID_SIZE * GRID_SIZE; i++) {
+        if (grid[i] & ~mask) {
+            grid[i] &= mask;
+            map_grid_changes_add(changes, i);
+        }
+    }
+}
+
+void map_grid_restore_changes_u8(const uint8_t *backup, uint8_t *grid, grid_changes *changes)
+{
+    if (changes->all_changed) {
+        map_grid_copy_u8(backup, grid);
+    } else {
+        for (int i = 0; i < changes->num_changed; i++) {
+            int grid_offset = changes->offsets[i];
+            grid[grid_offset] = backup[grid_offset];
+        }
+    }
+    map_grid_changes_clear(changes);
+}
+
+void map_grid_restore_changes_u32(const uint32_t *backup, uint32_t *grid, grid_changes *changes,
+    int (*should_restore)(int grid_offset))
+{
+    if (!should_restore) {
+        if (changes->all_changed) {
+            map_grid_copy_u32(backup, grid);
+        } else {
+            for (int i = 0; i < changes->num_changed; i++) {
+                int grid_offset = changes->offsets[i];
+                grid[grid_offset] = backup[grid_offset];
+            }
+        }
+        map_grid_changes_clear(changes);
+        return;
+    }
+    if (changes->all_changed) {
+        for (int i = 0; i < GRID_SIZE * GRID_SIZE; i++) {
+            if (should_restore(i)) {
+                grid[i] = backup[i];
+            }
+        }
+        return;
+    }
+    int num_kept = 0;
+    for (int i = 0; i < changes->num_changed; i++) {
+        int grid_offset = changes->offsets[i];
+        if (should_restore(grid_offset)) {
+            grid[grid_offset] = backup[grid_offset];
+            changes->is_changed[grid_offset] = 0;
+        } else {
+            changes->offsets[num_kept++] = (uint16_t) grid_offset;
+        }
+    }
+    changes->num_changed = num_kept;
+}
+
 void map_grid_save_state_u8(const uint8_t *grid, buffer *buf)
 {
     buffer_write_raw(buf, grid, GRID_SIZE * GRID_SIZE);
@@ -29,6 +29,16 @@ typedef struct {
     uint32_t items[GRID_SIZE * GRID_SIZE];
 } grid_u32;
 
+/**
+ * Tiles of a grid that changed since its last backup, so restoring the backup only needs to copy those
+ */
+typedef struct {
+    int all_changed;
+    int num_changed;
+    uint16_t offsets[GRID_SIZE * GRID_SIZE];
+    uint8_t is_changed[GRID_SIZE * GRID_SIZE];
+} grid_changes;
+
 void map_grid_init(int width, int height, int start_offset, int border_size);
 
 int map_grid_is_valid_offset(int grid_offset);
@@ -93,6 +103,29 @@ void map_grid_copy_u16(const uint16_t *src, uint16_t *dst);
 
 void map_grid_copy_u32(const uint32_t *src, uint32_t *dst);
 
+void map_grid_changes_clear(grid_changes *changes);
+
+void map_grid_changes_add(grid_changes *changes, int grid_offset);
+
+void map_grid_changes_add_all(grid_changes *changes);
+
+void map_grid_and_tracked_u8(uint8_t *grid, uint8_t mask, grid_changes *changes);
+
+void map_grid_and_tracked_u32(uint32_t *grid, uint32_t mask, grid_changes *changes);
+
+/**
+ * Copies the changed tiles back from the backup and clears the changes
+ */
+void map_grid_restore_changes_u8(const uint8_t *backup, uint8_t *grid, grid_changes *changes);
+
+/**
+ * Copies the changed tiles back from the backup.
+ * Tiles for which should_restore returns false are left alone and stay marked as changed.
+ * @param should_restore Function that decides whether a tile is restored, or 0 to restore all tiles
+ */
+void map_grid_restore_changes_u32(const uint32_t *backup, uint32_t *grid, grid_changes *changes,
+    int (*should_restore)(int grid_offset));
+
 
 void map_grid_save_state_u8(const uint8_t *grid, buffer *buf);
 
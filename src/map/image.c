@@ -12,6 +12,7 @@
 
 static grid_u32 images;
 static grid_u32 images_backup;
+static grid_changes image_changes;
 
 unsigned int map_image_at(int grid_offset)
 {
@@ -21,26 +22,29 @@ unsigned int map_image_at(int grid_offset)
 void map_image_set(int grid_offset, int image_id)
 {
     images.items[grid_offset] = image_id;
+    map_grid_changes_add(&image_changes, grid_offset);
 }
 
 void map_image_backup(void)
 {
     map_grid_copy_u32(images.items, images_backup.items);
+    map_grid_changes_clear(&image_changes);
 }
 
 void map_image_restore(void)
 {
-    map_grid_copy_u32(images_backup.items, images.items);
+    map_grid_restore_changes_u32(images_backup.items, images.items, &image_changes, 0);
 }
 
-void map_image_restore_at(int grid_offset)
+void map_image_restore_where(int (*should_restore)(int grid_offset))
 {
-    images.items[grid_offset] = images_backup.items[grid_offset];
+    map_grid_restore_changes_u32(images_backup.items, images.items, &image_changes, should_restore);
 }
 
 void map_image_clear(void)
 {
     map_grid_clear_u32(images.items);
+    map_grid_changes_add_all(&image_changes);
 }
 
 void map_image_init_edges(void)
@@ -48,14 +52,14 @@ void map_image_init_edges(void)
     int width, height;
     map_grid_size(&width, &height);
     for (int x = 1; x < width; x++) {
-        images.items[map_grid_offset(x, height)] = 1;
+        map_image_set(map_grid_offset(x, height), 1);
     }
     for (int y = 1; y < height; y++) {
-        images.items[map_grid_offset(width, y)] = 2;
+        map_image_set(map_grid_offset(width, y), 2);
     }
-    images.items[map_grid_offset(0, height)] = 3;
-    images.items[map_grid_offset(width, 0)] = 4;
-    images.items[map_grid_offset(width, height)] = 5;
+    map_image_set(map_grid_offset(0, height), 3);
+    map_image_set(map_grid_offset(width, 0), 4);
+    map_image_set(map_grid_offset(width, height), 5);
 }
 
 void map_image_update_all(void)
@@ -89,4 +93,5 @@ void map_image_save_state_legacy(buffer *buf)
 void map_image_load_state_legacy(buffer *buf)
 {
     map_grid_load_state_u16_to_u32(images.items, buf);
+    map_grid_changes_add_all(&image_changes);
 }
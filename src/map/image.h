@@ -11,7 +11,11 @@ void map_image_backup(void);
 
 void map_image_restore(void);
 
-void map_image_restore_at(int grid_offset);
+/**
+ * Restores the backed up images of the changed tiles that pass the given check
+ * @param should_restore Function that returns whether the image of a tile should be restored
+ */
+void map_image_restore_where(int (*should_restore)(int grid_offset));
 
 void map_image_clear(void);
 void map_image_init_edges(void);
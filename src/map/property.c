@@ -35,6 +35,9 @@ static grid_u8 bitfields_grid;
 static grid_u8 edge_backup;
 static grid_u8 bitfields_backup;
 
+static grid_changes edge_changes;
+static grid_changes bitfields_changes;
+
 static int edge_for(int x, int y)
 {
     return 8 * y + x;
@@ -54,11 +57,13 @@ int map_property_is_draw_tile_from_buffer(buffer *edge, int grid_offset)
 void map_property_mark_draw_tile(int grid_offset)
 {
     edge_grid.items[grid_offset] |= EDGE_LEFTMOST_TILE;
+    map_grid_changes_add(&edge_changes, grid_offset);
 }
 
 void map_property_clear_draw_tile(int grid_offset)
 {
     edge_grid.items[grid_offset] &= ~EDGE_LEFTMOST_TILE;
+    map_grid_changes_add(&edge_changes, grid_offset);
 }
 
 int map_property_is_native_land(int grid_offset)
@@ -69,11 +74,12 @@ int map_property_is_native_land(int grid_offset)
 void map_property_mark_native_land(int grid_offset)
 {
     edge_grid.items[grid_offset] |= EDGE_NATIVE_LAND;
+    map_grid_changes_add(&edge_changes, grid_offset);
 }
 
 void map_property_clear_all_native_land(void)
 {
-    map_grid_and_u8(edge_grid.items, EDGE_NO_NATIVE_LAND);
+    map_grid_and_tracked_u8(edge_grid.items, EDGE_NO_NATIVE_LAND, &edge_changes);
 }
 
 int map_property_multi_tile_xy(int grid_offset)
@@ -103,12 +109,14 @@ void map_property_set_multi_tile_xy(int grid_offset, int x, int y, int is_draw_t
     } else {
         edge_grid.items[grid_offset] = edge_for(x, y);
     }
+    map_grid_changes_add(&edge_changes, grid_offset);
 }
 
 void map_property_clear_multi_tile_xy(int grid_offset)
 {
     // only keep native land marker
     edge_grid.items[grid_offset] &= EDGE_NATIVE_LAND;
+    map_grid_changes_add(&edge_changes, grid_offset);
 }
 
 int map_property_multi_tile_size(int grid_offset)
@@ -147,6 +155,7 @@ void map_property_set_multi_tile_size(int grid_offset, int size)
         case 7: bitfields_grid.items[grid_offset] |= BIT_SIZE7; break;
 
     }
+    map_grid_changes_add(&bitfields_changes, grid_offset);
 }
 
 void map_property_init_alternate_terrain(void)
@@ -158,6 +167,7 @@ void map_property_init_alternate_terrain(void)
             int grid_offset = map_grid_offset(x, y);
             if (map_random_get(grid_offset) & 1) {
                 bitfields_grid.items[grid_offset] |= BIT_ALTERNATE_TERRAIN;
+                map_grid_changes_add(&bitfields_changes, grid_offset);
             }
         }
     }
@@ -176,11 +186,13 @@ int map_property_is_plaza_earthquake_or_overgrown_garden(int grid_offset)
 void map_property_mark_plaza_earthquake_or_overgrown_garden(int grid_offset)
 {
     bitfields_grid.items[grid_offset] |= BIT_PLAZA_EARTHQUAKE_OR_OVERGROWN_GARDEN;
+    map_grid_changes_add(&bitfields_changes, grid_offset);
 }
 
 void map_property_clear_plaza_earthquake_or_overgrown_garden(int grid_offset)
 {
     bitfields_grid.items[grid_offset] &= BIT_NO_PLAZA;
+    map_grid_changes_add(&bitfields_changes, grid_offset);
 }
 
 int map_property_is_constructing(int grid_offset)
@@ -191,11 +203,13 @@ int map_property_is_constructing(int grid_offset)
 void map_property_mark_constructing(int grid_offset)
 {
     bitfields_grid.items[grid_offset] |= BIT_CONSTRUCTION;
+    map_grid_changes_add(&bitfields_changes, grid_offset);
 }
 
 void map_property_clear_constructing(int grid_offset)
 {
     bitfields_grid.items[grid_offset] &= BIT_NO_CONSTRUCTION;
+    map_grid_changes_add(&bitfields_changes, grid_offset);
 }
 
 int map_property_is_deleted(int grid_offset)
@@ -206,34 +220,40 @@ int map_property_is_deleted(int grid_offset)
 void map_property_mark_deleted(int grid_offset)
 {
     bitfields_grid.items[grid_offset] |= BIT_DELETED;
+    map_grid_changes_add(&bitfields_changes, grid_offset);
 }
 
 void map_property_clear_deleted(int grid_offset)
 {
     bitfields_grid.items[grid_offset] &= BIT_NO_DELETED;
+    map_grid_changes_add(&bitfields_changes, grid_offset);
 }
 
 void map_property_clear_constructing_and_deleted(void)
 {
-    map_grid_and_u8(bitfields_grid.items, BIT_NO_CONSTRUCTION_AND_DELETED);
+    map_grid_and_tracked_u8(bitfields_grid.items, BIT_NO_CONSTRUCTION_AND_DELETED, &bitfields_changes);
 }
 
 void map_property_clear(void)
 {
     map_grid_clear_u8(bitfields_grid.items);
     map_grid_clear_u8(edge_grid.items);
+    map_grid_changes_add_all(&bitfields_changes);
+    map_grid_changes_add_all(&edge_changes);
 }
 
 void map_property_backup(void)
 {
     map_grid_copy_u8(bitfields_grid.items, bitfields_backup.items);
     map_grid_copy_u8(edge_grid.items, edge_backup.items);
+    map_grid_changes_clear(&bitfields_changes);
+    map_grid_changes_clear(&edge_changes);
 }
 
 void map_property_restore(void)
 {
-    map_grid_copy_u8(bitfields_backup.items, bitfields_grid.items);
-    map_grid_copy_u8(edge_backup.items, edge_grid.items);
+    map_grid_restore_changes_u8(bitfields_backup.items, bitfields_grid.items, &bitfields_changes);
+    map_grid_restore_changes_u8(edge_backup.items, edge_grid.items, &edge_changes);
 }
 
 void map_property_save_state(buffer *bitfields, buffer *edge)
@@ -246,4 +266,6 @@ void map_property_load_state(buffer *bitfields, buffer *edge)
 {
     map_grid_load_state_u8(bitfields_grid.items, bitfields);
     map_grid_load_state_u8(edge_grid.items, edge);
+    map_grid_changes_add_all(&bitfields_changes);
+    map_grid_changes_add_all(&edge_changes);
 }
@@ -6,9 +6,8 @@
 #include "map/routing_terrain.h"
 #include "map/terrain.h"
 
-#include <string.h>
-
-#define MAX_QUEUE 1000
+// Tiles are marked before they are queued, so each tile is queued at most once
+#define MAX_QUEUE (GRID_SIZE * GRID_SIZE)
 
 static const int ADJACENT_OFFSETS[] = {-GRID_SIZE, 1, GRID_SIZE, -1};
 
@@ -20,9 +19,21 @@ static struct {
     int tail;
 } queue;
 
+static struct {
+    int is_current;
+    int routing_generation;
+} labels;
+
+static void mark_labels_current(void)
+{
+    labels.is_current = 1;
+    labels.routing_generation = map_routing_land_citizen_generation();
+}
+
 void map_road_network_clear(void)
 {
     map_grid_clear_u8(network.items);
+    mark_labels_current();
 }
 
 int map_road_network_get(int grid_offset)
@@ -32,7 +43,8 @@ int map_road_network_get(int grid_offset)
 
 static int mark_road_network(int grid_offset, uint8_t network_id)
 {
-    memset(&queue, 0, sizeof(queue));
+    queue.head = 0;
+    queue.tail = 0;
     int guard = 0;
     int next_offset;
     int size = 1;
@@ -79,6 +91,11 @@ static int mark_road_network(int grid_offset, uint8_t network_id)
 
 void map_road_network_update(void)
 {
+    // Road networks follow the citizen routing grid: only relabel them when it has changed
+    if (labels.is_current && labels.routing_generation == map_routing_land_citizen_generation()) {
+        return;
+    }
+    mark_labels_current();
     city_map_clear_largest_road_networks();
     map_grid_clear_u8(network.items);
     int network_id = 1;
@@ -3,8 +3,16 @@
 
 void map_road_network_clear(void);
 
+/**
+ * Gets the road network at the given tile, as of the last relabelling
+ * @param grid_offset The tile to check
+ * @return The road network ID, or 0 if the tile isn't part of a road network
+ */
 int map_road_network_get(int grid_offset);
 
+/**
+ * Relabels the road networks if the citizen routing grid has changed since the last update
+ */
 void map_road_network_update(void);
 
 #endif // MAP_ROAD_NETWORK_H
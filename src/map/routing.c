@@ -50,6 +50,10 @@ static struct {
     int items[MAX_QUEUE];
 } queue;
 
+// Position of each grid offset inside the ordered queue, used to reduce a queued offset's distance in O(log n).
+// Only valid for offsets currently in the ordered queue, so it never needs clearing.
+static grid_u16 queue_position;
+
 static grid_u8 water_drag;
 
 static struct {
@@ -108,11 +112,17 @@ static inline int ordered_queue_parent(int index)
     return (index - 1) / 2;
 }
 
+static inline void ordered_queue_set(int index, int offset)
+{
+    queue.items[index] = offset;
+    queue_position.items[offset] = index;
+}
+
 static inline void ordered_queue_swap(int first, int second)
 {
     int temp = queue.items[first];
-    queue.items[first] = queue.items[second];
-    queue.items[second] = temp;
+    ordered_queue_set(first, queue.items[second]);
+    ordered_queue_set(second, temp);
 }
 
 static void ordered_queue_reorder(int start_index)
@@ -141,14 +151,16 @@ static void ordered_queue_reorder(int start_index)
 static inline int ordered_queue_pop(void)
 {
     int min = queue.items[0];
-    queue.items[0] = queue.items[--queue.tail];
-    ordered_queue_reorder(0);
+    if (--queue.tail) {
+        ordered_queue_set(0, queue.items[queue.tail]);
+        ordered_queue_reorder(0);
+    }
     return min;
 }
 
 static inline void ordered_queue_reduce_index(int index, int offset, int dist)
 {
-    queue.items[index] = offset;
+    ordered_queue_set(index, offset);
     while (index && distance.possible.items[queue.items[ordered_queue_parent(index)]] > dist) {
         ordered_queue_swap(index, ordered_queue_parent(index));
         index = ordered_queue_parent(index);
@@ -163,12 +175,7 @@ static void ordered_enqueue(int next_offset, int current_dist, int remaining_dis
         if (distance.possible.items[next_offset] <= possible_dist) {
             return;
         } else {
-            for (int i = 0; i < queue.tail; i++) {
-                if (queue.items[i] == next_offset) {
-                    index = i;
-                    break;
-                }
-            }
+            index = queue_position.items[next_offset];
         }
     } else {
         queue.tail++;
@@ -671,6 +678,11 @@ void map_routing_block(int x, int y, int size)
     }
 }
 
+void map_routing_count_reused_route(void)
+{
+    ++stats.total_routes_calculated;
+}
+
 int map_routing_distance(int grid_offset)
 {
     return distance.determined.items[grid_offset];
@@ -4,6 +4,7 @@
 #include "city/view.h"
 #include "core/direction.h"
 #include "core/image.h"
+#include "core/log.h"
 #include "map/building.h"
 #include "map/data.h"
 #include "map/image.h"
@@ -13,8 +14,12 @@
 #include "map/sprite.h"
 #include "map/terrain.h"
 
+#include <string.h>
+
 static void map_routing_update_land_noncitizen(void);
 
+static int land_citizen_generation;
+
 void map_routing_update_all(void)
 {
     map_routing_update_land();
@@ -99,41 +104,53 @@ static int get_land_type_citizen_aqueduct(int grid_offset)
     }
 }
 
+static void update_land_citizen_tile(int grid_offset)
+{
+    int terrain = map_terrain_get(grid_offset);
+    if (terrain & TERRAIN_ROAD) {
+        terrain_land_citizen.items[grid_offset] = CITIZEN_0_ROAD;
+    } else if (terrain & TERRAIN_HIGHWAY) {
+        terrain_land_citizen.items[grid_offset] = CITIZEN_1_HIGHWAY;
+    } else if (terrain & (TERRAIN_RUBBLE | TERRAIN_ACCESS_RAMP | TERRAIN_GARDEN)) {
+        terrain_land_citizen.items[grid_offset] = CITIZEN_2_PASSABLE_TERRAIN;
+    } else if (terrain & (TERRAIN_BUILDING | TERRAIN_GATEHOUSE)) {
+        if (!map_building_at(grid_offset)) {
+            // shouldn't happen
+            terrain_land_citizen.items[grid_offset] = CITIZEN_N1_BLOCKED;
+            terrain_land_noncitizen.items[grid_offset] = CITIZEN_4_CLEAR_TERRAIN; // BUG: should be citizen?
+            map_terrain_remove(grid_offset, TERRAIN_BUILDING);
+            map_image_set(grid_offset, (map_random_get(grid_offset) & 7) + image_group(GROUP_TERRAIN_GRASS_1));
+            map_property_mark_draw_tile(grid_offset);
+            map_property_set_multi_tile_size(grid_offset, 1);
+            return;
+        }
+        terrain_land_citizen.items[grid_offset] = get_land_type_citizen_building(grid_offset);
+    } else if (terrain & TERRAIN_AQUEDUCT) {
+        terrain_land_citizen.items[grid_offset] = get_land_type_citizen_aqueduct(grid_offset);
+    } else if (terrain & TERRAIN_NOT_CLEAR) {
+        terrain_land_citizen.items[grid_offset] = CITIZEN_N1_BLOCKED;
+    } else {
+        terrain_land_citizen.items[grid_offset] = CITIZEN_4_CLEAR_TERRAIN;
+    }
+}
+
 void map_routing_update_land_citizen(void)
 {
+    land_citizen_generation++;
     map_grid_init_i8(terrain_land_citizen.items, -1);
     int grid_offset = map_data.start_offset;
     for (int y = 0; y < map_data.height; y++, grid_offset += map_data.border_size) {
         for (int x = 0; x < map_data.width; x++, grid_offset++) {
-            int terrain = map_terrain_get(grid_offset);
-            if (terrain & TERRAIN_ROAD) {
-                terrain_land_citizen.items[grid_offset] = CITIZEN_0_ROAD;
-            } else if (terrain & TERRAIN_HIGHWAY) {
-                terrain_land_citizen.items[grid_offset] = CITIZEN_1_HIGHWAY;
-            } else if (terrain & (TERRAIN_RUBBLE | TERRAIN_ACCESS_RAMP | TERRAIN_GARDEN)) {
-                terrain_land_citizen.items[grid_offset] = CITIZEN_2_PASSABLE_TERRAIN;
-            } else if (terrain & (TERRAIN_BUILDING | TERRAIN_GATEHOUSE)) {
-                if (!map_building_at(grid_offset)) {
-                    // shouldn't happen
-                    terrain_land_noncitizen.items[grid_offset] = CITIZEN_4_CLEAR_TERRAIN; // BUG: should be citizen?
-                    map_terrain_remove(grid_offset, TERRAIN_BUILDING);
-                    map_image_set(grid_offset, (map_random_get(grid_offset) & 7) + image_group(GROUP_TERRAIN_GRASS_1));
-                    map_property_mark_draw_tile(grid_offset);
-                    map_property_set_multi_tile_size(grid_offset, 1);
-                    continue;
-                }
-                terrain_land_citizen.items[grid_offset] = get_land_type_citizen_building(grid_offset);
-            } else if (terrain & TERRAIN_AQUEDUCT) {
-                terrain_land_citizen.items[grid_offset] = get_land_type_citizen_aqueduct(grid_offset);
-            } else if (terrain & TERRAIN_NOT_CLEAR) {
-                terrain_land_citizen.items[grid_offset] = CITIZEN_N1_BLOCKED;
-            } else {
-                terrain_land_citizen.items[grid_offset] = CITIZEN_4_CLEAR_TERRAIN;
-            }
+            update_land_citizen_tile(grid_offset);
         }
     }
 }
 
+int map_routing_land_citizen_generation(void)
+{
+    return land_citizen_generation;
+}
+
 static int get_land_type_noncitizen(int grid_offset)
 {
     int type = NONCITIZEN_1_BUILDING;
@@ -176,34 +193,97 @@ static int get_land_type_noncitizen(int grid_offset)
     return type;
 }
 
+static void update_land_noncitizen_tile(int grid_offset)
+{
+    int terrain = map_terrain_get(grid_offset);
+    if (terrain & TERRAIN_GATEHOUSE) {
+        terrain_land_noncitizen.items[grid_offset] = NONCITIZEN_4_GATEHOUSE;
+    } else if (terrain & TERRAIN_BUILDING) {
+        terrain_land_noncitizen.items[grid_offset] = get_land_type_noncitizen(grid_offset);
+    } else if (terrain & TERRAIN_ROAD) {
+        terrain_land_noncitizen.items[grid_offset] = NONCITIZEN_0_PASSABLE;
+    } else if (terrain & TERRAIN_HIGHWAY) {
+        terrain_land_noncitizen.items[grid_offset] = NONCITIZEN_0_PASSABLE;
+    } else if (terrain & (TERRAIN_GARDEN | TERRAIN_ACCESS_RAMP | TERRAIN_RUBBLE)) {
+        terrain_land_noncitizen.items[grid_offset] = NONCITIZEN_2_CLEARABLE;
+    } else if (terrain & TERRAIN_AQUEDUCT) {
+        terrain_land_noncitizen.items[grid_offset] = NONCITIZEN_2_CLEARABLE;
+    } else if (terrain & TERRAIN_WALL) {
+        terrain_land_noncitizen.items[grid_offset] = NONCITIZEN_3_WALL;
+    } else if (terrain & TERRAIN_NOT_CLEAR) {
+        terrain_land_noncitizen.items[grid_offset] = NONCITIZEN_N1_BLOCKED;
+    } else {
+        terrain_land_noncitizen.items[grid_offset] = NONCITIZEN_0_PASSABLE;
+    }
+}
+
 static void map_routing_update_land_noncitizen(void)
 {
     map_grid_init_i8(terrain_land_noncitizen.items, -1);
     int grid_offset = map_data.start_offset;
     for (int y = 0; y < map_data.height; y++, grid_offset += map_data.border_size) {
         for (int x = 0; x < map_data.width; x++, grid_offset++) {
-            int terrain = map_terrain_get(grid_offset);
-            if (terrain & TERRAIN_GATEHOUSE) {
-                terrain_land_noncitizen.items[grid_offset] = NONCITIZEN_4_GATEHOUSE;
-            } else if (terrain & TERRAIN_BUILDING) {
-                terrain_land_noncitizen.items[grid_offset] = get_land_type_noncitizen(grid_offset);
-            } else if (terrain & TERRAIN_ROAD) {
-                terrain_land_noncitizen.items[grid_offset] = NONCITIZEN_0_PASSABLE;
-            } else if (terrain & TERRAIN_HIGHWAY) {
-                terrain_land_noncitizen.items[grid_offset] = NONCITIZEN_0_PASSABLE;
-            } else if (terrain & (TERRAIN_GARDEN | TERRAIN_ACCESS_RAMP | TERRAIN_RUBBLE)) {
-                terrain_land_noncitizen.items[grid_offset] = NONCITIZEN_2_CLEARABLE;
-            } else if (terrain & TERRAIN_AQUEDUCT) {
-                terrain_land_noncitizen.items[grid_offset] = NONCITIZEN_2_CLEARABLE;
-            } else if (terrain & TERRAIN_WALL) {
-                terrain_land_noncitizen.items[grid_offset] = NONCITIZEN_3_WALL;
-            } else if (terrain & TERRAIN_NOT_CLEAR) {
-                terrain_land_noncitizen.items[grid_offset] = NONCITIZEN_N1_BLOCKED;
-            } else {
-                terrain_land_noncitizen.items[grid_offset] = NONCITIZEN_0_PASSABLE;
+            update_land_noncitizen_tile(grid_offset);
+        }
+    }
+}
+
+#ifdef VERIFY_INCREMENTAL_UPDATES
+static void verify_land_grid(const grid_i8 *incremental_grid, const grid_i8 *full_grid, const char *name)
+{
+    int mismatches = 0;
+    for (int i = 0; i < GRID_SIZE * GRID_SIZE; i++) {
+        if (incremental_grid->items[i] != full_grid->items[i]) {
+            if (!mismatches) {
+                log_error("Incremental routing update differs from the full rebuild at offset", name, i);
             }
+            mismatches++;
         }
     }
+    if (mismatches) {
+        log_error("Number of tiles with mismatched routing:", name, mismatches);
+    }
+}
+
+static void verify_land_region_update(void)
+{
+    static grid_i8 incremental_citizen;
+    static grid_i8 incremental_noncitizen;
+    memcpy(incremental_citizen.items, terrain_land_citizen.items, sizeof(terrain_land_citizen.items));
+    memcpy(incremental_noncitizen.items, terrain_land_noncitizen.items, sizeof(terrain_land_noncitizen.items));
+    map_routing_update_land();
+    verify_land_grid(&incremental_citizen, &terrain_land_citizen, "citizen");
+    verify_land_grid(&incremental_noncitizen, &terrain_land_noncitizen, "noncitizen");
+}
+#endif
+
+void map_routing_update_land_region(int x_min, int y_min, int x_max, int y_max)
+{
+    map_grid_bound_area(&x_min, &y_min, &x_max, &y_max);
+    land_citizen_generation++;
+    for (int y = y_min; y <= y_max; y++) {
+        int grid_offset = map_grid_offset(x_min, y);
+        for (int x = x_min; x <= x_max; x++, grid_offset++) {
+            update_land_citizen_tile(grid_offset);
+        }
+    }
+    for (int y = y_min; y <= y_max; y++) {
+        int grid_offset = map_grid_offset(x_min, y);
+        for (int x = x_min; x <= x_max; x++, grid_offset++) {
+            update_land_noncitizen_tile(grid_offset);
+        }
+    }
+#ifdef VERIFY_INCREMENTAL_UPDATES
+    verify_land_region_update();
+#endif
+}
+
+void map_routing_update_land_area(int x, int y, int size)
+{
+    int x_min, y_min, x_max, y_max;
+    // Aqueduct images depend on their neighbours, so the tiles around the area are updated as well
+    map_grid_get_area(x, y, size, 1, &x_min, &y_min, &x_max, &y_max);
+    map_routing_update_land_region(x_min, y_min, x_max, y_max);
 }
 
 static int is_surrounded_by_water(int grid_offset)
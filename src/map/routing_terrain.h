@@ -4,9 +4,34 @@
 void map_routing_update_all(void);
 void map_routing_update_land(void);
 void map_routing_update_land_citizen(void);
+
+/**
+ * Recalculates the land routing grids for a rectangle of tiles only.
+ * Use this instead of map_routing_update_land() when the changed tiles are known.
+ * @param x_min Minimum X coordinate of the changed tiles
+ * @param y_min Minimum Y coordinate of the changed tiles
+ * @param x_max Maximum X coordinate of the changed tiles
+ * @param y_max Maximum Y coordinate of the changed tiles
+ */
+void map_routing_update_land_region(int x_min, int y_min, int x_max, int y_max);
+
+/**
+ * Recalculates the land routing grids for a building footprint and the tiles bordering it
+ * @param x X coordinate of the footprint
+ * @param y Y coordinate of the footprint
+ * @param size Size of the footprint
+ */
+void map_routing_update_land_area(int x, int y, int size);
 void map_routing_update_water(void);
 void map_routing_update_walls(void);
 
+/**
+ * Gets a counter that changes every time the citizen land routing grid is recalculated.
+ * Anything derived from citizen routes is stale once the counter changes.
+ * @return The current citizen land routing generation
+ */
+int map_routing_land_citizen_generation(void);
+
 int map_routing_is_wall_passable(int grid_offset);
 int map_routing_wall_tile_in_radius(int x, int y, int radius, int *x_wall, int *y_wall);
 
@@ -4,6 +4,7 @@
 
 static grid_u8 sprite;
 static grid_u8 sprite_backup;
+static grid_changes sprite_changes;
 
 int map_sprite_animation_at(int grid_offset)
 {
@@ -13,6 +14,7 @@ int map_sprite_animation_at(int grid_offset)
 void map_sprite_animation_set(int grid_offset, int value)
 {
     sprite.items[grid_offset] = value;
+    map_grid_changes_add(&sprite_changes, grid_offset);
 }
 
 int map_sprite_bridge_at(int grid_offset)
@@ -23,26 +25,30 @@ int map_sprite_bridge_at(int grid_offset)
 void map_sprite_bridge_set(int grid_offset, int value)
 {
     sprite.items[grid_offset] = value;
+    map_grid_changes_add(&sprite_changes, grid_offset);
 }
 
 void map_sprite_clear_tile(int grid_offset)
 {
     sprite.items[grid_offset] = 0;
+    map_grid_changes_add(&sprite_changes, grid_offset);
 }
 
 void map_sprite_clear(void)
 {
     map_grid_clear_u8(sprite.items);
+    map_grid_changes_add_all(&sprite_changes);
 }
 
 void map_sprite_backup(void)
 {
     map_grid_copy_u8(sprite.items, sprite_backup.items);
+    map_grid_changes_clear(&sprite_changes);
 }
 
 void map_sprite_restore(void)
 {
-    map_grid_copy_u8(sprite_backup.items, sprite.items);
+    map_grid_restore_changes_u8(sprite_backup.items, sprite.items, &sprite_changes);
 }
 
 void map_sprite_save_state(buffer *buf, buffer *backup)
@@ -55,4 +61,5 @@ void map_sprite_load_state(buffer *buf, buffer *backup)
 {
     map_grid_load_state_u8(sprite.items, buf);
     map_grid_load_state_u8(sprite_backup.items, backup);
+    map_grid_changes_add_all(&sprite_changes);
 }
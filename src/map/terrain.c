@@ -8,6 +8,7 @@
 
 static grid_u32 terrain_grid;
 static grid_u32 terrain_grid_backup;
+static grid_changes terrain_changes;
 
 int map_terrain_is(int grid_offset, int terrain)
 {
@@ -39,16 +40,19 @@ int map_terrain_get_from_buffer_32(buffer *buf, int grid_offset)
 void map_terrain_set(int grid_offset, int terrain)
 {
     terrain_grid.items[grid_offset] = terrain;
+    map_grid_changes_add(&terrain_changes, grid_offset);
 }
 
 void map_terrain_add(int grid_offset, int terrain)
 {
     terrain_grid.items[grid_offset] |= terrain;
+    map_grid_changes_add(&terrain_changes, grid_offset);
 }
 
 void map_terrain_remove(int grid_offset, int terrain)
 {
     terrain_grid.items[grid_offset] &= ~terrain;
+    map_grid_changes_add(&terrain_changes, grid_offset);
 }
 
 void map_terrain_add_with_radius(int x, int y, int size, int radius, int terrain)
@@ -77,7 +81,7 @@ void map_terrain_remove_with_radius(int x, int y, int size, int radius, int terr
 
 void map_terrain_remove_all(int terrain)
 {
-    map_grid_and_u32(terrain_grid.items, ~terrain);
+    map_grid_and_tracked_u32(terrain_grid.items, ~terrain, &terrain_changes);
 }
 
 int map_terrain_count_directly_adjacent_with_type(int grid_offset, int terrain)
@@ -394,16 +398,18 @@ void map_terrain_add_triumphal_arch_roads(int x, int y, int orientation)
 void map_terrain_backup(void)
 {
     map_grid_copy_u32(terrain_grid.items, terrain_grid_backup.items);
+    map_grid_changes_clear(&terrain_changes);
 }
 
 void map_terrain_restore(void)
 {
-    map_grid_copy_u32(terrain_grid_backup.items, terrain_grid.items);
+    map_grid_restore_changes_u32(terrain_grid_backup.items, terrain_grid.items, &terrain_changes, 0);
 }
 
 void map_terrain_clear(void)
 {
     map_grid_clear_u32(terrain_grid.items);
+    map_grid_changes_add_all(&terrain_changes);
 }
 
 void map_terrain_init_outside_map(void)
@@ -417,6 +423,7 @@ void map_terrain_init_outside_map(void)
         for (int x = 0; x < GRID_SIZE; x++) {
             if (y_outside_map || x < x_start || x >= x_start + map_width) {
                 terrain_grid.items[x + GRID_SIZE * y] = TERRAIN_MAP_EDGE;
+                map_grid_changes_add(&terrain_changes, x + GRID_SIZE * y);
             }
         }
     }
@@ -439,6 +446,7 @@ static void determine_original_trees(buffer *images, int legacy_buffer)
             if (terrain_grid.items[x + GRID_SIZE * y] & TERRAIN_TREE &&
                 !(terrain_grid.items[x + GRID_SIZE * y] & TERRAIN_WATER)) {
                 terrain_grid.items[x + GRID_SIZE * y] |= TERRAIN_ORIGINALLY_TREE;
+                map_grid_changes_add(&terrain_changes, x + GRID_SIZE * y);
                 if (images) {
                     buffer_set(images, (x + GRID_SIZE * y) * (legacy_buffer ? 2 : 4));
                     int image_id = legacy_buffer ? buffer_read_u16(images) : buffer_read_u32(images);
@@ -476,5 +484,6 @@ void map_terrain_load_state(buffer *buf, int expanded_terrain_data, buffer *imag
     } else {
         map_grid_load_state_u16_to_u32(terrain_grid.items, buf);
     }
+    map_grid_changes_add_all(&terrain_changes);
     determine_original_trees(images, legacy_image_buffer);
 }
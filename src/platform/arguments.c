@@ -8,6 +8,16 @@
 #define DISPLAY_SCALE_ERROR_MESSAGE "Option --display-scale must be followed by a scale value between 0.5 and 5"
 #define WINDOWED_AND_FULLSCREEN_ERROR_MESSAGE "Option --windowed and --fullscreen cannot both be specified"
 #define DISPLAY_ID_ERROR_MESSAGE "Option --display must be followed by a number indicating the display, starting from 0"
+#define PROFILE_TICKS_ERROR_MESSAGE "Option --profile-ticks must be followed by the CSV file to write the tick timings to"
+#define RECORD_JOURNAL_ERROR_MESSAGE "Option --record-journal must be followed by the journal file to record to"
+#define REPLAY_JOURNAL_ERROR_MESSAGE "Option --replay must be followed by the journal file to replay"
+#define HEADLESS_AND_REPLAY_ERROR_MESSAGE "Options --headless and --replay cannot both be specified"
+#define HEADLESS_ERROR_MESSAGE "Option --headless must be followed by the saved game file to simulate"
+#define HEADLESS_TICKS_ERROR_MESSAGE "Option --ticks must be followed by a positive number of ticks to simulate"
+#define HEADLESS_OUTPUT_ERROR_MESSAGE "Option --output must be followed by the file to save the simulated game to"
+#define HEADLESS_SCREENSHOT_ERROR_MESSAGE "Option --screenshot must be followed by the PNG file to draw the city to"
+#define HEADLESS_ONLY_ERROR_MESSAGE "Options --ticks, --output, --screenshot and --benchmark-routes can only be used together with --headless or --replay"
+#define REPLAY_TICKS_ERROR_MESSAGE "Option --ticks cannot be used with --replay: the journal decides how many ticks to run"
 #define UNKNOWN_OPTION_ERROR_MESSAGE "Option %s not recognized"
 
 static void print_log(const char *message)
@@ -74,6 +84,14 @@ int platform_parse_arguments(int argc, char **argv, augustus_args *output_args)
     output_args->use_software_cursor = 0;
     output_args->force_fullscreen = 0;
     output_args->display_id = 0;
+    output_args->tick_profile_file = 0;
+    output_args->record_journal = 0;
+    output_args->headless_savegame = 0;
+    output_args->headless_output = 0;
+    output_args->headless_screenshot = 0;
+    output_args->headless_ticks = 0;
+    output_args->headless_benchmark_routes = 0;
+    output_args->replay_journal = 0;
 
     for (int i = 1; i < argc; i++) {
         // we ignore "-psn" arguments, this is needed to launch the app
@@ -128,6 +146,68 @@ int platform_parse_arguments(int argc, char **argv, augustus_args *output_args)
             output_args->use_software_cursor = 1;
         } else if (SDL_strcmp(argv[i], "--fullscreen") == 0) {
             output_args->force_fullscreen = 1;
+        } else if (SDL_strcmp(argv[i], "--profile-ticks") == 0) {
+            if (i + 1 < argc) {
+                output_args->tick_profile_file = argv[i + 1];
+                i++;
+            } else {
+                print_log(PROFILE_TICKS_ERROR_MESSAGE);
+                ok = 0;
+            }
+        } else if (SDL_strcmp(argv[i], "--record-journal") == 0) {
+            if (i + 1 < argc) {
+                output_args->record_journal = argv[i + 1];
+                i++;
+            } else {
+                print_log(RECORD_JOURNAL_ERROR_MESSAGE);
+                ok = 0;
+            }
+        } else if (SDL_strcmp(argv[i], "--replay") == 0) {
+            if (i + 1 < argc) {
+                output_args->replay_journal = argv[i + 1];
+                i++;
+            } else {
+                print_log(REPLAY_JOURNAL_ERROR_MESSAGE);
+                ok = 0;
+            }
+        } else if (SDL_strcmp(argv[i], "--headless") == 0) {
+            if (i + 1 < argc) {
+                output_args->headless_savegame = argv[i + 1];
+                i++;
+            } else {
+                print_log(HEADLESS_ERROR_MESSAGE);
+                ok = 0;
+            }
+        } else if (SDL_strcmp(argv[i], "--ticks") == 0) {
+            if (i + 1 < argc) {
+                output_args->headless_ticks = SDL_strtol(argv[i + 1], 0, 10);
+                i++;
+                if (output_args->headless_ticks <= 0) {
+                    print_log(HEADLESS_TICKS_ERROR_MESSAGE);
+                    ok = 0;
+                }
+            } else {
+                print_log(HEADLESS_TICKS_ERROR_MESSAGE);
+                ok = 0;
+            }
+        } else if (SDL_strcmp(argv[i], "--output") == 0) {
+            if (i + 1 < argc) {
+                output_args->headless_output = argv[i + 1];
+                i++;
+            } else {
+                print_log(HEADLESS_OUTPUT_ERROR_MESSAGE);
+                ok = 0;
+            }
+        } else if (SDL_strcmp(argv[i], "--screenshot") == 0) {
+            if (i + 1 < argc) {
+                output_args->headless_screenshot = argv[i + 1];
+                i++;
+            } else {
+                print_log(HEADLESS_SCREENSHOT_ERROR_MESSAGE);
+                ok = 0;
+            }
+        } else if (SDL_strcmp(argv[i], "--benchmark-routes") == 0) {
+            output_args->headless_benchmark_routes = 1;
         } else if (SDL_strcmp(argv[i], "--help") == 0) {
             add_blank_line = 0;
             ok = 0;
@@ -142,6 +222,19 @@ int platform_parse_arguments(int argc, char **argv, augustus_args *output_args)
         print_log(WINDOWED_AND_FULLSCREEN_ERROR_MESSAGE);
         ok = 0;
     }
+    if (output_args->headless_savegame && output_args->replay_journal) {
+        print_log(HEADLESS_AND_REPLAY_ERROR_MESSAGE);
+        ok = 0;
+    }
+    if (output_args->replay_journal && output_args->headless_ticks) {
+        print_log(REPLAY_TICKS_ERROR_MESSAGE);
+        ok = 0;
+    }
+    if (!output_args->headless_savegame && !output_args->replay_journal && (output_args->headless_ticks ||
+        output_args->headless_output || output_args->headless_screenshot || output_args->headless_benchmark_routes)) {
+        print_log(HEADLESS_ONLY_ERROR_MESSAGE);
+        ok = 0;
+    }
 
     if (!ok) {
         if (add_blank_line) {
@@ -165,6 +258,23 @@ int platform_parse_arguments(int argc, char **argv, augustus_args *output_args)
         print_log("          Enables joystick support");
         print_log("--software-cursor");
         print_log("          Uses a software cursor instead of the default hardware cursor");
+        print_log("--profile-ticks FILE");
+        print_log("          Writes how long each part of every game tick takes to the CSV file FILE");
+        print_log("          Only available when built with the PROFILE_TICKS option");
+        print_log("--record-journal FILE");
+        print_log("          Records the player actions of the last game played to FILE, and its starting state to FILE.svx");
+        print_log("--headless FILE");
+        print_log("          Loads the saved game FILE and simulates it without a window, renderer or sound");
+        print_log("--ticks NUMBER");
+        print_log("          Number of game ticks to simulate in headless mode, defaults to one game year");
+        print_log("--output FILE");
+        print_log("          Saves the game to FILE after the headless simulation finishes");
+        print_log("--screenshot FILE");
+        print_log("          Draws the whole city to the PNG file FILE after the headless simulation finishes");
+        print_log("--benchmark-routes");
+        print_log("          Records the figure routes requested during the headless simulation and times replaying them");
+        print_log("--replay FILE");
+        print_log("          Replays the journal FILE without a window, checking that the game state matches the recording");
         print_log("The last argument, if present, is interpreted as data directory for the Caesar 3 installation");
     }
     return ok;
@@ -11,6 +11,14 @@ typedef struct {
     int use_software_cursor;
     int force_fullscreen;
     int display_id;
+    const char *tick_profile_file;
+    const char *record_journal;
+    const char *headless_savegame;
+    const char *headless_output;
+    const char *headless_screenshot;
+    int headless_ticks;
+    int headless_benchmark_routes;
+    const char *replay_journal;
 } augustus_args;
 
 int platform_parse_arguments(int argc, char **argv, augustus_args *output_args);
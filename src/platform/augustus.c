@@ -7,8 +7,10 @@
 #include "core/log.h"
 #include "core/time.h"
 #include "game/game.h"
+#include "game/journal.h"
 #include "game/settings.h"
 #include "game/system.h"
+#include "game/tick_profiler.h"
 #include "graphics/screen.h"
 #include "graphics/window.h"
 #include "input/mouse.h"
@@ -19,6 +21,7 @@
 #include "platform/emscripten/emscripten.h"
 #include "platform/file_manager.h"
 #include "platform/file_manager_cache.h"
+#include "platform/headless.h"
 #include "platform/ios/ios.h"
 #include "platform/joystick.h"
 #include "platform/keyboard_input.h"
@@ -29,6 +32,7 @@
 #include "platform/switch/switch.h"
 #include "platform/touch.h"
 #include "platform/vita/vita.h"
+#include "widget/city_terrain_cache.h"
 #include "window/asset_previewer.h"
 
 #include "tinyfiledialogs/tinyfiledialogs.h"
@@ -188,6 +192,16 @@ uint64_t system_get_ticks(void)
 #endif
 }
 
+uint64_t system_get_performance_counter(void)
+{
+    return SDL_GetPerformanceCounter();
+}
+
+uint64_t system_get_performance_frequency(void)
+{
+    return SDL_GetPerformanceFrequency();
+}
+
 #ifdef _WIN32
 #define PLATFORM_ENABLE_PER_FRAME_CALLBACK
 static void platform_per_frame_callback(void)
@@ -213,7 +227,8 @@ static void run_and_draw(void)
     }
 
     if (config_get(CONFIG_UI_DISPLAY_FPS)) {
-        game_display_fps(data.fps.last_fps);
+        const platform_renderer_frame_stats *stats = platform_renderer_get_frame_stats();
+        game_display_fps(data.fps.last_fps, stats->draw_calls, stats->batches, stats->sprites);
     }
 
     platform_renderer_render();
@@ -301,6 +316,7 @@ static void handle_event(SDL_Event *event)
         case SDL_RENDER_TARGETS_RESET:
 #endif
             platform_renderer_invalidate_target_textures();
+            city_terrain_cache_invalidate();
             window_invalidate();
             break;
 #if SDL_VERSION_ATLEAST(2, 0, 4)
@@ -406,6 +422,7 @@ static void teardown(void)
 {
     log_repeated_messages();
     SDL_Log("Exiting game");
+    tick_profiler_stop_csv();
     game_exit();
     platform_screen_destroy();
     SDL_Quit();
@@ -689,6 +706,12 @@ static void setup(const augustus_args *args)
         SDL_Log("Exiting: game init failed");
         exit_with_status(2);
     }
+    if (args->tick_profile_file) {
+        tick_profiler_start_csv(args->tick_profile_file);
+    }
+    if (args->record_journal) {
+        game_journal_start_recording(args->record_journal);
+    }
 
     data.quit = 0;
     data.active = 1;
@@ -704,6 +727,12 @@ int main(int argc, char **argv)
 #endif
     }
 
+    if (args.headless_savegame || args.replay_journal) {
+        int status = platform_headless_run(&args);
+        log_repeated_messages();
+        exit_with_status(status);
+    }
+
     setup(&args);
 
 
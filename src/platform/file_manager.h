@@ -115,6 +115,14 @@ int platform_file_manager_close_file(FILE *stream);
  */
 int platform_file_manager_remove_file(const char *filename);
 
+/**
+ * Renames a file, replacing the destination if it exists
+ * @param src The file to rename
+ * @param dst The new name of the file
+ * @return 1 if renaming was successful, 0 otherwise
+ */
+int platform_file_manager_rename_file(const char *src, const char *dst);
+
 /**
  * Creates a directory
  * @param name The full path to the new directory
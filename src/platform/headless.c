@@ -0,0 +1,188 @@
+#include "headless.h"
+
+#include "city/finance.h"
+#include "city/population.h"
+#include "city/ratings.h"
+#include "core/time.h"
+#include "figure/route.h"
+#include "game/file.h"
+#include "game/game.h"
+#include "game/journal.h"
+#include "game/tick.h"
+#include "game/tick_profiler.h"
+#include "game/time.h"
+#include "graphics/screen.h"
+#include "graphics/screenshot.h"
+#include "graphics/software_renderer.h"
+#include "platform/file_manager.h"
+
+#include "SDL.h"
+
+#include <stdio.h>
+
+#define HEADLESS_SCREEN_WIDTH 1024
+#define HEADLESS_SCREEN_HEIGHT 768
+#define DEFAULT_TICKS (GAME_TIME_TICKS_PER_DAY * GAME_TIME_DAYS_PER_MONTH * GAME_TIME_MONTHS_PER_YEAR)
+
+static double counter_to_seconds(uint64_t counter)
+{
+    return (double) counter / SDL_GetPerformanceFrequency();
+}
+
+static void benchmark_routes(void)
+{
+    uint64_t start = SDL_GetPerformanceCounter();
+    int requests = figure_route_replay_recorded_requests();
+    double elapsed_seconds = counter_to_seconds(SDL_GetPerformanceCounter() - start);
+    figure_route_record_requests(0);
+    printf("route_requests=%d\n", requests);
+    printf("route_replay_ms=%.3f\n", elapsed_seconds * 1000);
+    printf("route_requests_per_second=%.1f\n", elapsed_seconds > 0 ? requests / elapsed_seconds : 0);
+    fflush(stdout);
+}
+
+static void print_summary(int ticks, uint64_t elapsed_counter)
+{
+    double elapsed_seconds = counter_to_seconds(elapsed_counter);
+    double ticks_per_second = elapsed_seconds > 0 ? ticks / elapsed_seconds : 0;
+    printf("ticks=%d\n", ticks);
+    printf("elapsed_ms=%.3f\n", elapsed_seconds * 1000);
+    printf("ticks_per_second=%.1f\n", ticks_per_second);
+    printf("date=%d-%02d-%02d\n", game_time_year(), game_time_month() + 1, game_time_day() + 1);
+    printf("population=%d\n", city_population());
+    printf("treasury=%d\n", city_finance_treasury());
+    printf("culture=%d\n", city_rating_culture());
+    printf("prosperity=%d\n", city_rating_prosperity());
+    printf("peace=%d\n", city_rating_peace());
+    printf("favor=%d\n", city_rating_favor());
+    fflush(stdout);
+}
+
+static int save_output(const augustus_args *args)
+{
+    if (args->headless_output && !game_file_write_saved_game(args->headless_output)) {
+        SDL_Log("Exiting: unable to save %s", args->headless_output);
+        return 0;
+    }
+    if (args->headless_screenshot && !graphics_save_full_city_screenshot(args->headless_screenshot)) {
+        SDL_Log("Exiting: unable to draw the city to %s", args->headless_screenshot);
+        return 0;
+    }
+    return 1;
+}
+
+static int replay_journal(const augustus_args *args)
+{
+    if (!game_journal_load_replay(args->replay_journal)) {
+        SDL_Log("Exiting: unable to load journal %s", args->replay_journal);
+        return 3;
+    }
+    if (args->headless_benchmark_routes) {
+        figure_route_record_requests(1);
+    }
+    if (args->tick_profile_file && !tick_profiler_start_csv(args->tick_profile_file)) {
+        SDL_Log("Exiting: unable to write tick profile to %s", args->tick_profile_file);
+        return 5;
+    }
+    journal_replay_result result;
+    uint64_t start = SDL_GetPerformanceCounter();
+    int replayed = game_journal_run_replay(&result);
+    uint64_t elapsed = SDL_GetPerformanceCounter() - start;
+    tick_profiler_stop_csv();
+
+    game_file_finish_background_save(1);
+    print_summary(result.ticks, elapsed);
+    printf("commands=%d\n", result.commands);
+    printf("checkpoints=%d\n", result.checkpoints);
+    printf("mismatched_checkpoints=%d\n", result.mismatches);
+    if (result.mismatches) {
+        printf("first_mismatch_tick=%d\n", result.first_mismatch_tick);
+    }
+    printf("unsupported_actions=%d\n", result.unsupported);
+    if (result.unsupported) {
+        printf("first_unsupported_tick=%d\n", result.first_unsupported_tick);
+    }
+    fflush(stdout);
+    if (!replayed) {
+        SDL_Log("Exiting: journal %s is invalid", args->replay_journal);
+        return 6;
+    }
+    if (!save_output(args)) {
+        return 4;
+    }
+    if (args->headless_benchmark_routes) {
+        benchmark_routes();
+    }
+    if (result.unsupported) {
+        return 8;
+    }
+    return result.mismatches ? 7 : 0;
+}
+
+static int run_simulation(const augustus_args *args)
+{
+    if (!game_init_headless()) {
+        SDL_Log("Exiting: game init failed");
+        return 2;
+    }
+    if (args->replay_journal) {
+        return replay_journal(args);
+    }
+    int result = game_file_load_saved_game(args->headless_savegame);
+    if (result != FILE_LOAD_SUCCESS) {
+        SDL_Log("Exiting: unable to load %s, error %d", args->headless_savegame, result);
+        return 3;
+    }
+
+    int ticks = args->headless_ticks > 0 ? args->headless_ticks : DEFAULT_TICKS;
+    if (args->headless_benchmark_routes) {
+        figure_route_record_requests(1);
+    }
+    if (args->tick_profile_file && !tick_profiler_start_csv(args->tick_profile_file)) {
+        SDL_Log("Exiting: unable to write tick profile to %s", args->tick_profile_file);
+        return 5;
+    }
+    uint64_t start = SDL_GetPerformanceCounter();
+    for (int i = 0; i < ticks; i++) {
+        game_tick_run();
+    }
+    uint64_t elapsed = SDL_GetPerformanceCounter() - start;
+    tick_profiler_stop_csv();
+
+    game_file_finish_background_save(1);
+    print_summary(ticks, elapsed);
+
+    if (!save_output(args)) {
+        return 4;
+    }
+    // Replaying routes changes the routing counters, so it must only happen after saving
+    if (args->headless_benchmark_routes) {
+        benchmark_routes();
+    }
+    return 0;
+}
+
+int platform_headless_run(const augustus_args *args)
+{
+    SDL_Log("Running headless simulation of %s",
+        args->replay_journal ? args->replay_journal : args->headless_savegame);
+
+    if (args->data_directory && !platform_file_manager_set_base_path(args->data_directory)) {
+        SDL_Log("%s: directory not found", args->data_directory);
+        return 1;
+    }
+    if (!game_pre_init()) {
+        SDL_Log("Exiting: game pre-init failed");
+        return 1;
+    }
+    // Nothing is drawn to the screen: the software renderer only draws the city for --screenshot
+    if (!graphics_software_renderer_init(HEADLESS_SCREEN_WIDTH, HEADLESS_SCREEN_HEIGHT)) {
+        SDL_Log("Exiting: not enough memory for the renderer");
+        return 1;
+    }
+    screen_set_resolution(HEADLESS_SCREEN_WIDTH, HEADLESS_SCREEN_HEIGHT);
+    time_set_millis(0);
+    int result = run_simulation(args);
+    graphics_software_renderer_shutdown();
+    return result;
+}
@@ -0,0 +1,17 @@
+#ifndef PLATFORM_HEADLESS_H
+#define PLATFORM_HEADLESS_H
+
+#include "platform/arguments.h"
+
+/**
+ * Loads the saved game given in the arguments and simulates it as fast as possible,
+ * without creating a window, a renderer or opening the sound device.
+ * When a journal is given instead, replays it and checks the recorded game state hashes.
+ * Afterwards, the game can be saved and the whole city drawn to a PNG file with the software renderer.
+ * @param args The command line arguments
+ * @return The process exit status: 0 on success, 7 if a replayed game state did not match the journal,
+ *         8 if the journal has actions that could not be replayed
+ */
+int platform_headless_run(const augustus_args *args);
+
+#endif // PLATFORM_HEADLESS_H
@@ -35,10 +35,17 @@
 #define HAS_TEXTURE_SCALE_MODE 0
 #endif
 
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+#define USE_RENDER_GEOMETRY
+#define HAS_RENDER_GEOMETRY (platform_sdl_version_at_least(2, 0, 18))
+#endif
+
 #define MAX_UNPACKED_IMAGES 20
 
 #define MAX_PACKED_IMAGE_SIZE 64000
 
+#define MAX_BATCH_QUADS 2048
+
 #if (defined(__ANDROID__) || defined(__EMSCRIPTEN__)) && !SDL_VERSION_ATLEAST(2, 24, 0)
 // On the arm versions of android, on SDL < 2.24.0, atlas textures that are too large will make the renderer fetch
 // some images from the atlas with an off-by-one pixel, making things look terrible. Defining a smaller atlas texture
@@ -118,13 +125,44 @@ static struct {
     float city_scale;
     int should_correct_texture_offset;
     int disable_linear_filter;
+#ifdef USE_RENDER_GEOMETRY
+    // Consecutive sprites from the same texture, drawn with a single SDL_RenderGeometry call
+    struct {
+        SDL_Texture *texture;
+        float scale;
+        int disable_linear_filter;
+        float texture_width;
+        float texture_height;
+        int num_quads;
+        SDL_Vertex vertices[MAX_BATCH_QUADS * 4];
+        int indices[MAX_BATCH_QUADS * 6];
+    } batch;
+#endif
+    platform_renderer_frame_stats frame_stats;
+    platform_renderer_frame_stats last_frame_stats;
 } data;
 
+static void flush_batch(void)
+{
+#ifdef USE_RENDER_GEOMETRY
+    if (data.batch.num_quads) {
+        SDL_RenderGeometry(data.renderer, data.batch.texture, data.batch.vertices, data.batch.num_quads * 4,
+            data.batch.indices, data.batch.num_quads * 6);
+        data.frame_stats.draw_calls++;
+        data.frame_stats.batches++;
+        data.batch.num_quads = 0;
+    }
+    // Textures may be destroyed after a flush, so a new one with the same address must start a new batch
+    data.batch.texture = 0;
+#endif
+}
+
 static int save_screen_buffer(color_t *pixels, int x, int y, int width, int height, int row_width)
 {
     if (data.paused) {
         return 0;
     }
+    flush_batch();
     SDL_Rect rect = { x, y, width, height };
     return SDL_RenderReadPixels(data.renderer, &rect, SDL_PIXELFORMAT_ARGB8888, pixels,
         row_width * sizeof(color_t)) == 0;
@@ -135,12 +173,14 @@ static void draw_line(int x_start, int x_end, int y_start, int y_end, color_t co
     if (data.paused) {
         return;
     }
+    flush_batch();
     SDL_SetRenderDrawColor(data.renderer,
         (color & COLOR_CHANNEL_RED) >> COLOR_BITSHIFT_RED,
         (color & COLOR_CHANNEL_GREEN) >> COLOR_BITSHIFT_GREEN,
         (color & COLOR_CHANNEL_BLUE) >> COLOR_BITSHIFT_BLUE,
         (color & COLOR_CHANNEL_ALPHA) >> COLOR_BITSHIFT_ALPHA);
     SDL_RenderDrawLine(data.renderer, x_start, y_start, x_end, y_end);
+    data.frame_stats.draw_calls++;
 }
 
 static void draw_rect(int x_start, int x_end, int y_start, int y_end, color_t color)
@@ -148,6 +188,7 @@ static void draw_rect(int x_start, int x_end, int y_start, int y_end, color_t co
     if (data.paused) {
         return;
     }
+    flush_batch();
     SDL_SetRenderDrawColor(data.renderer,
         (color & COLOR_CHANNEL_RED) >> COLOR_BITSHIFT_RED,
         (color & COLOR_CHANNEL_GREEN) >> COLOR_BITSHIFT_GREEN,
@@ -155,6 +196,7 @@ static void draw_rect(int x_start, int x_end, int y_start, int y_end, color_t co
         (color & COLOR_CHANNEL_ALPHA) >> COLOR_BITSHIFT_ALPHA);
     SDL_Rect rect = { x_start, y_start, x_end, y_end };
     SDL_RenderDrawRect(data.renderer, &rect);
+    data.frame_stats.draw_calls++;
 }
 
 static void fill_rect(int x_start, int x_end, int y_start, int y_end, color_t color)
@@ -162,6 +204,7 @@ static void fill_rect(int x_start, int x_end, int y_start, int y_end, color_t co
     if (data.paused) {
         return;
     }
+    flush_batch();
     SDL_SetRenderDrawColor(data.renderer,
         (color & COLOR_CHANNEL_RED) >> COLOR_BITSHIFT_RED,
         (color & COLOR_CHANNEL_GREEN) >> COLOR_BITSHIFT_GREEN,
@@ -169,6 +212,7 @@ static void fill_rect(int x_start, int x_end, int y_start, int y_end, color_t co
         (color & COLOR_CHANNEL_ALPHA) >> COLOR_BITSHIFT_ALPHA);
     SDL_Rect rect = { x_start, y_start, x_end, y_end };
     SDL_RenderFillRect(data.renderer, &rect);
+    data.frame_stats.draw_calls++;
 }
 
 static void set_clip_rectangle(int x, int y, int width, int height)
@@ -176,6 +220,7 @@ static void set_clip_rectangle(int x, int y, int width, int height)
     if (data.paused) {
         return;
     }
+    flush_batch();
     SDL_Rect clip = { x, y, width, height };
     SDL_RenderSetClipRect(data.renderer, &clip);
 }
@@ -185,6 +230,7 @@ static void reset_clip_rectangle(void)
     if (data.paused) {
         return;
     }
+    flush_batch();
     SDL_RenderSetClipRect(data.renderer, NULL);
 }
 
@@ -193,6 +239,7 @@ static void set_viewport(int x, int y, int width, int height)
     if (data.paused) {
         return;
     }
+    flush_batch();
     SDL_Rect viewport = { x, y, width, height };
     SDL_RenderSetViewport(data.renderer, &viewport);
 }
@@ -202,6 +249,7 @@ static void reset_viewport(void)
     if (data.paused) {
         return;
     }
+    flush_batch();
     SDL_RenderSetViewport(data.renderer, NULL);
     SDL_RenderSetClipRect(data.renderer, NULL);
 }
@@ -211,6 +259,7 @@ static void clear_screen(void)
     if (data.paused) {
         return;
     }
+    flush_batch();
     SDL_SetRenderDrawColor(data.renderer, 0, 0, 0, 0);
     SDL_RenderClear(data.renderer);
 }
@@ -223,6 +272,7 @@ static void get_max_image_size(int *width, int *height)
 
 static void free_silhouettes(void)
 {
+    flush_batch();
     silhouette_texture *silhouette = data.silhouettes;
     while (silhouette) {
         silhouette_texture *current = silhouette;
@@ -235,6 +285,7 @@ static void free_silhouettes(void)
 
 static void free_unpacked_assets(void)
 {
+    flush_batch();
     for (int i = 0; i < MAX_UNPACKED_IMAGES; i++) {
         if (data.unpacked_images[i].texture) {
             SDL_DestroyTexture(data.unpacked_images[i].texture);
@@ -245,6 +296,7 @@ static void free_unpacked_assets(void)
 
 static void free_texture_atlas(atlas_type type)
 {
+    flush_batch();
     if (!data.texture_lists[type]) {
         return;
     }
@@ -416,6 +468,7 @@ static const image_atlas_data *get_texture_atlas(atlas_type type)
 
 static void free_all_textures(void)
 {
+    flush_batch();
     for (atlas_type i = ATLAS_FIRST; i < ATLAS_MAX - 1; i++) {
         free_texture_atlas_and_data(i);
     }
@@ -503,6 +556,73 @@ static void set_texture_color_and_scale_mode(SDL_Texture *texture, color_t color
 #endif
 }
 
+#ifdef USE_RENDER_GEOMETRY
+static void init_batch_indices(void)
+{
+    for (int i = 0; i < MAX_BATCH_QUADS; i++) {
+        int *indices = &data.batch.indices[i * 6];
+        int first_vertex = i * 4;
+        indices[0] = first_vertex;
+        indices[1] = first_vertex + 1;
+        indices[2] = first_vertex + 2;
+        indices[3] = first_vertex + 2;
+        indices[4] = first_vertex + 1;
+        indices[5] = first_vertex + 3;
+    }
+}
+
+static void start_batch(SDL_Texture *texture, float scale)
+{
+    flush_batch();
+    int width, height;
+    SDL_QueryTexture(texture, NULL, NULL, &width, &height);
+    // The colour comes from the vertices, so the texture modulation must not alter it
+    set_texture_color_and_scale_mode(texture, COLOR_MASK_NONE, scale);
+    data.batch.texture = texture;
+    data.batch.scale = scale;
+    data.batch.disable_linear_filter = data.disable_linear_filter;
+    data.batch.texture_width = (float) width;
+    data.batch.texture_height = (float) height;
+}
+
+static void set_vertex(SDL_Vertex *vertex, float x, float y, float u, float v, SDL_Color color)
+{
+    vertex->position.x = x;
+    vertex->position.y = y;
+    vertex->tex_coord.x = u / data.batch.texture_width;
+    vertex->tex_coord.y = v / data.batch.texture_height;
+    vertex->color = color;
+}
+
+static void add_to_batch(SDL_Texture *texture, const SDL_Rect *src, const SDL_FRect *dst, color_t color, float scale)
+{
+    if (texture != data.batch.texture || scale != data.batch.scale ||
+        data.disable_linear_filter != data.batch.disable_linear_filter || data.batch.num_quads == MAX_BATCH_QUADS) {
+        start_batch(texture, scale);
+    }
+    if (!color) {
+        color = COLOR_MASK_NONE;
+    }
+    SDL_Color vertex_color = {
+        (color & COLOR_CHANNEL_RED) >> COLOR_BITSHIFT_RED,
+        (color & COLOR_CHANNEL_GREEN) >> COLOR_BITSHIFT_GREEN,
+        (color & COLOR_CHANNEL_BLUE) >> COLOR_BITSHIFT_BLUE,
+        (color & COLOR_CHANNEL_ALPHA) >> COLOR_BITSHIFT_ALPHA
+    };
+    float left = (float) src->x;
+    float top = (float) src->y;
+    float right = (float) (src->x + src->w);
+    float bottom = (float) (src->y + src->h);
+    SDL_Vertex *vertices = &data.batch.vertices[data.batch.num_quads * 4];
+    set_vertex(&vertices[0], dst->x, dst->y, left, top, vertex_color);
+    set_vertex(&vertices[1], dst->x + dst->w, dst->y, right, top, vertex_color);
+    set_vertex(&vertices[2], dst->x, dst->y + dst->h, left, bottom, vertex_color);
+    set_vertex(&vertices[3], dst->x + dst->w, dst->y + dst->h, right, bottom, vertex_color);
+    data.batch.num_quads++;
+    data.frame_stats.sprites++;
+}
+#endif
+
 static void draw_texture_advanced(const image *img, float x, float y, color_t color,
     float scale_x, float scale_y, double angle, int disable_coord_scaling)
 {
@@ -518,8 +638,6 @@ static void draw_texture_advanced(const image *img, float x, float y, color_t co
 
     float scale = scale_x == scale_y ? scale_x : 0.0f;
 
-    set_texture_color_and_scale_mode(texture, color, scale);
-
     x += img->x_offset;
     y += img->y_offset;
 
@@ -536,6 +654,24 @@ static void draw_texture_advanced(const image *img, float x, float y, color_t co
     float coord_scale_x = disable_coord_scaling ? 1.0f : scale_x;
     float coord_scale_y = disable_coord_scaling ? 1.0f : scale_y;
 
+#ifdef USE_RENDER_GEOMETRY
+    // Rotated sprites are rare enough to be drawn on their own
+    if (HAS_RENDER_GEOMETRY && angle == 0.0) {
+        SDL_FRect dst_coords = {
+            (x + grid_correction) / coord_scale_x,
+            (y + grid_correction) / coord_scale_y,
+            (img->width - grid_correction) / scale_x,
+            (img->height - grid_correction) / scale_y
+        };
+        add_to_batch(texture, &src_coords, &dst_coords, color, scale);
+        return;
+    }
+#endif
+
+    flush_batch();
+    set_texture_color_and_scale_mode(texture, color, scale);
+    data.frame_stats.draw_calls++;
+
 #ifdef USE_RENDERCOPYF
     if (HAS_RENDERCOPYF) {
         SDL_FRect dst_coords = {
@@ -568,6 +704,7 @@ static void create_custom_texture(custom_image_type type, int width, int height,
     if (data.paused) {
         return;
     }
+    flush_batch();
     if (data.custom_textures[type].texture) {
         SDL_DestroyTexture(data.custom_textures[type].texture);
         data.custom_textures[type].texture = 0;
@@ -594,6 +731,7 @@ static color_t *get_custom_texture_buffer(custom_image_type type, int *actual_te
     if (data.paused || !data.custom_textures[type].texture) {
         return 0;
     }
+    flush_batch();
 
 #ifdef __vita__
     int pitch;
@@ -633,6 +771,7 @@ static void update_custom_texture(custom_image_type type)
     if (data.paused || !data.custom_textures[type].texture || !data.custom_textures[type].buffer) {
         return;
     }
+    flush_batch();
     int width;
     SDL_QueryTexture(data.custom_textures[type].texture, NULL, NULL, &width, NULL);
     SDL_UpdateTexture(data.custom_textures[type].texture, NULL,
@@ -640,12 +779,28 @@ static void update_custom_texture(custom_image_type type)
 #endif
 }
 
+static void update_custom_texture_rect(custom_image_type type, int x, int y, int width, int height)
+{
+#ifndef __vita__
+    if (data.paused || !data.custom_textures[type].texture || !data.custom_textures[type].buffer) {
+        return;
+    }
+    flush_batch();
+    int texture_width;
+    SDL_QueryTexture(data.custom_textures[type].texture, NULL, NULL, &texture_width, NULL);
+    SDL_Rect rect = { x, y, width, height };
+    SDL_UpdateTexture(data.custom_textures[type].texture, &rect,
+        &data.custom_textures[type].buffer[y * texture_width + x], sizeof(color_t) * texture_width);
+#endif
+}
+
 static void update_custom_texture_from(custom_image_type type, const color_t *buffer,
     int x_offset, int y_offset, int width, int height)
 {
     if (data.paused || !data.custom_textures[type].texture) {
         return;
     }
+    flush_batch();
     int texture_width, texture_height;
     SDL_QueryTexture(data.custom_textures[type].texture, NULL, NULL, &texture_width, &texture_height);
     if (x_offset + width > texture_width || y_offset + height > texture_height) {
@@ -674,6 +829,7 @@ static void update_custom_texture_yuv(custom_image_type type, const uint8_t *y_d
     if (data.paused || !data.supports_yuv_textures || !data.custom_textures[type].texture) {
         return;
     }
+    flush_batch();
     int width, height;
     Uint32 format;
     SDL_QueryTexture(data.custom_textures[type].texture, &format, NULL, &width, &height);
@@ -691,6 +847,7 @@ static int start_tooltip_creation(int width, int height)
     if (data.paused) {
         return 0;
     }
+    flush_batch();
     if (data.tooltip.texture) {
         if (data.tooltip.texture_width < width || data.tooltip.texture_height < height) {
             SDL_DestroyTexture(data.tooltip.texture);
@@ -728,6 +885,7 @@ static void finish_tooltip_creation(void)
     if (data.paused) {
         return;
     }
+    flush_batch();
     SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "nearest");
     SDL_SetRenderTarget(data.renderer, data.render_texture);
 }
@@ -766,6 +924,7 @@ static int save_to_texture(int texture_id, int x, int y, int width, int height)
     if (data.paused) {
         return 0;
     }
+    flush_batch();
     SDL_Texture *former_target = SDL_GetRenderTarget(data.renderer);
     if (!former_target) {
         return 0;
@@ -841,6 +1000,7 @@ static void draw_saved_texture(int texture_id, int x, int y)
     if (data.paused) {
         return;
     }
+    flush_batch();
     buffer_texture *texture_info = get_saved_texture_info(texture_id);
     if (!texture_info) {
         return;
@@ -848,10 +1008,12 @@ static void draw_saved_texture(int texture_id, int x, int y)
     SDL_Rect src_coords = { 0, 0, texture_info->width, texture_info->height };
     SDL_Rect dst_coords = { x, y, texture_info->width, texture_info->height };
     SDL_RenderCopy(data.renderer, texture_info->texture, &src_coords, &dst_coords);
+    data.frame_stats.draw_calls++;
 }
 
 static void create_blend_texture(custom_image_type type)
 {
+    flush_batch();
     SDL_Texture *texture = SDL_CreateTexture(data.renderer, SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_TARGET, 58, 30);
     if (!texture) {
         return;
@@ -908,6 +1070,7 @@ static SDL_Texture *get_silhouette_texture(const image *img)
             return silhouette->texture;
         }
     }
+    flush_batch();
     SDL_Texture *texture = SDL_CreateTexture(data.renderer, SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_TARGET,
         img->width, img->height);
     if (!texture) {
@@ -990,12 +1153,14 @@ static SDL_Texture *get_silhouette_texture(const image *img)
 
 static void draw_silhouetted_texture(const image *img, int x, int y, color_t color, float scale)
 {
+    flush_batch();
     SDL_Texture *texture = get_silhouette_texture(img);
     if (!texture) {
         return;
     }
 
     set_texture_color_and_scale_mode(texture, color, scale);
+    data.frame_stats.draw_calls++;
 
     x += img->x_offset;
     y += img->y_offset;
@@ -1047,6 +1212,7 @@ static void load_unpacked_image(const image *img, const color_t *pixels)
     if (data.paused) {
         return;
     }
+    flush_batch();
     int first_empty = -1;
     int oldest_texture_index = 0;
     int unpacked_image_id = img->atlas.id & IMAGE_ATLAS_BIT_MASK;
@@ -1107,6 +1273,7 @@ static void load_unpacked_image(const image *img, const color_t *pixels)
 
 static void free_unpacked_image(const image *img)
 {
+    flush_batch();
     int unpacked_image_id = img->atlas.id & IMAGE_ATLAS_BIT_MASK;
     int found_id = -1;
     for (int i = 0; i < MAX_UNPACKED_IMAGES; i++) {
@@ -1131,6 +1298,7 @@ static int should_pack_image(int width, int height)
 
 static void update_scale(int city_scale)
 {
+    flush_batch();
     // The renderer draws the textures off-by-one when "scale * 100" is a multiple of 8, or when zooming out enough,
     // this fixes that rendering bug by properly offseting the textures
     data.should_correct_texture_offset = (city_scale > 250 && (city_scale % 100) != 0) || (city_scale % 8) == 0;
@@ -1160,6 +1328,7 @@ static void create_renderer_interface(void)
     data.renderer_interface.get_custom_image_buffer = get_custom_texture_buffer;
     data.renderer_interface.release_custom_image_buffer = release_custom_texture_buffer;
     data.renderer_interface.update_custom_image = update_custom_texture;
+    data.renderer_interface.update_custom_image_rect = update_custom_texture_rect;
     data.renderer_interface.update_custom_image_from = update_custom_texture_from;
     data.renderer_interface.update_custom_image_yuv = update_custom_texture_yuv;
     data.renderer_interface.draw_custom_image = draw_custom_texture;
@@ -1244,6 +1413,9 @@ int platform_renderer_init(SDL_Window *window)
 
     SDL_SetRenderDrawColor(data.renderer, 0, 0, 0, 0xff);
 
+#ifdef USE_RENDER_GEOMETRY
+    init_batch_indices();
+#endif
     create_renderer_interface();
 
     return 1;
@@ -1266,6 +1438,7 @@ int platform_renderer_create_render_texture(int width, int height)
     if (data.paused) {
         return 1;
     }
+    flush_batch();
     destroy_render_texture();
 
 #ifdef USE_TEXTURE_SCALE_MODE
@@ -1323,6 +1496,7 @@ int platform_renderer_lost_render_texture(void)
 
 void platform_renderer_invalidate_target_textures(void)
 {
+    flush_batch();
     if (data.custom_textures[CUSTOM_IMAGE_RED_FOOTPRINT].texture) {
         SDL_DestroyTexture(data.custom_textures[CUSTOM_IMAGE_RED_FOOTPRINT].texture);
         data.custom_textures[CUSTOM_IMAGE_RED_FOOTPRINT].texture = 0;
@@ -1392,6 +1566,7 @@ void platform_renderer_render(void)
     if (data.paused) {
         return;
     }
+    flush_batch();
     SDL_SetRenderTarget(data.renderer, NULL);
     SDL_RenderCopy(data.renderer, data.render_texture, NULL, NULL);
     draw_tooltip();
@@ -1400,6 +1575,13 @@ void platform_renderer_render(void)
     }
     SDL_RenderPresent(data.renderer);
     SDL_SetRenderTarget(data.renderer, data.render_texture);
+    data.last_frame_stats = data.frame_stats;
+    memset(&data.frame_stats, 0, sizeof(data.frame_stats));
+}
+
+const platform_renderer_frame_stats *platform_renderer_get_frame_stats(void)
+{
+    return &data.last_frame_stats;
 }
 
 void platform_renderer_generate_mouse_cursor_texture(int cursor_id, int size, const color_t *pixels,
@@ -1427,6 +1609,7 @@ void platform_renderer_generate_mouse_cursor_texture(int cursor_id, int size, co
 
 void platform_renderer_pause(void)
 {
+    flush_batch();
     SDL_SetRenderTarget(data.renderer, NULL);
     data.paused = 1;
 }
@@ -1440,6 +1623,7 @@ void platform_renderer_resume(void)
 
 void platform_renderer_destroy(void)
 {
+    flush_batch();
     destroy_render_texture();
     if (data.renderer) {
         SDL_DestroyRenderer(data.renderer);
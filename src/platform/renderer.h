@@ -5,6 +5,12 @@
 
 #include "SDL.h"
 
+typedef struct {
+    int draw_calls; /**< Render calls issued to SDL, each batch counting as one */
+    int batches; /**< Batches of sprites drawn with a single call */
+    int sprites; /**< Sprites drawn as part of a batch */
+} platform_renderer_frame_stats;
+
 int platform_renderer_init(SDL_Window *window);
 
 int platform_renderer_create_render_texture(int width, int height);
@@ -20,6 +26,12 @@ void platform_renderer_clear(void);
 
 void platform_renderer_render(void);
 
+/**
+ * Gets the drawing statistics of the last rendered frame
+ * @return The statistics
+ */
+const platform_renderer_frame_stats *platform_renderer_get_frame_stats(void);
+
 void platform_renderer_pause(void);
 
 void platform_renderer_resume(void);
@@ -27,6 +27,9 @@
 
 #define NO_CHANNEL -1
 
+#define MAX_CACHED_CHUNKS 128
+#define MAX_CACHED_CHUNK_BYTES (32 * 1024 * 1024)
+
 #if SDL_VERSION_ATLEAST(2, 0, 7)
 #define USE_SDL_AUDIOSTREAM
 #endif
@@ -46,6 +49,22 @@ typedef struct {
     time_millis last_played;
 } sound_channel;
 
+typedef struct {
+    char filename[FILE_NAME_MAX]; // As requested, empty for sounds that were loaded before a flush
+    Mix_Chunk *chunk;
+    time_millis last_used;
+} cached_chunk;
+
+// Decoded sounds, shared by all channels, so sounds that play often are not read and decoded every time.
+// Which file a name resolves to depends on the language directory and the campaign, so the cache
+// is flushed when either of them changes.
+static struct {
+    cached_chunk entries[MAX_CACHED_CHUNKS];
+    size_t total_bytes;
+    char language_dir[FILE_NAME_MAX];
+    char campaign[FILE_NAME_MAX];
+} chunk_cache;
+
 static struct {
     int initialized;
     uint8_t *custom_music;
@@ -149,6 +168,22 @@ void sound_device_open(void)
     }
 }
 
+static void free_cached_chunk(cached_chunk *entry)
+{
+    chunk_cache.total_bytes -= entry->chunk->alen;
+    Mix_FreeChunk(entry->chunk);
+    entry->chunk = 0;
+}
+
+static void clear_chunk_cache(void)
+{
+    for (int i = 0; i < MAX_CACHED_CHUNKS; i++) {
+        if (chunk_cache.entries[i].chunk) {
+            free_cached_chunk(&chunk_cache.entries[i]);
+        }
+    }
+}
+
 static void stop_channel(int channel)
 {
     if (!data.initialized) {
@@ -157,7 +192,6 @@ static void stop_channel(int channel)
     sound_channel *ch = &data.channels[channel];
     if (ch->chunk) {
         Mix_HaltChannel(channel);
-        Mix_FreeChunk(ch->chunk);
         ch->chunk = 0;
     }
     ch->filename[0] = 0;
@@ -173,6 +207,7 @@ void sound_device_close(void)
         stop_channel(i);
     }
     Mix_ChannelFinished(NULL);
+    clear_chunk_cache();
     Mix_CloseAudio();
     free(data.channels);
     data.channels = 0;
@@ -180,33 +215,140 @@ void sound_device_close(void)
     data.initialized = 0;
 }
 
-static Mix_Chunk *load_chunk(const char *filename)
+static Mix_Chunk *load_chunk_from_campaign(const char *filename)
 {
-    if (!filename || !*filename) {
-        return 0;
-    }
     size_t size;
     uint8_t *audio_data = game_campaign_load_file(filename, &size);
-    if (audio_data) {
-        SDL_RWops *sdl_memory = SDL_RWFromMem(audio_data, (int) size);
-        return Mix_LoadWAV_RW(sdl_memory, SDL_TRUE);
-    }
-    filename = dir_get_file(filename, MAY_BE_LOCALIZED);
-    if (!filename) {
+    if (!audio_data) {
         return 0;
     }
+    SDL_RWops *sdl_memory = SDL_RWFromMem(audio_data, (int) size);
+    return Mix_LoadWAV_RW(sdl_memory, SDL_TRUE);
+}
+
+static Mix_Chunk *load_chunk_from_file(const char *path)
+{
 #if defined(__vita__) || defined(__ANDROID__)
-    FILE *fp = file_open(filename, "rb");
+    FILE *fp = file_open(path, "rb");
     if (!fp) {
         return NULL;
     }
     SDL_RWops *sdl_fp = SDL_RWFromFP(fp, SDL_TRUE);
     return Mix_LoadWAV_RW(sdl_fp, 1);
 #else
-    return Mix_LoadWAV(filename);
+    return Mix_LoadWAV(path);
 #endif
 }
 
+static cached_chunk *find_cached_chunk(const char *filename)
+{
+    for (int i = 0; i < MAX_CACHED_CHUNKS; i++) {
+        cached_chunk *entry = &chunk_cache.entries[i];
+        if (entry->chunk && strcmp(entry->filename, filename) == 0) {
+            return entry;
+        }
+    }
+    return 0;
+}
+
+static int is_chunk_on_channel(const Mix_Chunk *chunk)
+{
+    for (int i = 0; i < data.total_channels; i++) {
+        if (data.channels[i].chunk == chunk) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static cached_chunk *get_free_cache_entry(size_t bytes)
+{
+    cached_chunk *free_entry = 0;
+    while (1) {
+        cached_chunk *oldest = 0;
+        for (int i = 0; i < MAX_CACHED_CHUNKS; i++) {
+            cached_chunk *entry = &chunk_cache.entries[i];
+            if (!entry->chunk) {
+                if (!free_entry) {
+                    free_entry = entry;
+                }
+            } else if (!is_chunk_on_channel(entry->chunk) && (!oldest || entry->last_used < oldest->last_used)) {
+                oldest = entry;
+            }
+        }
+        // Sounds that are on a channel are never evicted, so the budget may be exceeded while they are
+        if (!oldest || (free_entry && chunk_cache.total_bytes + bytes <= MAX_CACHED_CHUNK_BYTES)) {
+            return free_entry;
+        }
+        free_cached_chunk(oldest);
+    }
+}
+
+static void flush_chunk_cache_if_source_changed(void)
+{
+    const char *language_dir = config_get_string(CONFIG_STRING_UI_LANGUAGE_DIR);
+    const char *campaign = game_campaign_get_name();
+    if (strcmp(chunk_cache.language_dir, language_dir) == 0 && strcmp(chunk_cache.campaign, campaign) == 0) {
+        return;
+    }
+    for (int i = 0; i < MAX_CACHED_CHUNKS; i++) {
+        cached_chunk *entry = &chunk_cache.entries[i];
+        if (!entry->chunk) {
+            continue;
+        }
+        if (is_chunk_on_channel(entry->chunk)) {
+            // Still playing: no longer found by name, and freed once it is the oldest
+            entry->filename[0] = 0;
+        } else {
+            free_cached_chunk(entry);
+        }
+    }
+    snprintf(chunk_cache.language_dir, FILE_NAME_MAX, "%s", language_dir);
+    snprintf(chunk_cache.campaign, FILE_NAME_MAX, "%s", campaign);
+}
+
+static Mix_Chunk *get_chunk(const char *filename)
+{
+    if (!filename || !*filename) {
+        return 0;
+    }
+    flush_chunk_cache_if_source_changed();
+    cached_chunk *entry = find_cached_chunk(filename);
+    if (entry) {
+        entry->last_used = time_get_millis();
+        return entry->chunk;
+    }
+    Mix_Chunk *chunk;
+    if (game_campaign_has_file(filename)) {
+        chunk = load_chunk_from_campaign(filename);
+    } else {
+        const char *path = dir_get_file(filename, MAY_BE_LOCALIZED);
+        chunk = path ? load_chunk_from_file(path) : 0;
+    }
+    if (!chunk) {
+        return 0;
+    }
+    entry = get_free_cache_entry(chunk->alen);
+    if (!entry) {
+        Mix_FreeChunk(chunk);
+        return 0;
+    }
+    snprintf(entry->filename, FILE_NAME_MAX, "%s", filename);
+    entry->chunk = chunk;
+    entry->last_used = time_get_millis();
+    chunk_cache.total_bytes += chunk->alen;
+    return chunk;
+}
+
+void sound_device_preload_file(const char *filename)
+{
+    if (!data.initialized || !config_get(CONFIG_GENERAL_ENABLE_AUDIO) ||
+        chunk_cache.total_bytes >= MAX_CACHED_CHUNK_BYTES) {
+        return;
+    }
+    get_chunk(filename);
+}
+
 static void callback_for_audio_finished(int channel)
 {
     if (!data.sound_finished_callback) {
@@ -275,9 +417,7 @@ void sound_device_set_volume_for_type(sound_type type, int volume_pct)
     }
     for (int i = 0; i < sound_type_to_channels[type].total; i++) {
         int channel = i + sound_type_to_channels[type].start;
-        if (data.channels[channel].chunk) {
-            Mix_VolumeChunk(data.channels[channel].chunk, percentage_to_volume(volume_pct));
-        }
+        Mix_Volume(channel, percentage_to_volume(volume_pct));
     }
 }
 
@@ -432,14 +572,15 @@ int sound_device_play_file_on_channel_panned(const char *filename, sound_type ty
             return 0;
         }
         stop_channel(channel);
-        data.channels[channel].chunk = load_chunk(filename);
+        data.channels[channel].chunk = get_chunk(filename);
         if (!data.channels[channel].chunk) {
             return 0;
         }
         snprintf(data.channels[channel].filename, FILE_NAME_MAX, "%s", filename);
     }
     Mix_SetPanning(channel, left_pct * 255 / 100, right_pct * 255 / 100);
-    Mix_VolumeChunk(data.channels[channel].chunk, percentage_to_volume(volume_pct));
+    // The chunk may be shared with other channels, so the volume is set on the channel
+    Mix_Volume(channel, percentage_to_volume(volume_pct));
     int result = Mix_PlayChannel(channel, data.channels[channel].chunk, 0);
     if (result == -1) {
         return 0;
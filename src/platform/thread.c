@@ -0,0 +1,56 @@
+#include "core/thread.h"
+
+#include "SDL.h"
+
+#include <stdlib.h>
+
+struct thread_handle {
+    SDL_Thread *thread;
+    SDL_atomic_t finished;
+    int (*function)(void *data);
+    void *data;
+};
+
+static int SDLCALL run_thread(void *data)
+{
+    thread_handle *thread = data;
+    int result = thread->function(thread->data);
+    SDL_AtomicSet(&thread->finished, 1);
+    return result;
+}
+
+thread_handle *thread_create(const char *name, int (*function)(void *data), void *data)
+{
+    thread_handle *thread = malloc(sizeof(thread_handle));
+    if (!thread) {
+        return 0;
+    }
+    thread->function = function;
+    thread->data = data;
+    SDL_AtomicSet(&thread->finished, 0);
+    thread->thread = SDL_CreateThread(run_thread, name, thread);
+    if (!thread->thread) {
+        free(thread);
+        return 0;
+    }
+    return thread;
+}
+
+int thread_is_finished(thread_handle *thread)
+{
+    return SDL_AtomicGet(&thread->finished);
+}
+
+int thread_wait(thread_handle *thread)
+{
+    int result = 0;
+    SDL_WaitThread(thread->thread, &result);
+    free(thread);
+    return result;
+}
+
+int thread_get_cpu_count(void)
+{
+    int count = SDL_GetCPUCount();
+    return count > 0 ? count : 1;
+}
@@ -130,6 +130,15 @@ static struct {
     }
 };
 
+static void preload_sounds(background_sound *sounds, int first, int max)
+{
+    for (int sound = first; sound < max; sound++) {
+        for (int i = 0; i < sounds[sound].filenames.total; i++) {
+            sound_device_preload_file(sounds[sound].filenames.list[i]);
+        }
+    }
+}
+
 void sound_city_init(void)
 {
     data.last_update_time = time_get_millis();
@@ -149,6 +158,11 @@ void sound_city_init(void)
         current_sound->filenames.current = 0;
         memset(current_sound->direction_views, 0, sizeof(current_sound->direction_views));
     }
+    // City sounds keep recycling the same few channels, so decode them all while the game loads
+    if (setting_sound(SOUND_TYPE_CITY)->enabled) {
+        preload_sounds(data.city_sounds, SOUND_CITY_FIRST, SOUND_CITY_MAX);
+        preload_sounds(data.ambient_sounds, SOUND_AMBIENT_FIRST, SOUND_AMBIENT_MAX);
+    }
 }
 
 void sound_city_set_volume(int percentage)
@@ -24,6 +24,14 @@ int sound_device_play_track(const char *filename, int volume_pct, void (*on_fini
 int sound_device_play_file_on_channel_panned(const char *filename, sound_type type,
     int volume_pct, int left_pct, int right_pct);
 int sound_device_play_file_on_channel(const char *filename, sound_type type, int volume_pct);
+
+/**
+ * Decodes a sound ahead of time, so it plays without reading it from disk.
+ * Nothing is loaded if the memory budget for decoded sounds is already used up.
+ * @param filename The sound file
+ */
+void sound_device_preload_file(const char *filename);
+
 int sound_device_pause_music(void);
 int sound_device_resume_music(void);
 void sound_device_stop_music(void);
@@ -1599,6 +1599,7 @@ typedef enum {
     TR_BUILDING_LATRINES_MISSING_DEVOLVE,
     TR_BUILDING_LATRINES_NO_WORKERS,
     TR_CONFIG_DRAW_ASCLEPIUS,
+    TR_WARNING_SCREENSHOT_WRITING,
     TRANSLATION_MAX_KEY
 } translation_key;
 
@@ -15,6 +15,7 @@
 #include "figure/formation_legion.h"
 #include "figure/roamer_preview.h"
 #include "game/cheats.h"
+#include "game/journal.h"
 #include "game/settings.h"
 #include "game/state.h"
 #include "graphics/button.h"
@@ -49,6 +50,10 @@ static struct {
     int new_start_grid_offset;
     int capture_input;
     int routing_grid_offset;
+    struct {
+        map_tile start;
+        map_tile end;
+    } construction;
 } data;
 
 void set_city_clip_rectangle(void)
@@ -321,6 +326,8 @@ static void build_start(const map_tile *tile)
 {
     if (tile->grid_offset) { // Allow building on paused
         building_construction_start(tile->x, tile->y, tile->grid_offset);
+        data.construction.start = *tile;
+        data.construction.end = *tile;
     }
 }
 
@@ -330,6 +337,9 @@ static void build_move(const map_tile *tile)
         return;
     }
     building_construction_update(tile->x, tile->y, tile->grid_offset);
+    if (tile->grid_offset) {
+        data.construction.end = *tile;
+    }
 }
 
 static void build_end(void)
@@ -338,6 +348,8 @@ static void build_end(void)
         if (building_construction_type() != BUILDING_NONE) {
             sound_effect_play(SOUND_EFFECT_BUILD);
         }
+        game_journal_record_construction(data.construction.start.x, data.construction.start.y,
+            data.construction.end.x, data.construction.end.y);
         building_construction_place();
         widget_minimap_invalidate();
     }
@@ -689,8 +701,10 @@ static void military_map_click(int legion_formation_id, const map_tile *tile)
     }
     int other_formation_id = formation_legion_at_building(tile->grid_offset);
     if (other_formation_id && other_formation_id == legion_formation_id) {
+        game_journal_record(JOURNAL_LEGION_RETURN_HOME, m->id);
         formation_legion_return_home(m);
     } else {
+        game_journal_record(JOURNAL_LEGION_MOVE, m->id, tile->x, tile->y);
         formation_legion_move_to(m, tile);
         sound_speech_play_file("wavs/cohort5.wav");
     }
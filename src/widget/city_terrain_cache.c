@@ -0,0 +1,309 @@
+#include "city_terrain_cache.h"
+
+#include "city/view.h"
+#include "core/config.h"
+#include "graphics/graphics.h"
+#include "scenario/property.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CHUNK_WIDTH 240
+#define CHUNK_HEIGHT 120
+#define MIN_CACHED_CHUNKS 256
+
+#define HASH_START 2166136261u
+#define HASH_PRIME 16777619u
+
+typedef struct {
+    int in_use;
+    int x;
+    int y;
+    uint32_t key;
+    int image_id;
+    unsigned int last_used;
+} cached_chunk;
+
+typedef struct {
+    uint32_t key;
+    int is_fully_visible;
+    cached_chunk *cached;
+} visible_chunk;
+
+static struct {
+    int is_active;
+    unsigned int frame;
+    struct {
+        int orientation;
+        int climate;
+        int show_grid;
+    } view;
+    struct {
+        int x;
+        int y;
+        int camera_x;
+        int camera_y;
+    } viewport;
+    struct {
+        int x;
+        int y;
+        int width;
+        int height;
+    } chunks;
+    visible_chunk *visible;
+    int visible_size;
+    cached_chunk *cached;
+    int cached_size;
+} data;
+
+static int floor_divide(int value, int divisor)
+{
+    return value >= 0 ? value / divisor : -((divisor - 1 - value) / divisor);
+}
+
+void city_terrain_cache_invalidate(void)
+{
+    for (int i = 0; i < data.cached_size; i++) {
+        data.cached[i].in_use = 0;
+    }
+}
+
+static void check_view_changed(void)
+{
+    int orientation = city_view_orientation();
+    int climate = scenario_property_climate();
+    int show_grid = config_get(CONFIG_UI_SHOW_GRID);
+    if (data.view.orientation != orientation || data.view.climate != climate || data.view.show_grid != show_grid) {
+        city_terrain_cache_invalidate();
+        data.view.orientation = orientation;
+        data.view.climate = climate;
+        data.view.show_grid = show_grid;
+    }
+}
+
+static int ensure_visible_size(int size)
+{
+    if (size <= data.visible_size) {
+        return 1;
+    }
+    visible_chunk *visible = realloc(data.visible, size * sizeof(visible_chunk));
+    if (!visible) {
+        return 0;
+    }
+    data.visible = visible;
+    data.visible_size = size;
+    return 1;
+}
+
+static int ensure_cached_size(int size)
+{
+    if (size < MIN_CACHED_CHUNKS) {
+        size = MIN_CACHED_CHUNKS;
+    }
+    if (size <= data.cached_size) {
+        return 1;
+    }
+    cached_chunk *cached = realloc(data.cached, size * sizeof(cached_chunk));
+    if (!cached) {
+        return 0;
+    }
+    memset(&cached[data.cached_size], 0, (size - data.cached_size) * sizeof(cached_chunk));
+    data.cached = cached;
+    data.cached_size = size;
+    return 1;
+}
+
+int city_terrain_cache_begin_frame(void)
+{
+    data.is_active = 0;
+    if (city_view_get_scale() != 100) {
+        return 0;
+    }
+    check_view_changed();
+
+    int x, y, width, height;
+    city_view_get_viewport(&x, &y, &width, &height);
+    int camera_x, camera_y;
+    city_view_get_camera_in_pixels(&camera_x, &camera_y);
+    if (width <= 0 || height <= 0) {
+        return 0;
+    }
+    data.viewport.x = x;
+    data.viewport.y = y;
+    data.viewport.camera_x = camera_x;
+    data.viewport.camera_y = camera_y;
+
+    data.chunks.x = floor_divide(camera_x, CHUNK_WIDTH);
+    data.chunks.y = floor_divide(camera_y, CHUNK_HEIGHT);
+    data.chunks.width = floor_divide(camera_x + width - 1, CHUNK_WIDTH) - data.chunks.x + 1;
+    data.chunks.height = floor_divide(camera_y + height - 1, CHUNK_HEIGHT) - data.chunks.y + 1;
+    // Keep a ring of chunks around the visible ones, so that scrolling does not evict chunks still in view
+    if (!ensure_visible_size(data.chunks.width * data.chunks.height) ||
+        !ensure_cached_size((data.chunks.width + 2) * (data.chunks.height + 2))) {
+        return 0;
+    }
+    for (int chunk_y = 0; chunk_y < data.chunks.height; chunk_y++) {
+        int city_y = (data.chunks.y + chunk_y) * CHUNK_HEIGHT;
+        int fits_y = city_y >= camera_y && city_y + CHUNK_HEIGHT <= camera_y + height;
+        for (int chunk_x = 0; chunk_x < data.chunks.width; chunk_x++) {
+            int city_x = (data.chunks.x + chunk_x) * CHUNK_WIDTH;
+            visible_chunk *chunk = &data.visible[chunk_y * data.chunks.width + chunk_x];
+            chunk->key = HASH_START;
+            chunk->is_fully_visible = fits_y && city_x >= camera_x && city_x + CHUNK_WIDTH <= camera_x + width;
+            chunk->cached = 0;
+        }
+    }
+    data.frame++;
+    data.is_active = 1;
+    return 1;
+}
+
+static int get_chunk_range(int x, int y, int width, int height, int *x_min, int *y_min, int *x_max, int *y_max)
+{
+    int city_x = x - data.viewport.x + data.viewport.camera_x;
+    int city_y = y - data.viewport.y + data.viewport.camera_y;
+    *x_min = floor_divide(city_x, CHUNK_WIDTH) - data.chunks.x;
+    *y_min = floor_divide(city_y, CHUNK_HEIGHT) - data.chunks.y;
+    *x_max = floor_divide(city_x + width - 1, CHUNK_WIDTH) - data.chunks.x;
+    *y_max = floor_divide(city_y + height - 1, CHUNK_HEIGHT) - data.chunks.y;
+    if (*x_min < 0) {
+        *x_min = 0;
+    }
+    if (*y_min < 0) {
+        *y_min = 0;
+    }
+    if (*x_max >= data.chunks.width) {
+        *x_max = data.chunks.width - 1;
+    }
+    if (*y_max >= data.chunks.height) {
+        *y_max = data.chunks.height - 1;
+    }
+    return *x_min <= *x_max && *y_min <= *y_max;
+}
+
+void city_terrain_cache_add_tile(int x, int y, int width, int height, const int *values, int num_values)
+{
+    if (!data.is_active) {
+        return;
+    }
+    int x_min, y_min, x_max, y_max;
+    if (!get_chunk_range(x, y, width, height, &x_min, &y_min, &x_max, &y_max)) {
+        return;
+    }
+    uint32_t tile_key = HASH_START;
+    for (int i = 0; i < num_values; i++) {
+        tile_key = (tile_key ^ (uint32_t) values[i]) * HASH_PRIME;
+    }
+    for (int chunk_y = y_min; chunk_y <= y_max; chunk_y++) {
+        for (int chunk_x = x_min; chunk_x <= x_max; chunk_x++) {
+            visible_chunk *chunk = &data.visible[chunk_y * data.chunks.width + chunk_x];
+            chunk->key = (chunk->key ^ tile_key) * HASH_PRIME;
+        }
+    }
+}
+
+static cached_chunk *find_cached_chunk(int x, int y, uint32_t key)
+{
+    for (int i = 0; i < data.cached_size; i++) {
+        cached_chunk *cached = &data.cached[i];
+        if (cached->in_use && cached->x == x && cached->y == y && cached->key == key) {
+            return cached;
+        }
+    }
+    return 0;
+}
+
+void city_terrain_cache_lookup_chunks(void)
+{
+    if (!data.is_active) {
+        return;
+    }
+    for (int chunk_y = 0; chunk_y < data.chunks.height; chunk_y++) {
+        for (int chunk_x = 0; chunk_x < data.chunks.width; chunk_x++) {
+            visible_chunk *chunk = &data.visible[chunk_y * data.chunks.width + chunk_x];
+            if (!chunk->is_fully_visible) {
+                continue;
+            }
+            chunk->cached = find_cached_chunk(data.chunks.x + chunk_x, data.chunks.y + chunk_y, chunk->key);
+            if (chunk->cached) {
+                chunk->cached->last_used = data.frame;
+            }
+        }
+    }
+}
+
+int city_terrain_cache_is_cached(int x, int y, int width, int height)
+{
+    if (!data.is_active) {
+        return 0;
+    }
+    int x_min, y_min, x_max, y_max;
+    if (!get_chunk_range(x, y, width, height, &x_min, &y_min, &x_max, &y_max)) {
+        // Outside the viewport
+        return 1;
+    }
+    for (int chunk_y = y_min; chunk_y <= y_max; chunk_y++) {
+        for (int chunk_x = x_min; chunk_x <= x_max; chunk_x++) {
+            if (!data.visible[chunk_y * data.chunks.width + chunk_x].cached) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+static cached_chunk *get_free_cached_chunk(void)
+{
+    cached_chunk *oldest = 0;
+    for (int i = 0; i < data.cached_size; i++) {
+        cached_chunk *cached = &data.cached[i];
+        if (!cached->in_use) {
+            return cached;
+        }
+        // Chunks drawn this frame must not be replaced
+        if (cached->last_used != data.frame && (!oldest || cached->last_used < oldest->last_used)) {
+            oldest = cached;
+        }
+    }
+    return oldest;
+}
+
+static void save_chunk(visible_chunk *chunk, int chunk_x, int chunk_y, int x, int y)
+{
+    cached_chunk *cached = get_free_cached_chunk();
+    if (!cached) {
+        return;
+    }
+    cached->in_use = 0;
+    int image_id = graphics_save_to_image(cached->image_id, x, y, CHUNK_WIDTH, CHUNK_HEIGHT);
+    if (!image_id) {
+        return;
+    }
+    cached->in_use = 1;
+    cached->x = chunk_x;
+    cached->y = chunk_y;
+    cached->key = chunk->key;
+    cached->image_id = image_id;
+    cached->last_used = data.frame;
+}
+
+void city_terrain_cache_end_frame(void)
+{
+    if (!data.is_active) {
+        return;
+    }
+    for (int chunk_y = 0; chunk_y < data.chunks.height; chunk_y++) {
+        int y = (data.chunks.y + chunk_y) * CHUNK_HEIGHT - data.viewport.camera_y + data.viewport.y;
+        for (int chunk_x = 0; chunk_x < data.chunks.width; chunk_x++) {
+            int x = (data.chunks.x + chunk_x) * CHUNK_WIDTH - data.viewport.camera_x + data.viewport.x;
+            visible_chunk *chunk = &data.visible[chunk_y * data.chunks.width + chunk_x];
+            if (chunk->cached) {
+                graphics_draw_from_image(chunk->cached->image_id, x, y);
+            } else if (chunk->is_fully_visible) {
+                save_chunk(chunk, data.chunks.x + chunk_x, data.chunks.y + chunk_y, x, y);
+            }
+        }
+    }
+    data.is_active = 0;
+}
@@ -0,0 +1,57 @@
+#ifndef WIDGET_CITY_TERRAIN_CACHE_H
+#define WIDGET_CITY_TERRAIN_CACHE_H
+
+/**
+ * @file
+ * Cache of the terrain footprints of the city, saved in chunks of a fixed size in city pixels.
+ *
+ * Every frame, the footprints of the visible tiles are added to the chunks they overlap, which
+ * gives each chunk a key describing its contents. Chunks whose key matches a saved one are drawn
+ * from the saved image, so only the tiles that overlap a changed chunk need to be drawn.
+ * Only the 100% zoom level is cached.
+ */
+
+/**
+ * Starts a new frame. Must be called after the city viewport is cleared and before any footprint is drawn.
+ * @return Boolean true if the cache is in use for this frame
+ */
+int city_terrain_cache_begin_frame(void);
+
+/**
+ * Adds a tile footprint to the chunks it overlaps
+ * @param x The screen x coordinate of the footprint
+ * @param y The screen y coordinate of the footprint
+ * @param width The width of the footprint
+ * @param height The height of the footprint
+ * @param values The values that determine how the footprint is drawn
+ * @param num_values The number of values
+ */
+void city_terrain_cache_add_tile(int x, int y, int width, int height, const int *values, int num_values);
+
+/**
+ * Looks up the saved chunks once all the footprints of the frame were added
+ */
+void city_terrain_cache_lookup_chunks(void);
+
+/**
+ * Checks whether an area only overlaps chunks that will be drawn from the cache
+ * @param x The screen x coordinate of the area
+ * @param y The screen y coordinate of the area
+ * @param width The width of the area
+ * @param height The height of the area
+ * @return Boolean true if the area does not need to be drawn
+ */
+int city_terrain_cache_is_cached(int x, int y, int width, int height);
+
+/**
+ * Saves the changed chunks and draws the cached ones. Must be called after all the footprints that
+ * are not cached were drawn.
+ */
+void city_terrain_cache_end_frame(void);
+
+/**
+ * Discards all the saved chunks, for example when the renderer lost the contents of its textures
+ */
+void city_terrain_cache_invalidate(void);
+
+#endif // WIDGET_CITY_TERRAIN_CACHE_H
@@ -32,11 +32,13 @@
 #include "graphics/image.h"
 #include "graphics/renderer.h"
 #include "graphics/window.h"
+#include "map/aqueduct.h"
 #include "map/building.h"
 #include "map/figure.h"
 #include "map/grid.h"
 #include "map/image.h"
 #include "map/property.h"
+#include "map/random.h"
 #include "map/sprite.h"
 #include "map/terrain.h"
 #include "scenario/property.h"
@@ -45,10 +47,12 @@
 #include "widget/city_building_ghost.h"
 #include "widget/city_figure.h"
 #include "widget/city_draw_highway.h"
+#include "widget/city_terrain_cache.h"
 
 #define OFFSET(x,y) (x + GRID_SIZE * y)
 
 #define WAREHOUSE_FLAG_FRAMES 9
+#define HIGHWAY_CACHE_VALUES 76
 
 static const int ADJACENT_OFFSETS[2][4][7] = {
     {
@@ -140,21 +144,40 @@ static void draw_roamer_frequency(int x, int y, int grid_offset)
     }
 }
 
-static void draw_footprint(int x, int y, int grid_offset)
+static int get_footprint_image(int grid_offset, int building_id, color_t *color_mask)
+{
+    *color_mask = 0;
+    if (building_id && draw_building_as_deleted(building_get(building_id))) {
+        *color_mask = COLOR_MASK_RED;
+    }
+    if (map_property_is_constructing(grid_offset)) { //&&
+        //  !building_is_connectable(building_construction_type())) {
+        return image_group(GROUP_TERRAIN_OVERLAY);
+    }
+    return map_image_at(grid_offset);
+}
+
+static int is_highway_footprint(int grid_offset)
+{
+    return map_terrain_is(grid_offset, TERRAIN_HIGHWAY) && !map_terrain_is(grid_offset, TERRAIN_GATEHOUSE);
+}
+
+static int is_animated_water(int image_id)
+{
+    return image_id >= draw_context.image_id_water_first && image_id <= draw_context.image_id_water_last;
+}
+
+static int update_footprint(int x, int y, int grid_offset)
 {
     sound_city_progress_ambient();
     building_construction_record_view_position(x, y, grid_offset);
     if (grid_offset < 0 || !map_property_is_draw_tile(grid_offset)) {
-        return;
+        return 0;
     }
     // Valid grid_offset and leftmost tile -> draw
     int building_id = map_building_at(grid_offset);
-    color_t color_mask = 0;
     if (building_id) {
         building *b = building_get(building_id);
-        if (draw_building_as_deleted(b)) {
-            color_mask = COLOR_MASK_RED;
-        }
         int view_x, view_y, view_width, view_height;
         city_view_get_viewport(&view_x, &view_y, &view_width, &view_height);
 
@@ -177,21 +200,21 @@ static void draw_footprint(int x, int y, int grid_offset)
     if (map_terrain_is(grid_offset, TERRAIN_GARDEN)) {
         sound_city_mark_building_view(BUILDING_GARDENS, 0, SOUND_DIRECTION_CENTER);
     }
-    int image_id = map_image_at(grid_offset);
-    if (map_property_is_constructing(grid_offset)) { //&&
-        //  !building_is_connectable(building_construction_type())) {
-        image_id = image_group(GROUP_TERRAIN_OVERLAY);
-    }
-    if (draw_context.advance_water_animation &&
-        image_id >= draw_context.image_id_water_first &&
-        image_id <= draw_context.image_id_water_last) {
+    color_t color_mask;
+    int image_id = get_footprint_image(grid_offset, building_id, &color_mask);
+    if (draw_context.advance_water_animation && is_animated_water(image_id)) {
         image_id++;
         if (image_id > draw_context.image_id_water_last) {
             image_id = draw_context.image_id_water_first;
         }
         map_image_set(grid_offset, image_id);
     }
-    if (map_terrain_is(grid_offset, TERRAIN_HIGHWAY) && !map_terrain_is(grid_offset, TERRAIN_GATEHOUSE)) {
+    return 1;
+}
+
+static void draw_footprint_image(int x, int y, int grid_offset, int building_id, int image_id, color_t color_mask)
+{
+    if (is_highway_footprint(grid_offset)) {
         city_draw_highway_footprint(x, y, draw_context.scale, grid_offset);
     } else {
         image_draw_isometric_footprint_from_draw_tile(image_id, x, y, color_mask, draw_context.scale);
@@ -206,6 +229,99 @@ static void draw_footprint(int x, int y, int grid_offset)
     draw_roamer_frequency(x, y, grid_offset);
 }
 
+static void draw_footprint(int x, int y, int grid_offset)
+{
+    if (!update_footprint(x, y, grid_offset)) {
+        return;
+    }
+    int building_id = map_building_at(grid_offset);
+    color_t color_mask;
+    int image_id = get_footprint_image(grid_offset, building_id, &color_mask);
+    draw_footprint_image(x, y, grid_offset, building_id, image_id, color_mask);
+}
+
+static void get_footprint_area(int x, int y, int grid_offset, int image_id,
+    int *area_x, int *area_y, int *area_width, int *area_height)
+{
+    int num_tiles = 1;
+    if (!is_highway_footprint(grid_offset)) {
+        num_tiles = (image_get(image_id)->width + 2) / (FOOTPRINT_WIDTH + 2);
+        if (num_tiles < 1) {
+            num_tiles = 1;
+        }
+    }
+    // Leave a small margin in case an image is slightly larger than its footprint
+    *area_x = x - 2;
+    *area_y = y - FOOTPRINT_HALF_HEIGHT * (num_tiles - 1) - 2;
+    *area_width = num_tiles * (FOOTPRINT_WIDTH + 2) + 4;
+    *area_height = num_tiles * FOOTPRINT_HEIGHT + 4;
+}
+
+static void add_footprint_to_cache(int x, int y, int grid_offset)
+{
+    if (!update_footprint(x, y, grid_offset)) {
+        return;
+    }
+    int building_id = map_building_at(grid_offset);
+    color_t color_mask;
+    int image_id = get_footprint_image(grid_offset, building_id, &color_mask);
+    // Animated water is drawn on top of the cached chunks, so its frame must not change their keys
+    int cached_image_id = is_animated_water(image_id) ? draw_context.image_id_water_first : image_id;
+    int values[HIGHWAY_CACHE_VALUES + 5] = {
+        grid_offset, cached_image_id, (int) color_mask, building_id != 0,
+        figure_roamer_preview_get_frequency(grid_offset)
+    };
+    int num_values = 5;
+    if (is_highway_footprint(grid_offset)) {
+        // The highway barriers depend on the roads and buildings up to two tiles away,
+        // and an aqueduct on the highway on whether it has water
+        values[num_values++] = map_random_get(grid_offset);
+        for (int dy = -2; dy <= 2; dy++) {
+            for (int dx = -2; dx <= 2; dx++) {
+                int offset = grid_offset + map_grid_delta(dx, dy);
+                int is_valid = map_grid_is_valid_offset(offset);
+                values[num_values++] = is_valid ? map_terrain_get(offset) : 0;
+                values[num_values++] = is_valid ? map_building_at(offset) : 0;
+                values[num_values++] = is_valid ? map_aqueduct_has_water_access_at(offset) : 0;
+            }
+        }
+    }
+    int area_x, area_y, area_width, area_height;
+    get_footprint_area(x, y, grid_offset, image_id, &area_x, &area_y, &area_width, &area_height);
+    city_terrain_cache_add_tile(area_x, area_y, area_width, area_height, values, num_values);
+}
+
+static void draw_uncached_footprint(int x, int y, int grid_offset)
+{
+    if (grid_offset < 0 || !map_property_is_draw_tile(grid_offset)) {
+        return;
+    }
+    int building_id = map_building_at(grid_offset);
+    color_t color_mask;
+    int image_id = get_footprint_image(grid_offset, building_id, &color_mask);
+    if (is_animated_water(image_id)) {
+        return;
+    }
+    int area_x, area_y, area_width, area_height;
+    get_footprint_area(x, y, grid_offset, image_id, &area_x, &area_y, &area_width, &area_height);
+    if (!city_terrain_cache_is_cached(area_x, area_y, area_width, area_height)) {
+        draw_footprint_image(x, y, grid_offset, building_id, image_id, color_mask);
+    }
+}
+
+static void draw_water_footprint(int x, int y, int grid_offset)
+{
+    if (grid_offset < 0 || !map_property_is_draw_tile(grid_offset)) {
+        return;
+    }
+    int building_id = map_building_at(grid_offset);
+    color_t color_mask;
+    int image_id = get_footprint_image(grid_offset, building_id, &color_mask);
+    if (is_animated_water(image_id)) {
+        draw_footprint_image(x, y, grid_offset, building_id, image_id, color_mask);
+    }
+}
+
 static void draw_hippodrome_spectators(const building *b, int x, int y, color_t color_mask)
 {
     // get which part of the hippodrome is getting checked
@@ -961,7 +1077,15 @@ void city_without_overlay_draw(int selected_figure_id, pixel_coordinate *figure_
     city_view_get_viewport(&x, &y, &width, &height);
     graphics_fill_rect(x, y, width, height, COLOR_BLACK);
     int should_mark_deleting = city_building_ghost_mark_deleting(tile);
-    city_view_foreach_valid_map_tile(draw_footprint);
+    if (city_terrain_cache_begin_frame()) {
+        city_view_foreach_valid_map_tile(add_footprint_to_cache);
+        city_terrain_cache_lookup_chunks();
+        city_view_foreach_valid_map_tile(draw_uncached_footprint);
+        city_terrain_cache_end_frame();
+        city_view_foreach_valid_map_tile(draw_water_footprint);
+    } else {
+        city_view_foreach_valid_map_tile(draw_footprint);
+    }
     if (!should_mark_deleting) {
         city_view_foreach_valid_map_tile_row(
             draw_top,
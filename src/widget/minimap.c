@@ -20,6 +20,12 @@
 #include <stdlib.h>
 #include <string.h>
 
+#define MINIMAP_TERRAIN (TERRAIN_BUILDING | TERRAIN_AQUEDUCT | TERRAIN_ROAD | TERRAIN_HIGHWAY | TERRAIN_WATER | \
+    TERRAIN_SHRUB | TERRAIN_TREE | TERRAIN_ROCK | TERRAIN_ELEVATION | TERRAIN_WALL | TERRAIN_MEADOW | TERRAIN_GARDEN)
+#define NO_TILE -1
+#define UPDATE_BAND_HEIGHT 16
+#define MAX_UPDATE_BANDS (GRID_SIZE * 2 / UPDATE_BAND_HEIGHT + 1)
+
 enum {
     FIGURE_COLOR_NONE = 0,
     FIGURE_COLOR_SOLDIER = 1,
@@ -50,6 +56,16 @@ typedef struct {
     tile_color edges;
     tile_color center;
 } building_tile_color;
+
+// Everything that determines how a tile is drawn, so tiles can be compared with how they were last drawn
+typedef struct {
+    int terrain;
+    uint16_t building_type;
+    uint8_t is_house;
+    uint8_t draw_size;
+    uint8_t figure_color;
+    uint8_t random;
+} tile_state;
 static void get_viewport(int *x, int *y, int *width, int *height);
 
 static minimap_functions default_functions = {
@@ -170,6 +186,27 @@ static struct {
         int stride;
         color_t *buffer;
     } cache;
+    // Where the tiles of the city were drawn in the cache and how they looked, to only redraw the tiles that change
+    struct {
+        int is_current;
+        int is_tracking;
+        int climate;
+        int orientation;
+        tile_state state[GRID_SIZE * GRID_SIZE];
+        int16_t x_view[GRID_SIZE * GRID_SIZE];
+        int16_t y_view[GRID_SIZE * GRID_SIZE];
+        int owner[GRID_SIZE * GRID_SIZE];
+        uint8_t is_dirty[GRID_SIZE * GRID_SIZE];
+        int dirty[GRID_SIZE * GRID_SIZE];
+        int num_dirty;
+        int *tile_at;
+        int columns;
+        int rows;
+        struct {
+            int x_min;
+            int x_max;
+        } bands[MAX_UPDATE_BANDS];
+    } tiles;
     const minimap_functions *functions;
     struct {
         int x;
@@ -336,6 +373,39 @@ static int draw_figure(int x_view, int y_view, int grid_offset)
     return 1;
 }
 
+static int tile_at(int x, int y)
+{
+    // Rows alternately start at x = -8 and x = -9, see city_view_foreach_minimap_tile
+    int row = y + 4;
+    int column = (x + ((row & 1) ? 9 : 8)) >> 1;
+    if (row < 0 || row >= data.tiles.rows || column < 0 || column >= data.tiles.columns) {
+        return NO_TILE;
+    }
+    return data.tiles.tile_at[row * data.tiles.columns + column];
+}
+
+static void foreach_building_tile(int x_view, int y_view, int size,
+    void (*callback)(int grid_offset, int building_offset), int building_offset)
+{
+    int rows = size * 2 - 1;
+    for (int row = 0; row < rows; row++) {
+        int tiles_in_row = row < size ? row + 1 : rows - row;
+        int x = x_view + size - tiles_in_row;
+        int y = y_view - (size - 1) + row;
+        for (int i = 0; i < tiles_in_row; i++, x += 2) {
+            int grid_offset = tile_at(x, y);
+            if (grid_offset != NO_TILE) {
+                callback(grid_offset, building_offset);
+            }
+        }
+    }
+}
+
+static void set_owner(int grid_offset, int building_offset)
+{
+    data.tiles.owner[grid_offset] = building_offset;
+}
+
 static int building_is_industry(building_type type)
 {
     return building_is_raw_resource_producer(type) || building_is_workshop(type) || type == BUILDING_WHARF;
@@ -405,6 +475,9 @@ static void draw_building(int x_offset, int y_offset, int grid_offset)
         }
         return;
     }
+    if (data.tiles.is_tracking) {
+        foreach_building_tile(x_offset, y_offset, size, set_owner, grid_offset);
+    }
     int width = size * 2;
     int height = width - 1;
     y_offset -= size - 1;
@@ -512,8 +585,13 @@ static void prepare_minimap_cache(void)
         data.minimap.y = (VIEW_Y_MAX - data.minimap.height) / 2;
 
         graphics_renderer()->create_custom_image(CUSTOM_IMAGE_MINIMAP, data.minimap.width * 2, data.minimap.height, 0);
+        data.cache.buffer = 0;
+    }
+    // The buffer is kept between updates so that only the changed tiles need to be redrawn
+    if (!data.cache.buffer) {
+        data.cache.buffer = graphics_renderer()->get_custom_image_buffer(CUSTOM_IMAGE_MINIMAP, &data.cache.stride);
+        data.tiles.is_current = 0;
     }
-    data.cache.buffer = graphics_renderer()->get_custom_image_buffer(CUSTOM_IMAGE_MINIMAP, &data.cache.stride);
 }
 
 static void clear_minimap(void)
@@ -521,6 +599,204 @@ static void clear_minimap(void)
     memset(data.cache.buffer, 0, sizeof(color_t) * data.minimap.height * data.cache.stride);
 }
 
+static void get_tile_state(int grid_offset, tile_state *state)
+{
+    memset(state, 0, sizeof(tile_state));
+    if (data.functions->offset.figure) {
+        state->figure_color = data.functions->offset.figure(grid_offset, has_figure_color);
+    }
+    int terrain = data.functions->offset.terrain(grid_offset);
+    state->terrain = terrain & MINIMAP_TERRAIN;
+    state->random = data.functions->offset.random(grid_offset) & 7;
+    if ((terrain & TERRAIN_BUILDING) && data.functions->offset.is_draw_tile(grid_offset)) {
+        state->draw_size = data.functions->offset.tile_size(grid_offset);
+    }
+    if (state->draw_size && data.functions->building) {
+        building *b = data.functions->building(data.functions->offset.building_id(grid_offset));
+        state->building_type = b->type;
+        state->is_house = b->house_size > 0;
+    }
+}
+
+static int draws_building(const tile_state *state)
+{
+    return state->draw_size > 1 && state->figure_color == FIGURE_COLOR_NONE;
+}
+
+static void record_tile(int x_view, int y_view, int grid_offset)
+{
+    if (grid_offset < 0) {
+        return;
+    }
+    data.tiles.x_view[grid_offset] = x_view;
+    data.tiles.y_view[grid_offset] = y_view;
+    int row = y_view + 4;
+    int column = (x_view + ((row & 1) ? 9 : 8)) >> 1;
+    data.tiles.tile_at[row * data.tiles.columns + column] = grid_offset;
+    get_tile_state(grid_offset, &data.tiles.state[grid_offset]);
+}
+
+static int prepare_tile_tracking(void)
+{
+    int columns = data.minimap.width + 4;
+    int rows = data.minimap.height + 8;
+    if (columns != data.tiles.columns || rows != data.tiles.rows || !data.tiles.tile_at) {
+        free(data.tiles.tile_at);
+        data.tiles.tile_at = malloc(sizeof(int) * columns * rows);
+        if (!data.tiles.tile_at) {
+            data.tiles.columns = 0;
+            data.tiles.rows = 0;
+            return 0;
+        }
+        data.tiles.columns = columns;
+        data.tiles.rows = rows;
+    }
+    for (int i = 0; i < columns * rows; i++) {
+        data.tiles.tile_at[i] = NO_TILE;
+    }
+    for (int i = 0; i < GRID_SIZE * GRID_SIZE; i++) {
+        data.tiles.owner[i] = NO_TILE;
+    }
+    return 1;
+}
+
+static void draw_all_tiles(void)
+{
+    clear_minimap();
+    // Only the city itself is tracked: saved game previews use their own functions
+    data.tiles.is_current = data.functions == &default_functions && prepare_tile_tracking();
+    if (data.tiles.is_current) {
+        foreach_map_tile(record_tile);
+        data.tiles.climate = data.functions->climate();
+        data.tiles.orientation = city_view_orientation();
+    }
+    data.tiles.is_tracking = data.tiles.is_current;
+    foreach_map_tile(draw_minimap_tile);
+    data.tiles.is_tracking = 0;
+    graphics_renderer()->update_custom_image(CUSTOM_IMAGE_MINIMAP);
+}
+
+static void mark_dirty(int grid_offset, int unused)
+{
+    if (!data.tiles.is_dirty[grid_offset]) {
+        data.tiles.is_dirty[grid_offset] = 1;
+        data.tiles.dirty[data.tiles.num_dirty++] = grid_offset;
+    }
+}
+
+static void find_changed_tile(int x_view, int y_view, int grid_offset)
+{
+    if (grid_offset < 0) {
+        return;
+    }
+    tile_state state;
+    get_tile_state(grid_offset, &state);
+    if (memcmp(&state, &data.tiles.state[grid_offset], sizeof(tile_state)) != 0) {
+        mark_dirty(grid_offset, 0);
+    }
+}
+
+static void mark_building_tiles_dirty(void)
+{
+    // A building is drawn over all of its tiles, so when one of them changes, they are all redrawn
+    for (int i = 0; i < data.tiles.num_dirty; i++) {
+        int grid_offset = data.tiles.dirty[i];
+        int x_view = data.tiles.x_view[grid_offset];
+        int y_view = data.tiles.y_view[grid_offset];
+        if (data.tiles.owner[grid_offset] != NO_TILE) {
+            mark_dirty(data.tiles.owner[grid_offset], 0);
+        }
+        if (draws_building(&data.tiles.state[grid_offset])) {
+            foreach_building_tile(x_view, y_view, data.tiles.state[grid_offset].draw_size, mark_dirty, 0);
+        }
+        get_tile_state(grid_offset, &data.tiles.state[grid_offset]);
+        if (draws_building(&data.tiles.state[grid_offset])) {
+            foreach_building_tile(x_view, y_view, data.tiles.state[grid_offset].draw_size, mark_dirty, 0);
+        }
+    }
+}
+
+static int compare_drawing_order(const void *a, const void *b)
+{
+    int offset_a = *(const int *) a;
+    int offset_b = *(const int *) b;
+    if (data.tiles.y_view[offset_a] != data.tiles.y_view[offset_b]) {
+        return data.tiles.y_view[offset_a] - data.tiles.y_view[offset_b];
+    }
+    return data.tiles.x_view[offset_a] - data.tiles.x_view[offset_b];
+}
+
+static void clear_tile(int grid_offset)
+{
+    int x = data.tiles.x_view[grid_offset];
+    int y = data.tiles.y_view[grid_offset];
+    data.tiles.owner[grid_offset] = NO_TILE;
+    if (y < 0 || y >= data.minimap.height) {
+        return;
+    }
+    int x_min = x < 0 ? 0 : x;
+    int x_max = x + 1 >= data.minimap.width * 2 ? data.minimap.width * 2 - 1 : x + 1;
+    if (x_min > x_max) {
+        return;
+    }
+    for (int i = x_min; i <= x_max; i++) {
+        data.cache.buffer[y * data.cache.stride + i] = 0;
+    }
+    int band = y / UPDATE_BAND_HEIGHT;
+    if (x_min < data.tiles.bands[band].x_min) {
+        data.tiles.bands[band].x_min = x_min;
+    }
+    if (x_max > data.tiles.bands[band].x_max) {
+        data.tiles.bands[band].x_max = x_max;
+    }
+}
+
+static void update_changed_bands(void)
+{
+    int num_bands = (data.minimap.height + UPDATE_BAND_HEIGHT - 1) / UPDATE_BAND_HEIGHT;
+    for (int band = 0; band < num_bands; band++) {
+        if (data.tiles.bands[band].x_min > data.tiles.bands[band].x_max) {
+            continue;
+        }
+        int y = band * UPDATE_BAND_HEIGHT;
+        int height = y + UPDATE_BAND_HEIGHT > data.minimap.height ? data.minimap.height - y : UPDATE_BAND_HEIGHT;
+        graphics_renderer()->update_custom_image_rect(CUSTOM_IMAGE_MINIMAP, data.tiles.bands[band].x_min, y,
+            data.tiles.bands[band].x_max - data.tiles.bands[band].x_min + 1, height);
+    }
+}
+
+static void draw_changed_tiles(void)
+{
+    data.tiles.num_dirty = 0;
+    foreach_map_tile(find_changed_tile);
+    if (!data.tiles.num_dirty) {
+        return;
+    }
+    mark_building_tiles_dirty();
+    qsort(data.tiles.dirty, data.tiles.num_dirty, sizeof(int), compare_drawing_order);
+
+    for (int i = 0; i < MAX_UPDATE_BANDS; i++) {
+        data.tiles.bands[i].x_min = data.minimap.width * 2;
+        data.tiles.bands[i].x_max = -1;
+    }
+    for (int i = 0; i < data.tiles.num_dirty; i++) {
+        clear_tile(data.tiles.dirty[i]);
+    }
+    data.tiles.is_tracking = 1;
+    for (int i = 0; i < data.tiles.num_dirty; i++) {
+        int grid_offset = data.tiles.dirty[i];
+        draw_minimap_tile(data.tiles.x_view[grid_offset], data.tiles.y_view[grid_offset], grid_offset);
+        data.tiles.is_dirty[grid_offset] = 0;
+    }
+    data.tiles.is_tracking = 0;
+
+    if (graphics_renderer()->update_custom_image_rect) {
+        update_changed_bands();
+    } else {
+        graphics_renderer()->update_custom_image(CUSTOM_IMAGE_MINIMAP);
+    }
+}
+
 void widget_minimap_update(const minimap_functions *functions)
 {
     data.functions = functions ? functions : &default_functions;
@@ -528,10 +804,13 @@ void widget_minimap_update(const minimap_functions *functions)
     if (!data.cache.buffer) {
         return;
     }
-    clear_minimap();
     minimap_colors.climate = &CLIMATE_VARIANTS[data.functions->climate()];
-    foreach_map_tile(draw_minimap_tile);
-    graphics_renderer()->update_custom_image(CUSTOM_IMAGE_MINIMAP);
+    if (data.functions == &default_functions && data.tiles.is_current &&
+        data.tiles.climate == data.functions->climate() && data.tiles.orientation == city_view_orientation()) {
+        draw_changed_tiles();
+    } else {
+        draw_all_tiles();
+    }
 }
 
 void widget_minimap_draw(int x_offset, int y_offset, int width, int height)
@@ -15,6 +15,7 @@
 #include "core/lang.h"
 #include "core/string.h"
 #include "figure/formation_legion.h"
+#include "game/journal.h"
 #include "game/resource.h"
 #include "game/settings.h"
 #include "game/state.h"
@@ -733,6 +734,7 @@ static void confirm_nothing(int accepted, int checked)
 static void confirm_send_troops(int accepted, int checked)
 {
     if (accepted) {
+        game_journal_record(JOURNAL_DISTANT_BATTLE);
         formation_legions_dispatch_to_distant_battle();
         window_empire_show();
     }
@@ -741,8 +743,10 @@ static void confirm_send_troops(int accepted, int checked)
 static void confirm_send_goods(int accepted, int checked)
 {
     if (accepted) {
+        game_journal_record(JOURNAL_REQUEST_DISPATCH, data.selected_request_id);
         scenario_request_dispatch(data.selected_request_id);
         if (!checked && city_resource_is_stockpiled(data.selected_resource)) {
+            game_journal_record(JOURNAL_STOCKPILE, data.selected_resource);
             city_resource_toggle_stockpiled(data.selected_resource);
         }
     }
@@ -763,6 +767,7 @@ static void button_handle_request(const generic_button *button)
     const request *r = &data.requests[index];
 
     if (status) {
+        game_journal_record(JOURNAL_CLEAR_EMPIRE_SERVICE);
         city_military_clear_empire_service_legions();
         switch (status) {
             case CITY_REQUEST_STATUS_NO_LEGIONS_AVAILABLE:
@@ -5,6 +5,7 @@
 #include "core/calc.h"
 #include "figure/formation.h"
 #include "figure/formation_legion.h"
+#include "game/journal.h"
 #include "graphics/arrow_button.h"
 #include "graphics/generic_button.h"
 #include "graphics/graphics.h"
@@ -603,6 +604,7 @@ static void button_select_formation_layout(const generic_button *button)
     } else {
         layout_indexes = LAYOUT_BUTTON_INDEXES_AUXILIARY[swap_lines];
     }
+    game_journal_record(JOURNAL_LEGION_LAYOUT, m->id, layout_indexes[index]);
     formation_legion_change_layout(m, layout_indexes[index]);
     switch (index) {
         case 0: sound_speech_play_file("wavs/cohort1.wav"); break;
@@ -623,12 +625,14 @@ static void button_return_to_fort(const generic_button *button)
 {
     formation *m = formation_get(data.active_legion.formation_id);
     if (!m->in_distant_battle) {
+        game_journal_record(JOURNAL_LEGION_RETURN_HOME, m->id);
         formation_legion_return_home(m);
     }
 }
 
 static void button_empire_service(const generic_button *button)
 {
+    game_journal_record(JOURNAL_EMPIRE_SERVICE, data.active_legion.formation_id);
     formation_toggle_empire_service(data.active_legion.formation_id);
     formation_calculate_figures();
 }
@@ -11,6 +11,7 @@
 #include "core/string.h"
 #include "empire/city.h"
 #include "figure/formation_legion.h"
+#include "game/journal.h"
 #include "graphics/button.h"
 #include "graphics/generic_button.h"
 #include "graphics/image.h"
@@ -199,6 +200,7 @@ static void confirm_nothing(int accepted, int checked)
 static void confirm_send_troops(int accepted, int checked)
 {
     if (accepted) {
+        game_journal_record(JOURNAL_DISTANT_BATTLE);
         formation_legions_dispatch_to_distant_battle();
         window_empire_show();
     }
@@ -207,8 +209,10 @@ static void confirm_send_troops(int accepted, int checked)
 static void confirm_send_goods(int accepted, int checked)
 {
     if (accepted) {
+        game_journal_record(JOURNAL_REQUEST_DISPATCH, selected_request_id);
         scenario_request_dispatch(selected_request_id);
         if (!checked && city_resource_is_stockpiled(selected_resource)) {
+            game_journal_record(JOURNAL_STOCKPILE, selected_resource);
             city_resource_toggle_stockpiled(selected_resource);
         }
     }
@@ -221,6 +225,7 @@ void button_request(const generic_button *button)
     if (!status) {
         return;
     }
+    game_journal_record(JOURNAL_CLEAR_EMPIRE_SERVICE);
     city_military_clear_empire_service_legions();
     switch (status) {
         case CITY_REQUEST_STATUS_NO_LEGIONS_AVAILABLE:
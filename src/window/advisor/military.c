@@ -6,6 +6,7 @@
 #include "city/view.h"
 #include "core/calc.h"
 #include "figure/formation_legion.h"
+#include "game/journal.h"
 #include "graphics/button.h"
 #include "graphics/generic_button.h"
 #include "graphics/image.h"
@@ -260,6 +261,7 @@ static void return_legion_to_fort(int legion_id)
 {
     formation *m = formation_get(formation_for_legion(legion_id));
     if (!m->in_distant_battle && !m->is_at_fort) {
+        game_journal_record(JOURNAL_LEGION_RETURN_HOME, m->id);
         formation_legion_return_home(m);
         window_invalidate();
     }
@@ -275,6 +277,7 @@ static void button_empire_service(const generic_button *button)
 {
     int legion_id = button->parameter1;
     int formation_id = formation_for_legion(legion_id + scrollbar.scroll_position);
+    game_journal_record(JOURNAL_EMPIRE_SERVICE, formation_id);
     formation_toggle_empire_service(formation_id);
     formation_calculate_figures();
     window_invalidate();
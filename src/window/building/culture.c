@@ -11,6 +11,7 @@
 #include "city/finance.h"
 #include "city/trade_policy.h"
 #include "core/dir.h"
+#include "game/journal.h"
 #include "graphics/button.h"
 #include "graphics/generic_button.h"
 #include "graphics/image.h"
@@ -27,7 +28,6 @@
 #include "window/race_bet.h"
 
 #define GOD_PANTHEON 5
-#define MODULE_COST 1000
 
 static void button_add_module_prompt(const generic_button *button);
 static void button_hold_games(const generic_button *button);
@@ -1315,7 +1315,8 @@ static void add_module(int selection)
     }
     sound_speech_play_file("wavs/oracle.wav");
     building *b = building_get(data.building_id);
-    city_finance_process_construction(MODULE_COST);
+    game_journal_record(JOURNAL_MONUMENT_MODULE, b->id, data.module_choices[selection - 1]);
+    city_finance_process_construction(MONUMENT_MODULE_COST);
     building_monument_add_module(b, data.module_choices[selection - 1]);
 }
 
@@ -8,6 +8,7 @@
 #include "city/resource.h"
 #include "city/view.h"
 #include "figure/figure.h"
+#include "game/journal.h"
 #include "graphics/button.h"
 #include "graphics/generic_button.h"
 #include "graphics/image.h"
@@ -424,6 +425,7 @@ static void set_order_source(const generic_button *button)
     if (!building_id) {
         return;
     }
+    game_journal_record_unsupported("depot_source");
     building *b = building_get(depot_building_id);
     b->data.depot.current_order.src_storage_id = building_id;
     if (b->data.depot.current_order.dst_storage_id == building_id) {
@@ -440,6 +442,7 @@ static void set_order_destination(const generic_button *button)
     if (!building_id) {
         return;
     }
+    game_journal_record_unsupported("depot_destination");
     building *b = building_get(depot_building_id);
     b->data.depot.current_order.dst_storage_id = building_id;
     if (b->data.depot.current_order.src_storage_id == building_id) {
@@ -529,6 +532,7 @@ static void set_order_resource(const generic_button *button)
     int depot_building_id = button->parameter1;
     resource_type resource_id = button->parameter2;
     if (resource_id >= RESOURCE_MIN && resource_id < RESOURCE_MAX && resource_is_storable(resource_id)) {
+        game_journal_record_unsupported("depot_resource");
         building *b = building_get(depot_building_id);
         b->data.depot.current_order.resource_type = resource_id;
         calculate_available_storages(depot_building_id);
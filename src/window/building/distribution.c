@@ -24,6 +24,7 @@
 #include "empire/object.h"
 #include "empire/trade_route.h"
 #include "figure/figure.h"
+#include "game/journal.h"
 #include "graphics/button.h"
 #include "graphics/generic_button.h"
 #include "graphics/image.h"
@@ -1400,6 +1401,7 @@ static void toggle_resource_state(const generic_button *button)
     resource_type resource;
     if (building_has_supplier_inventory(b->type) || b->type == BUILDING_DOCK) {
         resource = data.stored_resources.items[index];
+        game_journal_record(JOURNAL_DISTRIBUTION_GOOD, b->id, resource);
         building_distribution_toggle_good_accepted(resource, b);
     } else {
         if (b->type == BUILDING_WAREHOUSE) {
@@ -1407,6 +1409,7 @@ static void toggle_resource_state(const generic_button *button)
         } else {
             resource = city_resource_get_potential_foods()->items[index];
         }
+        game_journal_record(JOURNAL_STORAGE_STATE, b->storage_id, resource);
         building_storage_cycle_resource_state(b->storage_id, resource);
     }
     window_invalidate();
@@ -1418,8 +1421,10 @@ static void market_orders(const generic_button *button)
     building *b = building_get(data.building_id);
     if (index == 0) {
         if (affect_all_button_distribution_state() == ACCEPT_ALL) {
+            game_journal_record(JOURNAL_DISTRIBUTION_ACCEPT_ALL, b->id);
             building_distribution_accept_all_goods(b);
         } else {
+            game_journal_record(JOURNAL_DISTRIBUTION_ACCEPT_NONE, b->id);
             building_distribution_unaccept_all_goods(b);
         }
     }
@@ -1430,6 +1435,7 @@ static void storage_toggle_permissions(const generic_button *button)
 {
     int index = button->parameter1;
     building *b = building_get(data.building_id);
+    game_journal_record(JOURNAL_STORAGE_PERMISSION, b->id, index);
     building_storage_set_permission(index, b);
     window_invalidate();
 }
@@ -1437,6 +1443,7 @@ static void storage_toggle_permissions(const generic_button *button)
 static void toggle_mantain(int param1, int param2)
 {
     building *b = building_get(data.building_id);
+    game_journal_record(JOURNAL_STORAGE_PERMISSION, b->id, BUILDING_STORAGE_PERMISSION_WORKER);
     building_storage_set_permission(BUILDING_STORAGE_PERMISSION_WORKER, b);
     window_invalidate();
 }
@@ -1451,6 +1458,7 @@ static void toggle_partial_resource_state(const generic_button *button)
     } else {
         resource = city_resource_get_potential_foods()->items[index + scrollbar.scroll_position - 1];
     }
+    game_journal_record(JOURNAL_STORAGE_PARTIAL_STATE, b->storage_id, resource);
     building_storage_cycle_partial_resource_state(b->storage_id, resource);
     window_invalidate();
 }
@@ -1459,6 +1467,7 @@ static void button_stockpiling(const generic_button *button)
 {
     building *b = building_get(data.building_id);
     if (building_is_primary_product_producer(b->type)) {
+        game_journal_record(JOURNAL_BUILDING_STOCKPILE, b->id);
         building_stockpiling_toggle(b);
     }
     window_invalidate();
@@ -1468,6 +1477,7 @@ static void dock_toggle_route(const generic_button *button)
 {
     int route_id = button->parameter1;
     int can_trade = building_dock_can_trade_with_route(route_id, data.building_id);
+    game_journal_record(JOURNAL_DOCK_ROUTE, route_id, data.building_id, !can_trade);
     building_dock_set_can_trade_with_route(route_id, data.building_id, !can_trade);
     window_invalidate();
 }
@@ -1477,11 +1487,14 @@ static void granary_orders(const generic_button *button)
     int index = button->parameter1;
     int storage_id = building_get(data.building_id)->storage_id;
     if (index == 0) {
+        game_journal_record(JOURNAL_STORAGE_EMPTY_ALL, storage_id);
         building_storage_toggle_empty_all(storage_id);
     } else if (index == 1) {
         if (affect_all_button_storage_state() == ACCEPT_ALL) {
+            game_journal_record(JOURNAL_STORAGE_ACCEPT_ALL, storage_id);
             building_storage_accept_all(storage_id);
         } else {
+            game_journal_record(JOURNAL_STORAGE_ACCEPT_NONE, storage_id);
             building_storage_accept_none(storage_id);
         }
     }
@@ -1493,12 +1506,15 @@ static void warehouse_orders(const generic_button *button)
     int index = button->parameter1;
     if (index == 0) {
         int storage_id = building_get(data.building_id)->storage_id;
+        game_journal_record(JOURNAL_STORAGE_EMPTY_ALL, storage_id);
         building_storage_toggle_empty_all(storage_id);
     } else if (index == 1) {
         int storage_id = building_get(data.building_id)->storage_id;
         if (affect_all_button_storage_state() == ACCEPT_ALL) {
+            game_journal_record(JOURNAL_STORAGE_ACCEPT_ALL, storage_id);
             building_storage_accept_all(storage_id);
         } else {
+            game_journal_record(JOURNAL_STORAGE_ACCEPT_NONE, storage_id);
             building_storage_accept_none(storage_id);
         }
     }
@@ -1608,6 +1624,7 @@ static void apply_policy_land(int selected_policy)
     if (selected_policy == NO_POLICY) {
         return;
     }
+    game_journal_record(JOURNAL_TRADE_POLICY, LAND_TRADE_POLICY, selected_policy);
     city_trade_policy_set(LAND_TRADE_POLICY, selected_policy);
     sound_speech_play_file(land_trade_policy.wav_file);
     city_finance_process_sundry(TRADE_POLICY_COST);
@@ -1715,6 +1732,7 @@ static void apply_policy_sea(int selected_policy)
     if (selected_policy == NO_POLICY) {
         return;
     }
+    game_journal_record(JOURNAL_TRADE_POLICY, SEA_TRADE_POLICY, selected_policy);
     city_trade_policy_set(SEA_TRADE_POLICY, selected_policy);
     sound_speech_play_file(sea_trade_policy.wav_file);
     city_finance_process_sundry(TRADE_POLICY_COST);
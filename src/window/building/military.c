@@ -13,6 +13,7 @@
 #include "core/log.h"
 #include "core/string.h"
 #include "figure/formation_legion.h"
+#include "game/journal.h"
 #include "graphics/button.h"
 #include "graphics/generic_button.h"
 #include "graphics/image.h"
@@ -653,6 +654,7 @@ static void button_return_to_fort(const generic_button *button)
 {
     formation *m = formation_get(data.context_for_callback->formation_id);
     if (!m->in_distant_battle && m->is_at_fort != 1) {
+        game_journal_record(JOURNAL_LEGION_RETURN_HOME, m->id);
         formation_legion_return_home(m);
         window_city_show();
     }
@@ -690,6 +692,7 @@ static void button_layout(const generic_button *button)
             case 4: new_layout = FORMATION_MOP_UP; break;
         }
     }
+    game_journal_record(JOURNAL_LEGION_LAYOUT, m->id, new_layout);
     formation_legion_change_layout(m, new_layout);
     switch (index) {
         case 0: sound_speech_play_file("wavs/cohort1.wav"); break;
@@ -705,12 +708,14 @@ static void button_priority(const generic_button *button)
 {
     int index = button->parameter1;
     building *barracks = building_get(data.building_id);
+    game_journal_record(JOURNAL_BARRACKS_PRIORITY, barracks->id, index);
     building_barracks_set_priority(barracks, index);
 }
 
 static void button_delivery(const generic_button *button)
 {
     building *barracks = building_get(data.building_id);
+    game_journal_record(JOURNAL_BARRACKS_DELIVERY, barracks->id);
     building_barracks_toggle_delivery(barracks);
 }
 
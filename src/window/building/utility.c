@@ -7,6 +7,7 @@
 #include "city/finance.h"
 #include "core/dir.h"
 #include "core/image.h"
+#include "game/journal.h"
 #include "graphics/button.h"
 #include "graphics/generic_button.h"
 #include "graphics/image.h"
@@ -429,6 +430,7 @@ static void button_toggle_figure_state(const generic_button *button)
     int index = button->parameter1;
     building *b = building_get(data.building_id);
     if (building_type_is_roadblock(b->type)) {
+        game_journal_record(JOURNAL_ROADBLOCK_PERMISSION, b->id, index);
         building_roadblock_set_permission(index, b);
     }
     window_invalidate();
@@ -440,8 +442,10 @@ static void button_roadblock_orders(const generic_button *button)
 {
     building *b = building_get(data.building_id);
     if (affect_all_button_state() == REJECT_ALL) {
+        game_journal_record(JOURNAL_ROADBLOCK_ACCEPT_NONE, b->id);
         building_roadblock_accept_none(b);
     } else {
+        game_journal_record(JOURNAL_ROADBLOCK_ACCEPT_ALL, b->id);
         building_roadblock_accept_all(b);
     }
     window_invalidate();
@@ -17,6 +17,7 @@
 #include "figure/formation_legion.h"
 #include "figure/roamer_preview.h"
 #include "figure/phrase.h"
+#include "game/journal.h"
 #include "game/state.h"
 #include "graphics/button.h"
 #include "graphics/generic_button.h"
@@ -1143,6 +1144,7 @@ static void button_mothball(int param1, int param2)
     building *b = building_get(context.building_id);
     int workers_needed = model_get_building(b->type)->laborers;
     if (workers_needed) {
+        game_journal_record(JOURNAL_BUILDING_MOTHBALL, b->id);
         building_mothball_toggle(b);
         window_invalidate();
     }
@@ -1151,6 +1153,7 @@ static void button_mothball(int param1, int param2)
 static void button_monument_construction(const generic_button *button)
 {
     building *b = building_get(context.building_id);
+    game_journal_record(JOURNAL_MONUMENT_HALT, b->id);
     building_monument_toggle_construction_halted(b);
     window_invalidate();
 }
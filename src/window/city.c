@@ -19,6 +19,7 @@
 #include "figure/formation.h"
 #include "figure/formation_legion.h"
 #include "figure/roamer_preview.h"
+#include "game/journal.h"
 #include "game/orientation.h"
 #include "game/settings.h"
 #include "game/state.h"
@@ -687,6 +688,7 @@ static void handle_hotkeys(const hotkeys *h)
         int building_id = map_building_at(widget_city_current_grid_offset());
         building *b = building_main(building_get(building_id));
         if (building_id && model_get_building(b->type)->laborers) {
+            game_journal_record(JOURNAL_BUILDING_MOTHBALL, b->id);
             building_mothball_toggle(b);
             if (b->state == BUILDING_STATE_IN_USE) {
                 mothball_warning_id = city_warning_show(WARNING_DATA_MOTHBALL_OFF, mothball_warning_id);
@@ -2,6 +2,7 @@
 
 #include "city/emperor.h"
 #include "core/calc.h"
+#include "game/journal.h"
 #include "game/resource.h"
 #include "graphics/arrow_button.h"
 #include "graphics/button.h"
@@ -126,6 +127,7 @@ static void button_set_amount(const generic_button *button)
 
 static void button_donate(const generic_button *button)
 {
+    game_journal_record(JOURNAL_DONATION, city_emperor_donate_amount());
     city_emperor_donate_savings_to_city();
     window_advisors_show();
 }
@@ -11,6 +11,7 @@
 #include "empire/object.h"
 #include "empire/trade_route.h"
 #include "empire/type.h"
+#include "game/journal.h"
 #include "game/tutorial.h"
 #include "graphics/generic_button.h"
 #include "graphics/graphics.h"
@@ -922,6 +923,7 @@ static void button_show_resource_window(const generic_button *button)
 static void confirmed_open_trade(int accepted, int checked)
 {
     if (accepted) {
+        game_journal_record(JOURNAL_OPEN_TRADE, data.selected_city);
         empire_city_open_trade(data.selected_city, 1);
         building_menu_update();
         window_trade_opened_show(data.selected_city);
@@ -1,6 +1,7 @@
 #include "gift_to_emperor.h"
 
 #include "city/emperor.h"
+#include "game/journal.h"
 #include "game/resource.h"
 #include "graphics/button.h"
 #include "graphics/generic_button.h"
@@ -109,6 +110,7 @@ static void button_set_gift(const generic_button *button)
 static void button_send_gift(const generic_button *button)
 {
     if (city_emperor_can_send_gift(GIFT_MODEST)) {
+        game_journal_record(JOURNAL_GIFT, city_emperor_selected_gift_size());
         city_emperor_send_gift();
         window_advisors_show();
     }
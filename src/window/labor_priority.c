@@ -1,6 +1,7 @@
 #include "labor_priority.h"
 
 #include "city/labor.h"
+#include "game/journal.h"
 #include "graphics/generic_button.h"
 #include "graphics/graphics.h"
 #include "graphics/lang_text.h"
@@ -112,6 +113,7 @@ static void handle_input(const mouse *m, const hotkeys *h)
 static void button_set_priority(const generic_button *button)
 {
     int new_priority = button->parameter1;
+    game_journal_record(JOURNAL_LABOR_PRIORITY, data.category, new_priority);
     city_labor_set_priority(data.category, new_priority);
     window_go_back();
 }
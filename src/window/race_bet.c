@@ -2,6 +2,7 @@
 #include "city/data_private.h"
 #include "city/race_bet.h"
 #include "core/calc.h"
+#include "game/journal.h"
 #include "graphics/arrow_button.h"
 #include "graphics/generic_button.h"
 #include "graphics/graphics.h"
@@ -179,6 +180,7 @@ static void button_confirm(const generic_button *button)
 {
     // save bet and go back
     if (!city_data.games.chosen_horse && data.chosen_horse && data.bet_amount) {
+        game_journal_record_unsupported("race_bet");
         city_data.games.chosen_horse = data.chosen_horse;
         city_data.games.bet_amount = data.bet_amount;
         window_go_back();
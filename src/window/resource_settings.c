@@ -5,6 +5,7 @@
 #include "core/calc.h"
 #include "core/image_group.h"
 #include "empire/city.h"
+#include "game/journal.h"
 #include "graphics/arrow_button.h"
 #include "graphics/generic_button.h"
 #include "graphics/graphics.h"
@@ -251,8 +252,10 @@ static void button_ok(int param1, int param2)
 static void button_trade_up_down(int trade_type, int is_down)
 {
     if (trade_type == TRADE_STATUS_IMPORT) {
+        game_journal_record(JOURNAL_IMPORT_OVER, data.resource, is_down ? -1 : 1);
         city_resource_change_import_over(data.resource, is_down ? -1 : 1);
     } else if (trade_type == TRADE_STATUS_EXPORT) {
+        game_journal_record(JOURNAL_EXPORT_OVER, data.resource, is_down ? -1 : 1);
         city_resource_change_export_over(data.resource, is_down ? -1 : 1);
     }
 }
@@ -260,6 +263,7 @@ static void button_trade_up_down(int trade_type, int is_down)
 static void button_toggle_industry(const generic_button *button)
 {
     if (building_count_total(resource_get_data(data.resource)->industry) > 0) {
+        game_journal_record(JOURNAL_MOTHBALL, data.resource);
         city_resource_toggle_mothballed(data.resource);
     }
 }
@@ -275,12 +279,14 @@ static void button_toggle_trade(const generic_button *button)
         window_empire_show();
         return;
     }
+    game_journal_record(JOURNAL_TRADE_STATUS, data.resource, status);
     city_resource_cycle_trade_status(data.resource, status);
 }
 
 static void button_toggle_stockpile(const generic_button *button)
 {
     if (resource_is_storable(data.resource)) {
+        game_journal_record(JOURNAL_STOCKPILE, data.resource);
         city_resource_toggle_stockpiled(data.resource);
     }
 }
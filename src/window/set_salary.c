@@ -4,6 +4,7 @@
 #include "city/finance.h"
 #include "city/ratings.h"
 #include "city/victory.h"
+#include "game/journal.h"
 #include "game/resource.h"
 #include "graphics/button.h"
 #include "graphics/generic_button.h"
@@ -104,6 +105,7 @@ static void button_set_salary(const generic_button *button)
     int rank = button->parameter1;
 
     if (!city_victory_has_won()) {
+        game_journal_record(JOURNAL_SALARY, rank);
         city_emperor_set_salary_rank(rank);
         city_finance_update_salary();
         city_ratings_update_favor_explanation();
@@ -0,0 +1,111 @@
+#include "test.h"
+
+#include "core/array.h"
+
+#define ARRAY_BLOCK_SIZE 64
+#define NUM_OPERATIONS 20000
+
+typedef struct {
+    unsigned int id;
+    int in_use;
+} item;
+
+static array(item) tracked;
+static array(item) scanned;
+
+static void create_item(item *i, unsigned int position)
+{
+    i->id = position;
+}
+
+static int item_in_use(const item *i)
+{
+    return i->in_use;
+}
+
+static unsigned int count_in_use(void)
+{
+    unsigned int count = 0;
+    item *i;
+    array_foreach(scanned, i) {
+        if (i->in_use) {
+            count++;
+        }
+    }
+    return count;
+}
+
+// Both arrays must hand out the same ids, as the ids of figures and paths end up in saved games
+static void check_new_item(int fill)
+{
+    item *from_tracked;
+    item *from_scanned;
+    array_new_item_after_index(tracked, 1, from_tracked);
+    array_new_item_after_index(scanned, 1, from_scanned);
+    TEST_CHECK(from_tracked != 0);
+    TEST_CHECK(from_scanned != 0);
+    if (!from_tracked || !from_scanned) {
+        return;
+    }
+    TEST_CHECK_EQUAL(from_scanned->id, from_tracked->id);
+    TEST_CHECK(!from_tracked->in_use);
+    from_tracked->in_use = fill;
+    from_scanned->in_use = fill;
+}
+
+static void release_random_item(void)
+{
+    unsigned int index = 1 + test_random(scanned.size - 1);
+    item *i = array_item(scanned, index);
+    if (!i->in_use) {
+        return;
+    }
+    i->in_use = 0;
+    array_item(tracked, index)->in_use = 0;
+    array_release_item(tracked, index);
+    // Releasing twice must be harmless
+    if (test_random(4) == 0) {
+        array_release_item(tracked, index);
+    }
+}
+
+static void release_many_items_at_once(void)
+{
+    for (unsigned int index = 1; index < scanned.size; index++) {
+        if (test_random(3) == 0) {
+            array_item(scanned, index)->in_use = 0;
+            array_item(tracked, index)->in_use = 0;
+        }
+    }
+    array_rebuild_free_slots(tracked);
+}
+
+int main(void)
+{
+    TEST_CHECK(array_init(tracked, ARRAY_BLOCK_SIZE, create_item, item_in_use));
+    TEST_CHECK(array_init(scanned, ARRAY_BLOCK_SIZE, create_item, item_in_use));
+    array_enable_free_slot_tracking(tracked);
+
+    for (int i = 0; i < NUM_OPERATIONS; i++) {
+        int operation = test_random(100);
+        if (operation < 55) {
+            check_new_item(1);
+        } else if (operation < 60) {
+            // An item that is handed out but never filled must be handed out again
+            check_new_item(0);
+        } else if (operation < 99) {
+            if (scanned.size > 1) {
+                release_random_item();
+            }
+        } else {
+            release_many_items_at_once();
+        }
+        TEST_CHECK_EQUAL(scanned.size, tracked.size);
+    }
+    TEST_CHECK(tracked.free_slots.enabled);
+    TEST_CHECK(count_in_use() > 0);
+
+    array_clear(tracked);
+    array_clear(scanned);
+    return test_finish("array_free_slots");
+}
@@ -0,0 +1,101 @@
+#include "test.h"
+
+#include "core/buffer.h"
+#include "map/building.h"
+#include "map/grid.h"
+
+#define MAP_SIZE 50
+#define RADIUS 2
+#define NUM_OPERATIONS 50000
+#define MAX_BUILDING_ID 30
+
+static uint8_t saved_buildings[GRID_SIZE * GRID_SIZE * sizeof(uint16_t)];
+static uint8_t saved_damage[GRID_SIZE * GRID_SIZE];
+
+// The same area as the service coverage, scanned row by row without the cache
+static int scan_nearby(int x, int y, uint16_t *ids)
+{
+    int num_ids = 0;
+    for (int yy = y - RADIUS; yy <= y + RADIUS; yy++) {
+        for (int xx = x - RADIUS; xx <= x + RADIUS; xx++) {
+            if (xx < 0 || yy < 0 || xx >= MAP_SIZE || yy >= MAP_SIZE) {
+                continue;
+            }
+            int building_id = map_building_at(map_grid_offset(xx, yy));
+            if (building_id) {
+                ids[num_ids++] = building_id;
+            }
+        }
+    }
+    return num_ids;
+}
+
+static void check_nearby(int x, int y)
+{
+    uint16_t expected[MAP_BUILDING_MAX_NEARBY];
+    int num_expected = scan_nearby(x, y, expected);
+    const uint16_t *ids;
+    int num_ids = map_building_get_nearby(x, y, &ids);
+    TEST_CHECK_EQUAL(num_expected, num_ids);
+    if (num_expected != num_ids) {
+        return;
+    }
+    for (int i = 0; i < num_ids; i++) {
+        TEST_CHECK_EQUAL(expected[i], ids[i]);
+    }
+}
+
+static void set_random_tile(void)
+{
+    int grid_offset = map_grid_offset(test_random(MAP_SIZE), test_random(MAP_SIZE));
+    // Clearing tiles as often as setting them keeps the areas from filling up
+    int building_id = test_random(2) ? 0 : 1 + test_random(MAX_BUILDING_ID);
+    map_building_set(grid_offset, building_id);
+}
+
+// Loading a game replaces the whole grid, so none of the cached lists may survive it
+static void check_reload(void)
+{
+    buffer buildings;
+    buffer damage;
+    buffer_init(&buildings, saved_buildings, sizeof(saved_buildings));
+    buffer_init(&damage, saved_damage, sizeof(saved_damage));
+    map_building_save_state(&buildings, &damage);
+    for (int y = 0; y < MAP_SIZE; y++) {
+        for (int x = 0; x < MAP_SIZE; x++) {
+            check_nearby(x, y);
+        }
+    }
+
+    map_building_clear();
+    for (int i = 0; i < MAP_SIZE; i++) {
+        check_nearby(test_random(MAP_SIZE), test_random(MAP_SIZE));
+    }
+
+    buffer_reset(&buildings);
+    buffer_reset(&damage);
+    map_building_load_state(&buildings, &damage);
+    for (int y = 0; y < MAP_SIZE; y++) {
+        for (int x = 0; x < MAP_SIZE; x++) {
+            check_nearby(x, y);
+        }
+    }
+}
+
+// With VERIFY_INCREMENTAL_UPDATES, every cached list that is handed out is also compared with the grid
+// and logs an error on any difference, which fails the test
+int main(void)
+{
+    test_init_map(MAP_SIZE, MAP_SIZE);
+    map_building_clear();
+    for (int i = 0; i < NUM_OPERATIONS; i++) {
+        if (test_random(3) == 0) {
+            set_random_tile();
+        } else {
+            // Tiles on the edge of the map have part of their area outside it
+            check_nearby(test_random(MAP_SIZE), test_random(MAP_SIZE));
+        }
+    }
+    check_reload();
+    return test_finish("building_nearby_cache");
+}
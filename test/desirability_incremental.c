@@ -0,0 +1,138 @@
+#include "test.h"
+
+#include "building/building.h"
+#include "building/monument.h"
+#include "map/desirability.h"
+#include "map/grid.h"
+#include "map/terrain.h"
+
+#define MAP_SIZE 80
+#define NUM_MAPS 5
+#define NUM_UPDATES 200
+#define CHANGES_PER_UPDATE 4
+#define INITIAL_BUILDINGS 60
+
+// Types whose desirability does not come from c3_model.txt, so the test needs no game data
+static const building_type TYPES[] = {
+    BUILDING_WORKCAMP, BUILDING_ARCHITECT_GUILD, BUILDING_MESS_HALL, BUILDING_TAVERN, BUILDING_ARENA,
+    BUILDING_LARARIUM, BUILDING_NYMPHAEUM, BUILDING_SMALL_MAUSOLEUM, BUILDING_LARGE_MAUSOLEUM,
+    BUILDING_WATCHTOWER, BUILDING_GOLD_MINE, BUILDING_STONE_QUARRY, BUILDING_BRICKWORKS, BUILDING_DEPOT,
+    BUILDING_ARMOURY, BUILDING_LIGHTHOUSE
+};
+#define NUM_TYPES (sizeof(TYPES) / sizeof(TYPES[0]))
+
+static const int TERRAIN_SOURCES[] = { TERRAIN_GARDEN, TERRAIN_RUBBLE, TERRAIN_HIGHWAY };
+#define NUM_TERRAIN_SOURCES (sizeof(TERRAIN_SOURCES) / sizeof(TERRAIN_SOURCES[0]))
+
+static int incremental_values[MAP_SIZE][MAP_SIZE];
+
+static void add_random_building(void)
+{
+    building *b = building_create(TYPES[test_random(NUM_TYPES)], test_random(MAP_SIZE - 4), test_random(MAP_SIZE - 4));
+    if (!b->id) {
+        return;
+    }
+    b->state = BUILDING_STATE_IN_USE;
+    if (building_monument_is_monument(b)) {
+        b->monument.phase = MONUMENT_FINISHED;
+    }
+}
+
+static building *random_building_in_use(void)
+{
+    for (int tries = 0; tries < 10; tries++) {
+        building *b = building_get(1 + test_random(building_count() - 1));
+        if (b->state == BUILDING_STATE_IN_USE) {
+            return b;
+        }
+    }
+    return 0;
+}
+
+static void change_random_building(void)
+{
+    building *b = random_building_in_use();
+    if (!b) {
+        return;
+    }
+    switch (test_random(3)) {
+        case 0:
+            b->state = BUILDING_STATE_DELETED_BY_PLAYER;
+            break;
+        case 1:
+            b->x = test_random(MAP_SIZE - 4);
+            b->y = test_random(MAP_SIZE - 4);
+            break;
+        default:
+            if (building_monument_is_monument(b)) {
+                b->monument.phase = b->monument.phase == MONUMENT_FINISHED ? MONUMENT_START : MONUMENT_FINISHED;
+            } else {
+                b->type = TYPES[test_random(NUM_TYPES)];
+            }
+            break;
+    }
+}
+
+static void toggle_random_terrain(void)
+{
+    int grid_offset = map_grid_offset(test_random(MAP_SIZE), test_random(MAP_SIZE));
+    int terrain = TERRAIN_SOURCES[test_random(NUM_TERRAIN_SOURCES)];
+    if (map_terrain_is(grid_offset, terrain)) {
+        map_terrain_remove(grid_offset, terrain);
+    } else {
+        map_terrain_add(grid_offset, terrain);
+    }
+}
+
+static void make_random_change(void)
+{
+    int change = test_random(100);
+    if (change < 30) {
+        add_random_building();
+    } else if (change < 70) {
+        change_random_building();
+    } else {
+        toggle_random_terrain();
+    }
+}
+
+// Forgetting the sources makes the next update rebuild the whole grid from scratch
+static void check_against_full_rebuild(void)
+{
+    for (int y = 0; y < MAP_SIZE; y++) {
+        for (int x = 0; x < MAP_SIZE; x++) {
+            incremental_values[y][x] = map_desirability_get(map_grid_offset(x, y));
+        }
+    }
+    map_desirability_clear();
+    map_desirability_update();
+    for (int y = 0; y < MAP_SIZE; y++) {
+        for (int x = 0; x < MAP_SIZE; x++) {
+            TEST_CHECK_EQUAL(map_desirability_get(map_grid_offset(x, y)), incremental_values[y][x]);
+        }
+    }
+}
+
+// With VERIFY_INCREMENTAL_UPDATES, every incremental update is also compared with a full rebuild
+// and logs an error on any difference, which fails the test
+int main(void)
+{
+    test_init_map(MAP_SIZE, MAP_SIZE);
+    for (int i = 0; i < NUM_MAPS; i++) {
+        map_terrain_clear();
+        building_clear_all();
+        map_desirability_clear();
+        for (int j = 0; j < INITIAL_BUILDINGS; j++) {
+            add_random_building();
+        }
+        map_desirability_update();
+        for (int j = 0; j < NUM_UPDATES; j++) {
+            for (int k = 0; k < CHANGES_PER_UPDATE; k++) {
+                make_random_change();
+            }
+            map_desirability_update();
+        }
+        check_against_full_rebuild();
+    }
+    return test_finish("desirability_incremental");
+}
@@ -0,0 +1,152 @@
+#include "test.h"
+
+#include "building/building.h"
+#include "building/storage.h"
+#include "city/data.h"
+#include "city/finance.h"
+#include "city/view.h"
+#include "figure/formation.h"
+#include "figure/name.h"
+#include "figure/route.h"
+#include "figure/visited_buildings.h"
+#include "game/file.h"
+#include "game/file_io.h"
+#include "game/journal.h"
+#include "game/state.h"
+#include "game/tick.h"
+#include "game/time.h"
+#include "graphics/window.h"
+#include "map/desirability.h"
+#include "map/grid.h"
+#include "map/property.h"
+#include "map/random.h"
+#include "map/terrain.h"
+#include "platform/file_manager.h"
+#include "scenario/data.h"
+#include "scenario/empire.h"
+#include "scenario/map.h"
+
+#define MAP_SIZE 40
+#define SAVE_FILE "journal_replay.sav"
+#define JOURNAL_FILE "journal_replay.txt"
+#define JOURNAL_SAVE_FILE JOURNAL_FILE ".svx"
+#define NUM_TICKS 2000
+#define ACTION_TICK 700
+
+// The parts of starting a new scenario and of the headless mode that do not need the game data files
+static int create_empty_city(void)
+{
+    test_init_renderer();
+    window_type window = { WINDOW_LOGO };
+    window_show(&window);
+
+    // The map is kept in the saved game, so it must be set up as a new scenario would
+    scenario.map.width = MAP_SIZE;
+    scenario.map.height = MAP_SIZE;
+    scenario.map.grid_start = (GRID_SIZE - MAP_SIZE) / 2 * GRID_SIZE + (GRID_SIZE - MAP_SIZE) / 2;
+    scenario.map.grid_border_size = GRID_SIZE - MAP_SIZE;
+    scenario_map_init();
+    // An empire of its own is kept in the saved game instead of being read from c32.emp
+    scenario.empire.id = SCENARIO_CUSTOM_EMPIRE;
+    city_data_init();
+    game_state_init();
+    building_clear_all();
+    building_storage_clear_all();
+    figure_init_scenario();
+    figure_name_init();
+    formations_clear();
+    figure_route_clear_all();
+    figure_visited_buildings_init();
+    game_time_init(2098);
+    map_terrain_clear();
+    map_terrain_init_outside_map();
+    map_property_clear();
+    map_random_clear();
+    map_random_init();
+    map_desirability_clear();
+
+    // Loading a game recalculates what the save does not keep, so only loaded states can be compared
+    return game_file_write_saved_game(SAVE_FILE) && game_file_load_saved_game(SAVE_FILE) == FILE_LOAD_SUCCESS;
+}
+
+static void check_hash_of_saved_state(void)
+{
+    uint32_t hash = game_file_io_hash_game_state();
+    TEST_CHECK_EQUAL(hash, game_file_io_hash_game_state());
+
+    TEST_CHECK(game_file_write_saved_game(SAVE_FILE));
+    city_view_set_camera(MAP_SIZE / 2, MAP_SIZE / 2);
+    TEST_CHECK_EQUAL(hash, game_file_io_hash_game_state());
+    city_finance_change_tax_percentage(1);
+    TEST_CHECK(hash != game_file_io_hash_game_state());
+
+    TEST_CHECK_EQUAL(FILE_LOAD_SUCCESS, game_file_load_saved_game(SAVE_FILE));
+    TEST_CHECK_EQUAL(hash, game_file_io_hash_game_state());
+}
+
+// Plays the game as the city window would, applying the action and recording it,
+// unless the action is left out of the journal on purpose
+static uint32_t record_session(int record_action)
+{
+    TEST_CHECK_EQUAL(FILE_LOAD_SUCCESS, game_file_load_saved_game(SAVE_FILE));
+    game_journal_start_recording(JOURNAL_FILE);
+    game_journal_game_loaded();
+    for (int tick = 0; tick < NUM_TICKS; tick++) {
+        if (tick == ACTION_TICK) {
+            city_finance_change_tax_percentage(2);
+            if (record_action) {
+                game_journal_record(JOURNAL_TAX, 2);
+            }
+        }
+        game_tick_run();
+    }
+    uint32_t hash = game_file_io_hash_game_state();
+    game_journal_game_unloading();
+    return hash;
+}
+
+static void replay_session(journal_replay_result *result)
+{
+    TEST_CHECK(game_journal_load_replay(JOURNAL_FILE));
+    TEST_CHECK(game_journal_run_replay(result));
+    TEST_CHECK_EQUAL(NUM_TICKS, result->ticks);
+    TEST_CHECK(result->checkpoints > 1);
+}
+
+static void check_round_trip(void)
+{
+    uint32_t hash = record_session(1);
+    journal_replay_result result;
+    replay_session(&result);
+    TEST_CHECK_EQUAL(1, result.commands);
+    TEST_CHECK_EQUAL(0, result.mismatches);
+    TEST_CHECK_EQUAL(0, result.unsupported);
+    TEST_CHECK_EQUAL(hash, game_file_io_hash_game_state());
+}
+
+static void check_unrecorded_action_diverges(void)
+{
+    record_session(0);
+    journal_replay_result result;
+    replay_session(&result);
+    TEST_CHECK_EQUAL(0, result.commands);
+    TEST_CHECK(result.mismatches > 0);
+    TEST_CHECK(result.first_mismatch_tick > ACTION_TICK);
+    // Each diverged checkpoint logs an error
+    test_expect_logged_errors(result.mismatches);
+}
+
+int main(void)
+{
+    if (create_empty_city()) {
+        check_hash_of_saved_state();
+        check_round_trip();
+        check_unrecorded_action_diverges();
+    } else {
+        TEST_CHECK(!"unable to create an empty city");
+    }
+    platform_file_manager_remove_file(SAVE_FILE);
+    platform_file_manager_remove_file(JOURNAL_FILE);
+    platform_file_manager_remove_file(JOURNAL_SAVE_FILE);
+    return test_finish("journal_replay");
+}
@@ -0,0 +1,352 @@
+#include "test.h"
+
+#include "core/log.h"
+#include "core/thread.h"
+#include "game/system.h"
+#include "graphics/renderer.h"
+#include "platform/file_manager.h"
+#include "platform/prefs.h"
+#include "platform/user_path.h"
+#include "sound/device.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// The platform layer for the unit tests: files go through stdio, the rest does nothing
+
+static int logged_errors;
+
+int test_logged_errors(void)
+{
+    return logged_errors;
+}
+
+void log_error(const char *msg, const char *param_str, int param_int)
+{
+    fprintf(stderr, "ERROR: %s %s %d\n", msg, param_str ? param_str : "", param_int);
+    logged_errors++;
+}
+
+void log_info(const char *msg, const char *param_str, int param_int)
+{}
+
+static int has_image_atlas(atlas_type type)
+{
+    return 0;
+}
+
+static void get_max_image_size(int *width, int *height)
+{
+    *width = 4096;
+    *height = 4096;
+}
+
+static void update_scale(int city_scale)
+{}
+
+// Loading a game sets up the city view, which asks the renderer about its images and scale
+void test_init_renderer(void)
+{
+    static graphics_renderer_interface renderer_interface;
+    renderer_interface.has_image_atlas = has_image_atlas;
+    renderer_interface.get_max_image_size = get_max_image_size;
+    renderer_interface.update_scale = update_scale;
+    graphics_renderer_set_interface(&renderer_interface);
+}
+
+thread_handle *thread_create(const char *name, int (*function)(void *data), void *data)
+{
+    // Callers fall back to doing the work on the calling thread
+    return 0;
+}
+
+int thread_get_cpu_count(void)
+{
+    return 1;
+}
+
+int thread_is_finished(thread_handle *thread)
+{
+    return 1;
+}
+
+int thread_wait(thread_handle *thread)
+{
+    return 0;
+}
+
+FILE *platform_file_manager_open_file(const char *filename, const char *mode)
+{
+    return fopen(filename, mode);
+}
+
+FILE *platform_file_manager_open_asset(const char *asset, const char *mode)
+{
+    return 0;
+}
+
+int platform_file_manager_close_file(FILE *stream)
+{
+    return fclose(stream);
+}
+
+int platform_file_manager_remove_file(const char *filename)
+{
+    return remove(filename) == 0;
+}
+
+int platform_file_manager_rename_file(const char *src, const char *dst)
+{
+    return rename(src, dst) == 0;
+}
+
+int platform_file_manager_compare_filename(const char *a, const char *b)
+{
+    return strcmp(a, b);
+}
+
+int platform_file_manager_compare_filename_prefix(const char *filename, const char *prefix, int prefix_len)
+{
+    return strncmp(filename, prefix, prefix_len);
+}
+
+int platform_file_manager_filename_contains(const char *filename, const char *expression)
+{
+    return strstr(filename, expression) != 0;
+}
+
+const char *platform_file_manager_get_directory_for_location(int location, const char *user_directory)
+{
+    return "";
+}
+
+int platform_file_manager_is_directory_writeable(const char *directory)
+{
+    return 1;
+}
+
+int platform_file_manager_list_directory_contents(
+    const char *dir, int type, const char *extension, int (*callback)(const char *, long))
+{
+    return 0;
+}
+
+int platform_file_manager_should_case_correct_file(void)
+{
+    return 0;
+}
+
+void platform_user_path_copy_campaigns_and_custom_empires(void)
+{}
+
+void platform_user_path_copy_files(const char *original_user_path, int overwrite)
+{}
+
+void platform_user_path_create_subdirectories(void)
+{}
+
+const char *platform_user_path_recommend(void)
+{
+    return "";
+}
+
+const char *pref_data_dir(void)
+{
+    return "";
+}
+
+const char *pref_user_dir(void)
+{
+    return "";
+}
+
+void pref_save_user_dir(const char *user_dir)
+{}
+
+void sound_device_open(void)
+{}
+
+void sound_device_close(void)
+{}
+
+void sound_device_init_channels(void)
+{}
+
+void sound_device_on_audio_finished(void (*callback)(sound_type))
+{}
+
+int sound_device_is_file_playing_on_channel(const char *filename, sound_type type)
+{
+    return 0;
+}
+
+int sound_device_play_file_on_channel(const char *filename, sound_type type, int volume_pct)
+{
+    return 0;
+}
+
+int sound_device_play_file_on_channel_panned(const char *filename, sound_type type,
+    int volume_pct, int left_pct, int right_pct)
+{
+    return 0;
+}
+
+void sound_device_preload_file(const char *filename)
+{}
+
+void sound_device_set_volume_for_type(sound_type type, int volume_pct)
+{}
+
+void sound_device_stop_type(sound_type type)
+{}
+
+int sound_device_play_music(const char *filename, int volume_pct, int loop)
+{
+    return 0;
+}
+
+int sound_device_play_track(const char *filename, int volume_pct, void (*on_finish)(void))
+{
+    return 0;
+}
+
+void sound_device_set_music_volume(int volume_pct)
+{}
+
+int sound_device_pause_music(void)
+{
+    return 0;
+}
+
+int sound_device_resume_music(void)
+{
+    return 0;
+}
+
+void sound_device_fadeout_music(int milisseconds)
+{}
+
+void sound_device_stop_music(void)
+{}
+
+void sound_device_use_custom_music_player(int bitdepth, int num_channels, int rate, const void *audio_data, int len)
+{}
+
+void sound_device_use_default_music_player(void)
+{}
+
+void sound_device_write_custom_music_data(const void *audio_data, int len)
+{}
+
+int system_can_scale_display(int *min_scale, int *max_scale)
+{
+    return 0;
+}
+
+int system_scale_display(int scale_percentage)
+{
+    return 100;
+}
+
+void system_get_max_resolution(int *width, int *height)
+{
+    *width = 1024;
+    *height = 768;
+}
+
+void system_resize(int width, int height)
+{}
+
+void system_center(void)
+{}
+
+int system_is_fullscreen_only(void)
+{
+    return 0;
+}
+
+void system_set_fullscreen(int fullscreen)
+{}
+
+void system_change_window_title(const char *title)
+{}
+
+void system_init_cursors(int scale_percentage)
+{}
+
+void system_set_cursor(int cursor_id)
+{}
+
+void system_show_cursor(void)
+{}
+
+void system_hide_cursor(void)
+{}
+
+void system_set_mouse_position(int *x, int *y)
+{}
+
+void system_move_mouse_cursor(int delta_x, int delta_y)
+{}
+
+void system_mouse_get_relative_state(int *x, int *y)
+{
+    *x = 0;
+    *y = 0;
+}
+
+void system_mouse_set_relative_mode(int enabled)
+{}
+
+void system_keyboard_show(void)
+{}
+
+void system_keyboard_hide(void)
+{}
+
+void system_keyboard_set_input_rect(int x, int y, int width, int height)
+{}
+
+void system_start_text_input(void)
+{}
+
+void system_stop_text_input(void)
+{}
+
+key_type system_keyboard_key_for_symbol(const char *name)
+{
+    return KEY_TYPE_NONE;
+}
+
+const char *system_keyboard_key_name(key_type key)
+{
+    return "";
+}
+
+const char *system_keyboard_key_modifier_name(key_modifier_type modifier)
+{
+    return "";
+}
+
+int system_supports_select_folder_dialog(void)
+{
+    return 0;
+}
+
+const char *system_show_select_folder_dialog(const char *title, const char *default_path)
+{
+    return 0;
+}
+
+uint64_t system_get_ticks(void)
+{
+    return 0;
+}
+
+const char *system_version(void)
+{
+    return "test";
+}
+
+void system_exit(void)
+{}
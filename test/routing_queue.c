@@ -0,0 +1,101 @@
+#include "test.h"
+
+#include "map/grid.h"
+#include "map/routing.h"
+#include "map/routing_data.h"
+
+#include <string.h>
+
+#define MAP_SIZE 60
+#define NUM_MAPS 20
+#define ROUTES_PER_MAP 50
+#define BLOCKED_PERCENTAGE 35
+
+static const int OFFSETS_X[] = { 0, 1, 0, -1, 1, 1, -1, -1 };
+static const int OFFSETS_Y[] = { -1, 0, 1, 0, -1, 1, 1, -1 };
+
+static int steps[MAP_SIZE][MAP_SIZE];
+static int queue[MAP_SIZE * MAP_SIZE];
+
+static int is_open(int x, int y)
+{
+    return x >= 0 && y >= 0 && x < MAP_SIZE && y < MAP_SIZE &&
+        terrain_land_citizen.items[map_grid_offset(x, y)] >= 0;
+}
+
+// Every step over land costs the same, so a breadth-first search gives the shortest number of steps
+static int shortest_steps(int src_x, int src_y, int dst_x, int dst_y, int num_directions)
+{
+    memset(steps, -1, sizeof(steps));
+    int head = 0;
+    int tail = 0;
+    steps[src_y][src_x] = 0;
+    queue[tail++] = src_y * MAP_SIZE + src_x;
+    while (head < tail) {
+        int x = queue[head] % MAP_SIZE;
+        int y = queue[head] / MAP_SIZE;
+        head++;
+        if (x == dst_x && y == dst_y) {
+            return steps[y][x];
+        }
+        for (int i = 0; i < num_directions; i++) {
+            int next_x = x + OFFSETS_X[i];
+            int next_y = y + OFFSETS_Y[i];
+            if (is_open(next_x, next_y) && steps[next_y][next_x] < 0) {
+                steps[next_y][next_x] = steps[y][x] + 1;
+                queue[tail++] = next_y * MAP_SIZE + next_x;
+            }
+        }
+    }
+    return -1;
+}
+
+static void create_random_map(void)
+{
+    map_grid_init_i8(terrain_land_citizen.items, CITIZEN_N1_BLOCKED);
+    for (int y = 0; y < MAP_SIZE; y++) {
+        for (int x = 0; x < MAP_SIZE; x++) {
+            if (test_random(100) >= BLOCKED_PERCENTAGE) {
+                terrain_land_citizen.items[map_grid_offset(x, y)] = CITIZEN_4_CLEAR_TERRAIN;
+            }
+        }
+    }
+}
+
+static void random_open_tile(int *x, int *y)
+{
+    do {
+        *x = test_random(MAP_SIZE);
+        *y = test_random(MAP_SIZE);
+    } while (!is_open(*x, *y));
+}
+
+// The route search pops tiles from the ordered queue by their distance plus the remaining distance.
+// With a consistent estimate, as here, the destination must be reached over a shortest path,
+// which only holds if reducing the distance of an already queued tile keeps the queue ordered.
+static void check_route(int num_directions)
+{
+    int src_x, src_y, dst_x, dst_y;
+    random_open_tile(&src_x, &src_y);
+    random_open_tile(&dst_x, &dst_y);
+    int expected = shortest_steps(src_x, src_y, dst_x, dst_y, num_directions);
+    int found = map_routing_citizen_can_travel_over_land(src_x, src_y, dst_x, dst_y, num_directions);
+    TEST_CHECK_EQUAL(expected >= 0, found);
+    if (expected >= 0 && found) {
+        int distance = map_routing_get_distance_grid()->determined.items[map_grid_offset(dst_x, dst_y)];
+        TEST_CHECK_EQUAL(1 + 2 * expected, distance);
+    }
+}
+
+int main(void)
+{
+    test_init_map(MAP_SIZE, MAP_SIZE);
+    for (int i = 0; i < NUM_MAPS; i++) {
+        create_random_map();
+        for (int j = 0; j < ROUTES_PER_MAP; j++) {
+            check_route(4);
+            check_route(8);
+        }
+    }
+    return test_finish("routing_queue");
+}
@@ -0,0 +1,57 @@
+#include "test.h"
+
+#include "map/grid.h"
+
+#include <stdio.h>
+
+static struct {
+    int failures;
+    int expected_errors;
+    unsigned int random_state;
+} data = { 0, 0, 12345 };
+
+void test_check(int passed, const char *condition, const char *file, int line)
+{
+    if (!passed) {
+        fprintf(stderr, "%s:%d: check failed: %s\n", file, line, condition);
+        data.failures++;
+    }
+}
+
+void test_check_equal(int expected, int actual, const char *value, const char *file, int line)
+{
+    if (expected != actual) {
+        fprintf(stderr, "%s:%d: %s is %d, expected %d\n", file, line, value, actual, expected);
+        data.failures++;
+    }
+}
+
+void test_init_map(int width, int height)
+{
+    map_grid_init(width, height, (GRID_SIZE - height) / 2 * GRID_SIZE + (GRID_SIZE - width) / 2, GRID_SIZE - width);
+}
+
+int test_random(int max)
+{
+    data.random_state = data.random_state * 1103515245u + 12345u;
+    return (int) ((data.random_state >> 16) % (unsigned int) max);
+}
+
+void test_expect_logged_errors(int count)
+{
+    data.expected_errors += count;
+}
+
+int test_finish(const char *name)
+{
+    int errors = test_logged_errors() - data.expected_errors;
+    if (errors) {
+        fprintf(stderr, "%s: the game logged %d errors\n", name, errors);
+    }
+    if (data.failures || errors) {
+        fprintf(stderr, "%s: FAILED\n", name);
+        return 1;
+    }
+    printf("%s: passed\n", name);
+    return 0;
+}
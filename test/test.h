@@ -0,0 +1,66 @@
+#ifndef TEST_TEST_H
+#define TEST_TEST_H
+
+/**
+ * @file
+ * Checks shared by the unit tests. The tests link the game code against the platform layer
+ * of platform_stubs.c, which neither opens a window nor plays sounds, and counts every logged error.
+ */
+
+/**
+ * Checks a condition, reporting the failure and continuing the test if it does not hold
+ * @param condition The condition to check
+ */
+#define TEST_CHECK(condition) \
+    test_check((condition) != 0, #condition, __FILE__, __LINE__)
+
+/**
+ * Checks that two integer values are equal, reporting both if they are not
+ * @param expected The expected value
+ * @param actual The actual value
+ */
+#define TEST_CHECK_EQUAL(expected, actual) \
+    test_check_equal((expected), (actual), #actual, __FILE__, __LINE__)
+
+void test_check(int passed, const char *condition, const char *file, int line);
+
+void test_check_equal(int expected, int actual, const char *value, const char *file, int line);
+
+/**
+ * Sets the playable map size the same way a new scenario does, centering the map on the grid
+ * @param width The map width
+ * @param height The map height
+ */
+void test_init_map(int width, int height);
+
+/**
+ * Installs a renderer that draws nothing, as needed to load a saved game
+ */
+void test_init_renderer(void);
+
+/**
+ * Returns a pseudo-random number that only depends on the previous calls, so runs are repeatable
+ * @param max The upper bound, exclusive
+ * @return A number from 0 to max - 1
+ */
+int test_random(int max);
+
+/**
+ * @return The number of errors the game code logged since the test started
+ */
+int test_logged_errors(void);
+
+/**
+ * Marks errors that the test provoked on purpose, so they do not fail the test
+ * @param count The number of expected errors
+ */
+void test_expect_logged_errors(int count);
+
+/**
+ * Reports the test result
+ * @param name The test name
+ * @return The process exit status: 0 if every check passed and no errors were logged, 1 otherwise
+ */
+int test_finish(const char *name);
+
+#endif // TEST_TEST_H